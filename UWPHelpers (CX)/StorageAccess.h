@@ -7,10 +7,29 @@
 #pragma once
 
 #include <string>
+#include <ppltasks.h>
 
 // Local settings
 std::string GetDataFromLocalSettings(std::string key);
 bool AddDataToLocalSettings(std::string key, std::string data, bool replace);
 
 // Lookup list
+// app folders are added right away (once), picked items are restored in background
 void FillLookupList();
+bool IsLookupListReady(); // True once picked items restored
+// Wait until picked items restored
+// on UI thread the window events keep running while waiting (same as any broker wait),
+// so UI callbacks can run inside this call and inside the storage call that started it,
+// they must not rely on storage state that the interrupted call is changing
+void WaitLookupListReady();
+concurrency::task<void> GetLookupListReadyTask(); // Async version of 'WaitLookupListReady'
+
+// Picked items restore stats (last 'FillLookupList' background phase)
+struct FutureAccessStatsUWP {
+	size_t resolved = 0; // Tokens resolved to valid items
+	size_t pruned = 0; // Dead tokens removed from FutureAccessList
+	double totalMs = 0; // Sum of per-token latency
+	double maxMs = 0; // Slowest token
+	double wallMs = 0; // Whole restore time
+};
+FutureAccessStatsUWP GetFutureAccessStats();
@@ -9,12 +9,19 @@
 
 #include "StorageAsync.h"
 
+LatencyHistogramUWP BrokerLatency;
+
+LatencyHistogramUWP& GetBrokerLatency()
+{
+	return BrokerLatency;
+}
+
 bool ActionPass(Windows::Foundation::IAsyncAction^ action)
 {
-	return TaskHandler<bool>([&]() {
-		return concurrency::create_task(action).then([]() {
+	return TaskHandler<bool>([&](concurrency::cancellation_token token) {
+		return concurrency::create_task(action, token).then([]() {
 			return true;
-		});
+		}, concurrency::task_continuation_context::use_arbitrary());
 	}, false);
 }
 
@@ -25,3 +32,45 @@ bool ExecuteTask(Windows::Foundation::IAsyncAction^ action)
 {
 	return ActionPass(action);
 };
+
+std::vector<BatchItemUWP<bool>> ExecuteActionBatch(size_t count, std::function<Windows::Foundation::IAsyncAction^(size_t)> launch, size_t maxConcurrent)
+{
+	auto runner = std::make_shared<BatchRunnerUWP<bool>>(count, false);
+	runner->Start([launch](size_t index, std::shared_ptr<BatchRunnerUWP<bool>> runner) {
+		Windows::Foundation::IAsyncAction^ action = nullptr;
+		try
+		{
+			action = launch(index);
+		}
+		catch (Platform::Exception^ exception_)
+		{
+			runner->Complete(index, false, false, exception_->HResult);
+			return;
+		}
+		if (action == nullptr) {
+			runner->Complete(index, false, false, 0);
+			return;
+		}
+		runner->Track(index, [action]() {
+			action->Cancel();
+		});
+		concurrency::create_task(action).then([index, runner](concurrency::task<void> t) {
+			int32_t error = 0;
+			try
+			{
+				t.get();
+			}
+			catch (Platform::Exception^ exception_)
+			{
+				error = exception_->HResult;
+			}
+			catch (...)
+			{
+				error = E_ABORT;
+			}
+			runner->Complete(index, error == 0, error == 0, error);
+		}, concurrency::task_continuation_context::use_arbitrary());
+	}, maxConcurrent);
+	WaitBatch(runner);
+	return runner->Results();
+}
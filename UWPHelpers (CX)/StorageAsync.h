@@ -14,9 +14,15 @@
 #include <ppltasks.h>
 #include <wrl.h>
 #include <wrl/implements.h>
+#include <objbase.h>
 
+#include "StorageConfig.h"
 #include "StorageLog.h"
 #include "StorageExtensions.h"
+#include "StorageWait.h"
+#include "StorageBatch.h"
+#include "StorageLimits.h"
+#include "StorageLatency.h"
 
 using namespace Windows::UI::Core;
 
@@ -25,52 +31,232 @@ using namespace Windows::UI::Core;
 
 #pragma region Async Handlers
 
-template<typename T>
-T TaskHandler(std::function<concurrency::task<T>()> wtask, T def)
+// STA threads must not block on 'task.get()'
+inline bool IsSTAThread()
 {
-	T result = def;
-	bool done = false;
-	wtask().then([&](concurrency::task<T> t) {
-		try
+	APTTYPE type;
+	APTTYPEQUALIFIER qualifier;
+	if (CoGetApartmentType(&type, &qualifier) != S_OK) {
+		return false;
+	}
+	return type == APTTYPE_STA || type == APTTYPE_MAINSTA;
+}
+
+// UI thread dispatcher, pumped only while waiting on the thread that owns a CoreWindow
+class CoreWaitDispatcherUWP : public WaitDispatcherUWP
+{
+public:
+	CoreWaitDispatcherUWP()
 	{
-		result = t.get();
+		CoreWindow^ corewindow = CoreWindow::GetForCurrentThread();
+		if (corewindow) {
+			dispatcher = corewindow->Dispatcher;
+		}
 	}
-	catch (Platform::Exception^ exception_)
+
+	bool NeedsPumping() override
 	{
-		UWP_ERROR_LOG(UWPSMT, convertToChar(exception_->Message));
+		return dispatcher != nullptr;
 	}
-		done = true;
-	});
 
-	CoreWindow^ corewindow = CoreWindow::GetForCurrentThread();
-	while (!done)
+	bool ProcessEvents() override
 	{
 		try {
-			if (corewindow) {
-				corewindow->Dispatcher->ProcessEvents(CoreProcessEventsOption::ProcessAllIfPresent);
-			}
-			else {
-				corewindow = CoreWindow::GetForCurrentThread();
-			}
+			// Sleeps until there is an event ('Wake' posts one)
+			dispatcher->ProcessEvents(CoreProcessEventsOption::ProcessOneAndAllPending);
+			return true;
+		}
+		catch (...) {
+			return false;
+		}
+	}
+
+	void Wake() override
+	{
+		try {
+			dispatcher->RunAsync(CoreDispatcherPriority::Normal, ref new DispatchedHandler([]() {}));
 		}
 		catch (...) {
+		}
+	}
+
+	void WakeAt(std::chrono::steady_clock::time_point time) override
+	{
+		auto delay = std::chrono::duration_cast<std::chrono::microseconds>(time - std::chrono::steady_clock::now());
+		Windows::Foundation::TimeSpan span;
+		span.Duration = delay.count() > 0 ? delay.count() * 10 : 0; // 100ns units
+		CoreDispatcher^ target = dispatcher;
+		try {
+			Windows::System::Threading::ThreadPoolTimer::CreateTimer(ref new Windows::System::Threading::TimerElapsedHandler([target](Windows::System::Threading::ThreadPoolTimer^) {
+				target->RunAsync(CoreDispatcherPriority::Normal, ref new DispatchedHandler([]() {}));
+			}), span);
+		}
+		catch (...) {
+		}
+	}
+
+private:
+	CoreDispatcher^ dispatcher;
+};
+
+// Broker waits of all threads
+LatencyHistogramUWP& GetBrokerLatency();
+
+// 'ERROR_TIMEOUT' or 'ERROR_CANCELLED', also set as last error
+inline DWORD SetStoppedError(StorageCallResultUWP state)
+{
+	DWORD error = (state == STORAGE_CALL_CANCELED) ? ERROR_CANCELLED : ERROR_TIMEOUT;
+	SetLastError(error);
+	return error;
+}
+
+// 'wtask' must pass the token to its tasks, it's canceled once the limits of the thread stop the wait
+template<typename T>
+T TaskHandler(std::function<concurrency::task<T>(concurrency::cancellation_token)> wtask, T def)
+{
+	LatencyScopeUWP latency(GetBrokerLatency());
+	StorageLimitsUWP* limits = CurrentStorageLimitsUWP();
+	bool sta = IsSTAThread();
+	if (!sta && limits == nullptr) {
+		// Blocking wait is allowed
+		T result = def;
+		try
+		{
+			result = wtask(concurrency::cancellation_token::none()).get();
+		}
+		catch (Platform::Exception^ exception_)
+		{
+			UWP_ERROR_LOG(UWPSMT, convertToChar(exception_->Message));
+		}
+		catch (...)
+		{
+		}
+		return result;
+	}
 
+	auto state = (limits != nullptr) ? limits->Check() : STORAGE_CALL_COMPLETED;
+	if (state == STORAGE_CALL_COMPLETED) {
+		// Continuation must not need this thread, it's waiting
+		// it may also run after a stopped wait returned, so it owns the result
+		concurrency::cancellation_token_source cancelSource;
+		auto signal = std::make_shared<WaitSignalUWP>();
+		auto result = std::make_shared<T>(def);
+		wtask(cancelSource.get_token()).then([result, signal](concurrency::task<T> t) {
+			try
+			{
+				*result = t.get();
+			}
+			catch (Platform::Exception^ exception_)
+			{
+				UWP_ERROR_LOG(UWPSMT, convertToChar(exception_->Message));
+			}
+			catch (...)
+			{
+			}
+			signal->Set();
+		}, concurrency::task_continuation_context::use_arbitrary());
+
+		if (sta) {
+			CoreWaitDispatcherUWP dispatcher;
+			state = signal->Wait(&dispatcher, limits);
+		}
+		else {
+			state = signal->Wait(nullptr, limits);
 		}
+		if (state == STORAGE_CALL_COMPLETED) {
+			return *result;
+		}
+		cancelSource.cancel();
 	}
 
-	return result;
+	limits->Stop(state);
+	latency.SetResult(state);
+	SetStoppedError(state);
+	return def;
 };
 
 template<typename T>
 T TaskPass(Windows::Foundation::IAsyncOperation<T>^ task, T def)
 {
-	return TaskHandler<T>([&]() {
-		return concurrency::create_task(task).then([](T res) {
+	return TaskHandler<T>([&](concurrency::cancellation_token token) {
+		return concurrency::create_task(task, token).then([](T res) {
 			return res;
-		});
+		}, concurrency::task_continuation_context::use_arbitrary());
 	}, def);
 }
 
+// Wait for batch within the limits of the calling thread, UI thread keeps processing its events
+template<typename T>
+void WaitBatch(std::shared_ptr<BatchRunnerUWP<T>> runner)
+{
+	auto limits = CurrentStorageLimitsUWP();
+	StorageCallResultUWP state;
+	if (IsSTAThread()) {
+		CoreWaitDispatcherUWP dispatcher;
+		state = runner->Wait(&dispatcher, limits);
+	}
+	else {
+		state = runner->Wait(nullptr, limits);
+	}
+	if (state != STORAGE_CALL_COMPLETED) {
+		if (limits != nullptr) {
+			limits->Stop(state);
+		}
+		SetStoppedError(state);
+	}
+}
+
+// Run 'count' async operations and wait once for all of them
+// @launch: starts the operation of index (nullptr to skip it)
+// @def: value of failed or skipped items
+// results keep the index order with their errors
+template<typename T>
+std::vector<BatchItemUWP<T>> ExecuteBatch(size_t count, std::function<Windows::Foundation::IAsyncOperation<T>^(size_t)> launch, T def, size_t maxConcurrent = BATCH_MAX_CONCURRENT)
+{
+	auto runner = std::make_shared<BatchRunnerUWP<T>>(count, def);
+	runner->Start([launch, def](size_t index, std::shared_ptr<BatchRunnerUWP<T>> runner) {
+		Windows::Foundation::IAsyncOperation<T>^ operation = nullptr;
+		try
+		{
+			operation = launch(index);
+		}
+		catch (Platform::Exception^ exception_)
+		{
+			runner->Complete(index, def, false, exception_->HResult);
+			return;
+		}
+		if (operation == nullptr) {
+			runner->Complete(index, def, false, 0);
+			return;
+		}
+		runner->Track(index, [operation]() {
+			operation->Cancel();
+		});
+		concurrency::create_task(operation).then([index, runner, def](concurrency::task<T> t) {
+			T value = def;
+			int32_t error = 0;
+			try
+			{
+				value = t.get();
+			}
+			catch (Platform::Exception^ exception_)
+			{
+				error = exception_->HResult;
+			}
+			catch (...)
+			{
+				error = E_ABORT;
+			}
+			runner->Complete(index, value, error == 0, error);
+		}, concurrency::task_continuation_context::use_arbitrary());
+	}, maxConcurrent);
+	WaitBatch(runner);
+	return runner->Results();
+}
+
+// Same for actions ('Delete', 'Move'..etc), value is true for completed actions
+std::vector<BatchItemUWP<bool>> ExecuteActionBatch(size_t count, std::function<Windows::Foundation::IAsyncAction^(size_t)> launch, size_t maxConcurrent = BATCH_MAX_CONCURRENT);
+
 bool ActionPass(Windows::Foundation::IAsyncAction^ action);
 
 #pragma endregion
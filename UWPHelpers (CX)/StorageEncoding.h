@@ -0,0 +1,139 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// UTF-8 <-> UTF-16 transcoding without hidden allocations
+// invalid input is replaced by U+FFFD (maximal subpart, as MultiByteToWideChar without MB_ERR_INVALID_CHARS)
+// ASCII runs are converted 16 units at a time (SSE2/NEON when available)
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstring>
+#include <cstddef>
+
+// Worst case output size, output buffers must be at least this big
+inline size_t GetUTF16CapacityUWP(size_t utf8Size) {
+	return utf8Size; // Each byte is one unit at most
+}
+
+inline size_t GetUTF8CapacityUWP(size_t utf16Size) {
+	return utf16Size * 3; // Each unit is 3 bytes at most (pairs are 4 bytes for 2 units)
+}
+
+// Return written units/bytes (no null terminator is written)
+size_t UTF8ToUTF16UWP(std::string_view input, wchar_t* output);
+size_t UTF8ToUTF16UWP(std::string_view input, char16_t* output);
+size_t UTF16ToUTF8UWP(std::wstring_view input, char* output);
+size_t UTF16ToUTF8UWP(std::u16string_view input, char* output);
+
+// Strict validation (no overlongs, no surrogates in UTF-8, no unpaired surrogates in UTF-16)
+bool IsValidUTF8UWP(std::string_view input);
+bool IsValidUTF16UWP(std::wstring_view input);
+
+// Owned wide string, typical paths (up to MAX_PATH) are kept inline without heap allocation
+class WideStringUWP {
+public:
+	static const size_t InlineSize = 260;
+
+	WideStringUWP() {
+		inline_[0] = 0;
+	}
+
+	WideStringUWP(const wchar_t* data, size_t size) : WideStringUWP() {
+		memcpy(Reserve(size), data, size * sizeof(wchar_t));
+		SetSize(size);
+	}
+
+	WideStringUWP(const WideStringUWP& other) : WideStringUWP(other.data_, other.size_) {
+	}
+
+	WideStringUWP(WideStringUWP&& other) noexcept : WideStringUWP() {
+		Take(other);
+	}
+
+	WideStringUWP& operator=(const WideStringUWP& other) {
+		if (this != &other) {
+			memcpy(Reserve(other.size_), other.data_, other.size_ * sizeof(wchar_t));
+			SetSize(other.size_);
+		}
+		return *this;
+	}
+
+	WideStringUWP& operator=(WideStringUWP&& other) noexcept {
+		if (this != &other) {
+			Take(other);
+		}
+		return *this;
+	}
+
+	~WideStringUWP() {
+		delete[] heap_;
+	}
+
+	const wchar_t* c_str() const {
+		return data_;
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+	bool empty() const {
+		return size_ == 0;
+	}
+
+	// Can be passed directly to Win32 APIs
+	operator const wchar_t*() const {
+		return data_;
+	}
+
+	// Writable buffer for 'capacity' units (+ null), old content is not kept
+	wchar_t* Reserve(size_t capacity) {
+		if (capacity > capacity_) {
+			delete[] heap_;
+			heap_ = new wchar_t[capacity + 1];
+			capacity_ = capacity;
+			data_ = heap_;
+		}
+		return data_;
+	}
+
+	void SetSize(size_t size) {
+		size_ = size;
+		data_[size] = 0;
+	}
+
+private:
+	void Take(WideStringUWP& other) {
+		if (other.heap_ != nullptr) {
+			delete[] heap_;
+			heap_ = other.heap_;
+			data_ = heap_;
+			capacity_ = other.capacity_;
+			size_ = other.size_;
+			other.heap_ = nullptr;
+			other.data_ = other.inline_;
+			other.capacity_ = InlineSize;
+			other.SetSize(0);
+		}
+		else {
+			memcpy(Reserve(other.size_), other.data_, other.size_ * sizeof(wchar_t));
+			SetSize(other.size_);
+		}
+	}
+
+	wchar_t inline_[InlineSize + 1];
+	wchar_t* heap_ = nullptr;
+	wchar_t* data_ = inline_;
+	size_t capacity_ = InlineSize;
+	size_t size_ = 0;
+};
+
+// Owned results
+WideStringUWP UTF8ToWideStringUWP(std::string_view input);
+void UTF8ToWideUWP(std::string_view input, std::wstring& output);
+void WideToUTF8UWP(std::wstring_view input, std::string& output);
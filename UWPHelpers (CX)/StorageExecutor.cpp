@@ -0,0 +1,153 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+#include "StorageExecutor.h"
+
+#include <algorithm>
+
+// Lane of the job running on this thread ('Yield' needs it)
+static thread_local const StorageExecutorUWP* CurrentExecutor = nullptr;
+static thread_local StorageLaneUWP CurrentLane = STORAGE_LANES;
+
+static inline uint64_t ElapsedMicros(std::chrono::steady_clock::time_point since) {
+	auto elapsed = std::chrono::steady_clock::now() - since;
+	return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+StorageExecutorUWP::StorageExecutorUWP(size_t workers, size_t backgroundWorkers, uint32_t yieldMax) : workers(workers > 0 ? workers : 1), yieldMax(yieldMax) {
+	// Normal and background lanes share all workers but one, that one is kept for interactive requests
+	sharedLimit = this->workers > 1 ? this->workers - 1 : 1;
+	lanes[STORAGE_LANE_INTERACTIVE].limit = this->workers;
+	lanes[STORAGE_LANE_NORMAL].limit = sharedLimit;
+	lanes[STORAGE_LANE_BACKGROUND].limit = (std::max)((size_t)1, (std::min)(backgroundWorkers, sharedLimit));
+}
+
+StorageExecutorUWP::~StorageExecutorUWP() {
+	{
+		std::lock_guard<std::mutex> lock(executorLock);
+		stopping = true;
+	}
+	jobsCondition.notify_all();
+	interactiveCondition.notify_all();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
+
+void StorageExecutorUWP::Post(StorageLaneUWP lane, std::function<void()> job) {
+	{
+		std::lock_guard<std::mutex> lock(executorLock);
+		if (stopping) {
+			return;
+		}
+		if (threads.empty()) {
+			for (size_t i = 0; i < workers; i++) {
+				threads.emplace_back(&StorageExecutorUWP::Work, this);
+			}
+		}
+		lanes[lane].queue.push_back(Job{ std::move(job), std::chrono::steady_clock::now() });
+	}
+	jobsCondition.notify_one();
+}
+
+void StorageExecutorUWP::Yield() {
+	if (CurrentExecutor != this || CurrentLane != STORAGE_LANE_BACKGROUND) {
+		return;
+	}
+	std::unique_lock<std::mutex> lock(executorLock);
+	auto& interactive = lanes[STORAGE_LANE_INTERACTIVE];
+	interactiveCondition.wait_for(lock, std::chrono::milliseconds(yieldMax), [this, &interactive]() {
+		return stopping || (interactive.queue.empty() && interactive.running == 0);
+	});
+}
+
+LaneStatsUWP StorageExecutorUWP::Stats(StorageLaneUWP lane) {
+	LaneStatsUWP stats;
+	{
+		std::lock_guard<std::mutex> lock(executorLock);
+		stats.queued = lanes[lane].queue.size();
+		stats.running = lanes[lane].running;
+		stats.completed = lanes[lane].completed;
+	}
+	stats.wait = lanes[lane].wait.Stats();
+	stats.total = lanes[lane].total.Stats();
+	return stats;
+}
+
+size_t StorageExecutorUWP::QueueDepth() {
+	std::lock_guard<std::mutex> lock(executorLock);
+	size_t depth = 0;
+	for (auto& lane : lanes) {
+		depth += lane.queue.size();
+	}
+	return depth;
+}
+
+bool StorageExecutorUWP::CanRun(size_t index) const {
+	const Lane& lane = lanes[index];
+	if (lane.queue.empty() || lane.running >= lane.limit) {
+		return false;
+	}
+	if (index == STORAGE_LANE_INTERACTIVE) {
+		return true;
+	}
+	// Yielding background jobs still hold their worker, they count here too
+	size_t sharedRunning = lanes[STORAGE_LANE_NORMAL].running + lanes[STORAGE_LANE_BACKGROUND].running;
+	return sharedRunning < sharedLimit;
+}
+
+bool StorageExecutorUWP::HasRunnable() const {
+	for (size_t index = 0; index < STORAGE_LANES; index++) {
+		if (CanRun(index)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void StorageExecutorUWP::Work() {
+	std::unique_lock<std::mutex> lock(executorLock);
+	while (true) {
+		jobsCondition.wait(lock, [this]() { return stopping || HasRunnable(); });
+		if (stopping) {
+			return;
+		}
+
+		// Lanes are in priority order
+		size_t index = 0;
+		while (!CanRun(index)) {
+			index++;
+		}
+		Lane& lane = lanes[index];
+		Job job = std::move(lane.queue.front());
+		lane.queue.pop_front();
+		lane.running++;
+		lock.unlock();
+
+		lane.wait.Record(ElapsedMicros(job.posted));
+		CurrentExecutor = this;
+		CurrentLane = (StorageLaneUWP)index;
+		try {
+			job.work();
+		}
+		catch (...) {
+		}
+		CurrentExecutor = nullptr;
+		CurrentLane = STORAGE_LANES;
+		lane.total.Record(ElapsedMicros(job.posted));
+
+		lock.lock();
+		lane.running--;
+		lane.completed++;
+		if (index == STORAGE_LANE_INTERACTIVE && lane.queue.empty() && lane.running == 0) {
+			interactiveCondition.notify_all();
+		}
+		if (index != STORAGE_LANE_INTERACTIVE && HasRunnable()) {
+			// Capped lanes have room again, any idle worker can take it
+			jobsCondition.notify_one();
+		}
+	}
+}
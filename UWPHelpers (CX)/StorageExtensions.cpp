@@ -6,80 +6,9 @@
 
 #include <fcntl.h>
 #include "StorageExtensions.h"
-
-#pragma region Inernal Helpers
-/* From RetroArch */
-char* utf16_to_utf8_string_alloc(const wchar_t* str)
-{
-	int len = 0;
-	char* buf = NULL;
-
-	if (!str || !*str)
-		return NULL;
-
-	{
-		UINT code_page = CP_UTF8;
-
-		/* fallback to ANSI codepage instead */
-		if (!(len = WideCharToMultiByte(code_page,
-			0, str, -1, NULL, 0, NULL, NULL)))
-		{
-			code_page = CP_ACP;
-			len = WideCharToMultiByte(code_page,
-				0, str, -1, NULL, 0, NULL, NULL);
-		}
-
-		if (!(buf = (char*)calloc(len, sizeof(char))))
-			return NULL;
-
-		if (WideCharToMultiByte(code_page,
-			0, str, -1, buf, len, NULL, NULL) < 0)
-		{
-			free(buf);
-			return NULL;
-		}
-	}
-
-	return buf;
-}
-wchar_t* utf8_to_utf16_string_alloc(const char* str)
-{
-	int len = 0;
-	wchar_t* buf = NULL;
-
-	if (!str || !*str)
-		return NULL;
-
-	if ((len = MultiByteToWideChar(CP_UTF8, 0, str, -1, NULL, 0)))
-	{
-		if (!(buf = (wchar_t*)calloc(len, sizeof(wchar_t))))
-			return NULL;
-
-		if ((MultiByteToWideChar(CP_UTF8, 0, str, -1, buf, len)) < 0)
-		{
-			free(buf);
-			return NULL;
-		}
-	}
-	else
-	{
-		/* Fallback to ANSI codepage instead */
-		if ((len = MultiByteToWideChar(CP_ACP, 0, str, -1, NULL, 0)))
-		{
-			if (!(buf = (wchar_t*)calloc(len, sizeof(wchar_t))))
-				return NULL;
-
-			if ((MultiByteToWideChar(CP_ACP, 0, str, -1, buf, len)) < 0)
-			{
-				free(buf);
-				return NULL;
-			}
-		}
-	}
-
-	return buf;
-}
-#pragma endregion
+#include "StoragePathCompare.h"
+#include "StorageTransform.h"
+#include "StorageEncoding.h"
 
 bool replace(std::string& str, const std::string& from, const std::string& to) {
 	size_t start_pos = str.find(from);
@@ -118,25 +47,20 @@ std::vector<std::string> split(const std::string s, char seperator)
 	return output;
 }
 
-bool isChild(std::string parent, std::string child) {
-	windowsPath(parent);
-	windowsPath(child);
-	tolower(parent);
-	tolower(child);
-
-	return child.find(parent) != std::string::npos;
+bool isChild(std::string_view parent, std::string_view child) {
+	return PathStartsWithUWP(child, parent);
 }
 
 // Parent full path, child full path, child name only
-bool isParent(std::string parent, std::string child, std::string childName) {
-	windowsPath(parent);
-	windowsPath(child);
-	tolower(parent);
-	tolower(child);
-	tolower(childName);
-
-	parent.append("\\" + childName);
-	return parent == child;
+bool isParent(std::string_view parent, std::string_view child, std::string_view childName) {
+	if (!PathIsDirectChildUWP(parent, child)) {
+		return false;
+	}
+	while (!child.empty() && (child.back() == '\\' || child.back() == '/')) {
+		child.remove_suffix(1);
+	}
+	size_t pos = child.find_last_of("\\/");
+	return PathEqualsUWP(child.substr(pos + 1), childName);
 }
 
 bool iequals(const std::string a, const std::string b)
@@ -162,38 +86,46 @@ bool starts_with(std::string str, std::string prefix)
 	return str.size() >= prefix.size() && 0 == str.compare(0, prefix.size(), prefix);
 }
 
-Platform::String^ convert(const std::string input)
+Platform::String^ convert(const std::string& input)
 {
-	auto wstr = utf8_to_utf16_string_alloc(input.c_str());
-	Platform::String^ output = ref new Platform::String((wstr == NULL ? L"" : wstr));
-	return output;
+	WideStringUWP wide = UTF8ToWideStringUWP(input);
+	return ref new Platform::String(wide.c_str(), (unsigned int)wide.size());
 }
 
-std::wstring convertToWString(const std::string input)
+std::wstring convertToWString(const std::string& input)
 {
-	auto wstr = utf8_to_utf16_string_alloc(input.c_str());
-	return std::wstring((wstr == NULL ? L"" : wstr));
+	std::wstring output;
+	UTF8ToWideUWP(input, output);
+	return output;
 }
 
 std::string convert(Platform::String^ input) {
-	auto utf8Str = utf16_to_utf8_string_alloc(input->Data()); // UTF8-encoded text
-	return std::string(utf8Str);
+	std::string output;
+	if (input != nullptr) {
+		WideToUTF8UWP(std::wstring_view(input->Data(), input->Length()), output);
+	}
+	return output;
 }
 
-std::string convert(std::wstring input) {
-	auto utf8Str = utf16_to_utf8_string_alloc(input.c_str()); // UTF8-encoded text
-	return std::string(utf8Str);
+std::string convert(const std::wstring& input) {
+	std::string output;
+	WideToUTF8UWP(input, output);
+	return output;
 }
 
+// Input is a wide string passed as 'char*'
 std::string convert(const char* input) {
-	auto utf8Str = utf16_to_utf8_string_alloc((const wchar_t*)input); // UTF8-encoded text
-	return std::string(utf8Str);
+	std::string output;
+	if (input != nullptr) {
+		const wchar_t* wide = (const wchar_t*)input;
+		WideToUTF8UWP(std::wstring_view(wide, wcslen(wide)), output);
+	}
+	return output;
 }
 
-LPCWSTR convertToLPCWSTR(std::string input) {
-	std::wstring stemp = utf8_to_utf16_string_alloc(input.c_str());
-	LPCWSTR sw = stemp.c_str();
-	return sw;
+// Result must be kept alive while the pointer is used
+WideStringUWP convertToLPCWSTR(const std::string& input) {
+	return UTF8ToWideStringUWP(input);
 }
 
 LPCWSTR convertToLPCWSTR(Platform::String^ input) {
@@ -201,38 +133,54 @@ LPCWSTR convertToLPCWSTR(Platform::String^ input) {
 	return sw;
 }
 
+// Valid until the next call on the same thread
 const char* convertToChar(Platform::String^ input) {
-	return utf16_to_utf8_string_alloc(input->Data());
+	thread_local std::string buffer;
+	buffer.clear();
+	if (input != nullptr) {
+		WideToUTF8UWP(std::wstring_view(input->Data(), input->Length()), buffer);
+	}
+	return buffer.c_str();
 }
 
+// ASCII only, non-ASCII bytes are kept as is
 void tolower(std::string& input) {
-	std::transform(input.begin(), input.end(), input.begin(), std::tolower);
+	ToLowerASCIIUWP(input.data(), input.size());
 }
 
 void tolower(Platform::String^& input) {
-	std::string temp = convert(input);
-	tolower(temp);
-	input = convert(temp);
+	if (input == nullptr) {
+		return;
+	}
+	std::wstring temp(input->Data(), input->Length());
+	ToLowerASCIIUWP(temp.data(), temp.size());
+	input = ref new Platform::String(temp.c_str(), (unsigned int)temp.size());
 }
 
 void toupper(std::string& input) {
-	std::transform(input.begin(), input.end(), input.begin(), std::toupper);
+	ToUpperASCIIUWP(input.data(), input.size());
 }
 
 void toupper(Platform::String^& input) {
-	std::string temp = convert(input);
-	toupper(temp);
-	input = convert(temp);
+	if (input == nullptr) {
+		return;
+	}
+	std::wstring temp(input->Data(), input->Length());
+	ToUpperASCIIUWP(temp.data(), temp.size());
+	input = ref new Platform::String(temp.c_str(), (unsigned int)temp.size());
 }
 
 void windowsPath(std::string& path) {
-	std::replace(path.begin(), path.end(), '/', '\\');
+	ReplaceCharUWP(path.data(), path.size(), '/', '\\');
 }
 
 void windowsPath(Platform::String^& path) {
-	std::string temp = convert(path);
-	windowsPath(temp);
-	path = convert(temp);
+	if (path == nullptr) {
+		return;
+	}
+	std::wstring temp(path->Data(), path->Length());
+	ReplaceCharUWP(temp.data(), temp.size(), L'/', L'\\');
+	path = ref new Platform::String(temp.c_str(), (unsigned int)temp.size());
 }
 
 std::string merge(std::string targetFullPath, std::string subFullPath) {
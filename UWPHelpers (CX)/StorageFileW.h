@@ -12,6 +12,7 @@
 
 #include "StorageLog.h"
 #include "StoragePath.h"
+#include "StoragePathCompare.h"
 #include "StorageExtensions.h"
 #include "StorageHandler.h"
 #include "StorageAsync.h"
@@ -103,11 +104,7 @@ public:
 
 	// Compare file with std::string
 	bool Equal(std::string path) {
-		std::string filePath = GetPath();
-
-		// Fix slashs back from '/' to '\'
-		windowsPath(path);
-		return iequals(filePath, path);
+		return PathEqualsUWP(GetPath(), path);
 	}
 
 	// Compare file with Platform::String
@@ -11,12 +11,16 @@
 
 #include "StorageLog.h"
 #include "StoragePath.h"
+#include "StoragePathCompare.h"
 #include "StorageExtensions.h"
 #include "StorageHandler.h"
 #include "StorageAsync.h"
 #include "StorageFileW.h"
 #include "StorageInfo.h"
 
+#include <vector>
+#include <unordered_map>
+
 using namespace Platform;
 using namespace Windows::Storage;
 using namespace Windows::Foundation;
@@ -62,11 +66,7 @@ public:
 
 	// Compare folder with std::string
 	bool Equal(std::string path) {
-		std::string folderPath = GetPath();
-
-		// Fix slashs back from '/' to '\'
-		windowsPath(path);
-		return iequals(folderPath, path);
+		return PathEqualsUWP(GetPath(), path);
 	}
 
 	// Compare folder with Platform::String
@@ -239,6 +239,33 @@ public:
 		return folders;
 	}
 
+	// Names of files and folders (1st level) from one listing
+	// 'maxCount' stops the listing early, 0 lists all items
+	std::vector<std::string> GetItemNames(uint32_t maxCount = 0) {
+		std::vector<std::string> names;
+
+		IVectorView<IStorageItem^>^ sItems;
+		if (maxCount > 0) {
+			ExecuteTask(sItems, storageFolder->GetItemsAsync(0, maxCount));
+		}
+		else {
+			ExecuteTask(sItems, storageFolder->GetItemsAsync());
+		}
+		if (sItems != nullptr) {
+			names.reserve(sItems->Size);
+			for (auto it = 0; it != sItems->Size; ++it) {
+				auto sItem = sItems->GetAt(it);
+				if (sItem != nullptr) {
+					names.push_back(convert(sItem->Name));
+				}
+			}
+		}
+		delete sItems;
+		UWP_VERBOSE_LOG(UWPSMT, "Total names listed (%d) in (%s)", names.size(), GetPath().c_str());
+
+		return names;
+	}
+
 	// Ensure item path without root
 	std::string CleanItemPath(PathUWP& path) {
 		std::string itemName = path.ToString();
@@ -249,13 +276,14 @@ public:
 
 			// If full path detected item in sub location,
 			// root path must be removed
-			replace(itemName, convert(storageFolder->Path + "\\"), "");
-			replace(itemName, GetPath(), "");
+			std::string_view relative;
+			if (GetRelativePathUWP(GetPath(), itemName, relative)) {
+				itemName = std::string(relative);
+			}
 		}
 
 		// Do some fixes because 'TryGetItemAsync' is very sensetive 
-		replace(itemName, "\\\\", "\\");
-		replace(itemName, "//", "/");
+		// (PathUWP is already canonical, no repeated slashes or dot segments)
 		replace(itemName, "*", "");
 		rtrim(itemName, ":"); // remove ':' at the end of the path (if any)
 
@@ -264,14 +292,23 @@ public:
 		return itemName;
 	}
 
-	// Check if folder contains item by name or path
-	bool Contains(PathUWP path, IStorageItem^& storageItem) {
+	// Lookup operation for batched calls, nullptr if path is for parent
+	Windows::Foundation::IAsyncOperation<IStorageItem^>^ ContainsAsync(PathUWP path) {
 		auto pathString = CleanItemPath(path);
 
 		// If the path is for parent then ignore
-		if (!path.IsAbsolute()) {
-			UWP_VERBOSE_LOG(UWPSMT, "Looking for (%s) in (%s)", pathString.c_str(), GetPath().c_str());
-			ExecuteTask(storageItem, storageFolder->TryGetItemAsync(convert(pathString)));
+		if (path.IsAbsolute()) {
+			return nullptr;
+		}
+		UWP_VERBOSE_LOG(UWPSMT, "Looking for (%s) in (%s)", pathString.c_str(), GetPath().c_str());
+		return storageFolder->TryGetItemAsync(convert(pathString));
+	}
+
+	// Check if folder contains item by name or path
+	bool Contains(PathUWP path, IStorageItem^& storageItem) {
+		auto operation = ContainsAsync(path);
+		if (operation != nullptr) {
+			ExecuteTask(storageItem, operation);
 		}
 
 		return storageItem != nullptr;
@@ -282,38 +319,19 @@ public:
 		return Contains(PathUWP(path), tempItem);
 	}
 
+	// Create (or open) the folders chain one level at a time
 	void BuildStructure(StorageFolder^& folder, std::string path) {
-		std::string folderName;
-		if (!path.empty()) {
-			std::vector<std::string> locationParts = split(path, '\\');
-			for each (auto dir in locationParts) {
-				folderName.append(dir);
-				// Create folder
-				ExecuteTask(folder, storageFolder->CreateFolderAsync(convert(folderName), CreationCollisionOption::OpenIfExists));
-				folderName.append("\\");
-			}
-		}
-		else {
-			// No structure required to be build
-			folder = storageFolder;
-		}
+		BuildStructure(folder, path, storageFolder);
 	}
 
 	void BuildStructure(StorageFolder^& folder, std::string path, StorageFolder^ target) {
-		IStorageItem^ test = nullptr;
-		ExecuteTask(test, target->TryGetItemAsync(convert(path)));
-		if (test == nullptr) {
-			std::string folderName;
-			std::vector<std::string> locationParts = split(path, '\\');
-			for each (auto dir in locationParts) {
-				folderName.append(dir);
-				// Create folder
-				ExecuteTask(folder, target->CreateFolderAsync(convert(folderName), CreationCollisionOption::OpenIfExists));
-				folderName.append("\\");
+		folder = target;
+		for (auto dir : PathComponentsUWP(path)) {
+			if (folder == nullptr) {
+				break;
 			}
-		}
-		else {
-			folder = (StorageFolder^)test;
+			// Create folder
+			ExecuteTask(folder, folder->CreateFolderAsync(convert(std::string(dir)), CreationCollisionOption::OpenIfExists));
 		}
 	}
 
@@ -352,21 +370,36 @@ public:
 			std::string rootPath = PathUWP(GetPath()).GetDirectory();
 			windowsPath(rootPath);
 
+			// Files usually share folders, each folder is created once
+			std::unordered_map<std::string, StorageFolder^> createdFolders;
+
 			if (destination != nullptr) {
 				for each (auto file in files) {
 					auto fItem = file.GetStorageFile();
 
 					// Get file full path
-					std::string targetLocation = convert(fItem->Path);
+					std::string filePath = convert(fItem->Path);
 					// Remove root path but keep the parent name
-					replace(targetLocation, rootPath, "");
-					replace(targetLocation, convert("\\" + fItem->Name), "");
-					ltrim(targetLocation, "\\");
-					rtrim(targetLocation, "\\");
+					std::string_view relative;
+					if (!GetRelativePathUWP(rootPath, filePath, relative)) {
+						failedCount++;
+						continue;
+					}
+					size_t namePos = relative.find_last_of("\\/");
+					std::string targetLocation(relative.substr(0, namePos != std::string_view::npos ? namePos : 0));
 
 					// Build folder structure
 					StorageFolder^ targetFolder;
-					BuildStructure(targetFolder, targetLocation, destination);
+					auto folderIter = createdFolders.find(targetLocation);
+					if (folderIter != createdFolders.end()) {
+						targetFolder = folderIter->second;
+					}
+					else {
+						BuildStructure(targetFolder, targetLocation, destination);
+						if (targetFolder != nullptr) {
+							createdFolders.emplace(targetLocation, targetFolder);
+						}
+					}
 
 					if (targetFolder != nullptr) {
 						// Copy file
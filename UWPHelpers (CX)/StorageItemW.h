@@ -12,6 +12,7 @@
 
 #include "StorageLog.h"
 #include "StoragePath.h"
+#include "StoragePathCompare.h"
 #include "StorageExtensions.h"
 #include "StorageHandler.h"
 #include "StorageAsync.h"
@@ -50,7 +51,7 @@ public:
 		delete storageItem;
 	}
 
-	bool IsDirectory() {
+	bool IsDirectory() const {
 		return isDirectory;
 	}
 
@@ -154,11 +155,7 @@ public:
 
 	// Compare item with std::string
 	bool Equal(std::string path) {
-		std::string itemPath = GetPath();
-
-		// Fix slashs back from '/' to '\'
-		windowsPath(path);
-		return iequals(itemPath, path);
+		return PathEqualsUWP(GetPath(), path);
 	}
 
 	// Compare item with Platform::String
@@ -250,6 +247,11 @@ public:
 		return storageFolderW.Contains(path, storageItem);
 	}
 
+	// Lookup operation for batched calls (folders only)
+	Windows::Foundation::IAsyncOperation<IStorageItem^>^ ContainsAsync(PathUWP path) {
+		return storageFolderW.ContainsAsync(path);
+	}
+
 	// Get all sub folders (deep scan)
 	std::list<StorageFolderW> GetAllFolders(bool useWindowsIndexer = false) {
 		return storageFolderW.GetAllFolders(useWindowsIndexer);
@@ -268,6 +270,10 @@ public:
 		return storageFolderW.GetFiles();
 	}
 
+	std::vector<std::string> GetItemNames(uint32_t maxCount = 0) {
+		return storageFolderW.GetItemNames(maxCount);
+	}
+
 	// Get item properties
 	FILE_BASIC_INFO* GetProperties() {
 		if (IsDirectory()) {
@@ -0,0 +1,118 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Latency histogram of blocking broker waits
+// buckets are powers of two in microseconds, recording is lock free
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "StorageLimits.h"
+
+struct LatencyStatsUWP {
+	uint64_t count = 0;
+	uint64_t timeouts = 0;
+	uint64_t canceled = 0;
+	// Microseconds, upper bound of the bucket (within 2x)
+	uint64_t p50 = 0;
+	uint64_t p95 = 0;
+	uint64_t p99 = 0;
+	uint64_t max = 0; // Exact
+};
+
+class LatencyHistogramUWP {
+public:
+	static const size_t BUCKETS = 32; // Last bucket holds everything above ~35 minutes
+
+	void Record(uint64_t micros, StorageCallResultUWP result = STORAGE_CALL_COMPLETED) {
+		size_t bucket = 0;
+		while (bucket + 1 < BUCKETS && (1ull << bucket) <= micros) {
+			bucket++;
+		}
+		buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+		if (result == STORAGE_CALL_TIMEOUT) {
+			timeouts.fetch_add(1, std::memory_order_relaxed);
+		}
+		else if (result == STORAGE_CALL_CANCELED) {
+			canceled.fetch_add(1, std::memory_order_relaxed);
+		}
+		uint64_t current = maximum.load(std::memory_order_relaxed);
+		while (micros > current && !maximum.compare_exchange_weak(current, micros, std::memory_order_relaxed)) {
+		}
+	}
+
+	LatencyStatsUWP Stats() const {
+		LatencyStatsUWP stats;
+		uint64_t counts[BUCKETS];
+		for (size_t i = 0; i < BUCKETS; i++) {
+			counts[i] = buckets[i].load(std::memory_order_relaxed);
+			stats.count += counts[i];
+		}
+		stats.timeouts = timeouts.load(std::memory_order_relaxed);
+		stats.canceled = canceled.load(std::memory_order_relaxed);
+		stats.max = maximum.load(std::memory_order_relaxed);
+		stats.p50 = Percentile(counts, stats.count, 50);
+		stats.p95 = Percentile(counts, stats.count, 95);
+		stats.p99 = Percentile(counts, stats.count, 99);
+		return stats;
+	}
+
+	void Clear() {
+		for (auto& bucket : buckets) {
+			bucket = 0;
+		}
+		timeouts = 0;
+		canceled = 0;
+		maximum = 0;
+	}
+
+private:
+	uint64_t Percentile(const uint64_t* counts, uint64_t total, uint64_t percent) const {
+		if (total == 0) {
+			return 0;
+		}
+		uint64_t rank = (total * percent + 99) / 100;
+		uint64_t seen = 0;
+		for (size_t i = 0; i < BUCKETS; i++) {
+			seen += counts[i];
+			if (seen >= rank) {
+				// Bucket 'i' holds [2^(i-1), 2^i)
+				uint64_t bound = (i + 1 < BUCKETS) ? (1ull << i) : maximum.load(std::memory_order_relaxed);
+				return (std::min)(bound, maximum.load(std::memory_order_relaxed));
+			}
+		}
+		return maximum.load(std::memory_order_relaxed);
+	}
+
+	std::atomic<uint64_t> buckets[BUCKETS] = {};
+	std::atomic<uint64_t> timeouts{ 0 };
+	std::atomic<uint64_t> canceled{ 0 };
+	std::atomic<uint64_t> maximum{ 0 };
+};
+
+// Records the lifetime of a wait
+class LatencyScopeUWP {
+public:
+	explicit LatencyScopeUWP(LatencyHistogramUWP& histogram) : histogram(histogram), start(std::chrono::steady_clock::now()) {
+	}
+
+	~LatencyScopeUWP() {
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		histogram.Record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), result);
+	}
+
+	void SetResult(StorageCallResultUWP state) {
+		result = state;
+	}
+
+private:
+	LatencyHistogramUWP& histogram;
+	std::chrono::steady_clock::time_point start;
+	StorageCallResultUWP result = STORAGE_CALL_COMPLETED;
+};
@@ -0,0 +1,49 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Known locations registry
+// app folders never change while the app is running,
+// so they are resolved once and matched as case folded prefixes
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+enum class LocationTypeUWP {
+	UNKNOWN = 0,
+	LOCAL_STATE = 1, // App data (LocalState)
+	TEMP_STATE = 2, // App data (TempState)
+	LOCAL_CACHE = 3, // App data (LocalCache)
+	INSTALL = 4, // Installation folder
+	PICKED = 5, // Covered by FutureAccessList items
+	DRIVE_ACCESSIBLE = 6, // Drive with direct access (broadFileSystemAccess or similar)
+};
+
+class LocationRegistryUWP {
+public:
+	// Both '/' and '\' are accepted, trailing separator is ignored
+	void AddRoot(LocationTypeUWP type, const std::string& path);
+
+	// Match against registered roots (deepest root wins)
+	// only 'UNKNOWN' or registered types can be returned
+	LocationTypeUWP Classify(const std::string& path) const;
+
+	// Registered path (original form) for type, empty if not registered
+	const std::string& GetRoot(LocationTypeUWP type) const;
+
+private:
+	struct Root {
+		LocationTypeUWP type;
+		std::string path; // As registered
+		std::string prefix; // Case folded, '\' separators, no trailing separator
+	};
+
+	std::vector<Root> roots; // Longest prefix first
+	std::string emptyRoot;
+
+	static bool MatchPrefix(const std::string& path, const std::string& prefix);
+};
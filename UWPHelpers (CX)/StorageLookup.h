@@ -0,0 +1,39 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Lookup list snapshots [Internal usage]
+// the lookup list is published as immutable versions,
+// readers take the current version and never see partial updates,
+// writers (pickers, FillLookupList) copy it, apply changes and publish a new one
+
+#pragma once
+
+#include <memory>
+#include <functional>
+
+#include "StorageItemW.h"
+#include "StoragePathTrie.h"
+#include "StorageVersioned.h"
+#include "StorageSnapshot.h"
+
+typedef PathTrieUWP<StorageItemW> LookupIndexUWP;
+typedef std::shared_ptr<const LookupIndexUWP> LookupSnapshotUWP;
+
+// Current lookup list version (safe to call from any thread)
+LookupSnapshotUWP GetLookupSnapshot();
+
+// Copy the current version, apply 'update' then publish the result
+// writers are serialized, readers are never blocked
+void UpdateLookupList(std::function<void(LookupIndexUWP&)> update);
+
+// Warm start entries (loaded from the last saved snapshot)
+// used only until the picked items are restored, empty after that
+typedef PathTrieUWP<LookupSnapshotEntryUWP> WarmIndexUWP;
+std::shared_ptr<const WarmIndexUWP> GetWarmLookupIndex();
+
+// Resolve the warm entry that covers 'path' (if any) and add it to the lookup list
+// return true if the path is covered by the lookup list now
+bool ResolveWarmEntry(const std::string& path);
@@ -15,6 +15,11 @@
 #include "StorageAccess.h"
 #include "StorageItemW.h"
 #include "StorageLog.h"
+#include "StorageLookup.h"
+#include "StoragePathCompare.h"
+#include "StoragePathString.h"
+#include "StorageMounts.h"
+#include "StorageExecutor.h"
 
 #include <vector>
 #include <stdio.h>
@@ -29,6 +34,11 @@
 #include <string>
 #include <map>
 #include <set>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <ppltasks.h>
 
 using namespace Windows::Storage;
 using namespace Windows::Storage::Pickers;
@@ -37,8 +47,6 @@ using namespace Windows::System;
 using namespace Windows::Storage::Streams;
 using namespace Windows::Security::Cryptography;
 
-extern std::list<StorageItemW> FutureAccessItems;
-
 // Simply define `UWP_LEGACY` to force legacy APIs
 #if _M_ARM || defined(UWP_LEGACY)
 #define TARGET_IS_16299_OR_LOWER
@@ -62,6 +70,26 @@ std::string GetLastErrorAsString() {
 }
 
 #pragma region Locations
+// Known locations (resolved once, see 'StorageLocations.h')
+struct KnownLocationsUWP {
+	LocationRegistryUWP registry;
+	std::string appDataRoot; // Package data folder (parent of LocalState)
+};
+
+const KnownLocationsUWP& GetKnownLocations() {
+	static const KnownLocationsUWP locations = []() {
+		KnownLocationsUWP known;
+		known.registry.AddRoot(LocationTypeUWP::LOCAL_STATE, convert(ApplicationData::Current->LocalFolder->Path));
+		known.registry.AddRoot(LocationTypeUWP::TEMP_STATE, convert(ApplicationData::Current->TemporaryFolder->Path));
+		known.registry.AddRoot(LocationTypeUWP::LOCAL_CACHE, convert(ApplicationData::Current->LocalCacheFolder->Path));
+		known.registry.AddRoot(LocationTypeUWP::INSTALL, convert(Package::Current->InstalledLocation->Path));
+		known.appDataRoot = known.registry.GetRoot(LocationTypeUWP::LOCAL_STATE);
+		replace(known.appDataRoot, "\\LocalState", "");
+		return known;
+	}();
+	return locations;
+}
+
 std::string GetWorkingFolder() {
 	if (AppWorkingFolder.empty()) {
 		return GetLocalFolder();
@@ -77,16 +105,16 @@ void SetWorkingFolder(std::wstring location) {
 	SetWorkingFolder(convert(location));
 }
 std::string GetInstallationFolder() {
-	return convert(Package::Current->InstalledLocation->Path);
+	return GetKnownLocations().registry.GetRoot(LocationTypeUWP::INSTALL);
 }
 StorageFolder^ GetLocalStorageFolder() {
 	return ApplicationData::Current->LocalFolder;
 }
 std::string GetLocalFolder() {
-	return convert(GetLocalStorageFolder()->Path);
+	return GetKnownLocations().registry.GetRoot(LocationTypeUWP::LOCAL_STATE);
 }
 std::string GetTempFolder() {
-	return convert(ApplicationData::Current->TemporaryFolder->Path);
+	return GetKnownLocations().registry.GetRoot(LocationTypeUWP::TEMP_STATE);
 }
 std::string GetTempFile(std::string name) {
 	StorageFile^ tmpFile;
@@ -120,9 +148,7 @@ std::string GetMusicFolder() {
 std::string GetPreviewPath(std::string path) {
 	std::string pathView = path;
 	windowsPath(pathView);
-	std::string appData = GetLocalFolder();
-	replace(appData, "\\LocalState", "");
-	replace(pathView, appData, "AppData");
+	replace(pathView, GetKnownLocations().appDataRoot, "AppData");
 	return pathView;
 }
 bool isLocalState(std::string path) {
@@ -133,15 +159,129 @@ bool isLocalState(std::wstring path) {
 }
 #pragma endregion
 
+#pragma region Mounts
+// Mount table versions (same as the lookup list, see 'StorageLookup.h')
+// readers take the current version, writers copy it and publish a new one
+std::shared_ptr<const MountTableUWP> MountPoints = std::make_shared<MountTableUWP>();
+std::mutex MountPointsWriteLock;
+std::atomic<bool> HasMountPoints{ false };
+std::once_flag MountPointsLoaded;
+
+void LoadMountPoints() {
+#if MOUNT_TABLE_PERSIST
+	try {
+		std::string data = GetDataFromLocalSettings(MOUNT_TABLE_SETTINGS_KEY);
+		if (!data.empty()) {
+			auto table = std::make_shared<MountTableUWP>();
+			size_t count = table->Deserialize(data);
+			std::atomic_store(&MountPoints, std::shared_ptr<const MountTableUWP>(table));
+			HasMountPoints = count > 0;
+			UWP_DEBUG_LOG(UWPSMT, "Mount points loaded (%d)", (int)count);
+		}
+	}
+	catch (...) {
+		UWP_WARN_LOG(UWPSMT, "Couldn't load mount points");
+	}
+#endif
+}
+
+std::shared_ptr<const MountTableUWP> GetMountTable() {
+	std::call_once(MountPointsLoaded, LoadMountPoints);
+	return std::atomic_load(&MountPoints);
+}
+
+// Copy the current table, apply 'update' then publish (and save) the result
+bool UpdateMountTable(std::function<bool(MountTableUWP&)> update) {
+	std::call_once(MountPointsLoaded, LoadMountPoints);
+	std::lock_guard<std::mutex> lock(MountPointsWriteLock);
+	auto next = std::make_shared<MountTableUWP>(*std::atomic_load(&MountPoints));
+	if (!update(*next)) {
+		return false;
+	}
+	std::atomic_store(&MountPoints, std::shared_ptr<const MountTableUWP>(next));
+	HasMountPoints = !next->empty();
+#if MOUNT_TABLE_PERSIST
+	try {
+		AddDataToLocalSettings(MOUNT_TABLE_SETTINGS_KEY, next->Serialize(), true);
+	}
+	catch (...) {
+		UWP_WARN_LOG(UWPSMT, "Couldn't save mount points");
+	}
+#endif
+	return true;
+}
+
+// Virtual roots are set, any path may be routed to another location
+bool HasMountedRoots() {
+	std::call_once(MountPointsLoaded, LoadMountPoints);
+	return HasMountPoints.load(std::memory_order_acquire);
+}
+
+// Route virtual root to its real location, 'path' is replaced only on match
+bool ResolveMountPoint(PathUWP& path) {
+	std::call_once(MountPointsLoaded, LoadMountPoints);
+	if (!HasMountPoints.load(std::memory_order_acquire)) {
+		return false;
+	}
+	thread_local std::string resolved;
+	if (!std::atomic_load(&MountPoints)->Resolve(path.ToString(), resolved)) {
+		return false;
+	}
+	path = PathUWP(resolved);
+	return true;
+}
+
+void ForgetCachedTree(const std::string& path);
+
+bool MountUWP(std::string root, std::string target) {
+	bool state = UpdateMountTable([&](MountTableUWP& table) {
+		return table.Mount(root, target);
+	});
+	if (state) {
+		UWP_DEBUG_LOG(UWPSMT, "Mounted (%s) to (%s)", root.c_str(), target.c_str());
+		ForgetCachedTree(root);
+	}
+	else {
+		UWP_ERROR_LOG(UWPSMT, "Couldn't mount (%s) to (%s)", root.c_str(), target.c_str());
+	}
+	return state;
+}
+bool MountUWP(std::wstring root, std::wstring target) {
+	return MountUWP(convert(root), convert(target));
+}
+bool UnmountUWP(std::string root) {
+	bool state = UpdateMountTable([&](MountTableUWP& table) {
+		return table.Unmount(root);
+	});
+	if (state) {
+		UWP_DEBUG_LOG(UWPSMT, "Unmounted (%s)", root.c_str());
+		ForgetCachedTree(root);
+	}
+	return state;
+}
+bool UnmountUWP(std::wstring root) {
+	return UnmountUWP(convert(root));
+}
+std::vector<MountPointUWP> GetMountPointsUWP() {
+	return GetMountTable()->GetMountPoints();
+}
+#pragma endregion
+
 #pragma region Internal
 PathUWP PathResolver(PathUWP path) {
-	auto root = path.GetDirectory();
-	auto newPath = path.ToString();
-	if (path.IsRoot() || iequals(root, "/") || iequals(root, "\\")) {
+	// Virtual roots first ('/roms/a.iso' -> 'D:/Games/ROMs/a.iso')
+	if (ResolveMountPoint(path)) {
+		return path;
+	}
+
+	auto root = path.GetDirectoryView();
+	if (path.IsRoot() || root == "/" || root == "\\") {
 		// System requesting file from app data
+		auto newPath = path.ToString();
 		replace(newPath, "/", (GetLocalFolder() + (path.size() > 1 ? "/" : "")));
+		path = PathUWP(newPath);
 	}
-	path = PathUWP(newPath);
+	// Already normalized otherwise
 	return path;
 }
 PathUWP PathResolver(std::string path) {
@@ -152,51 +292,436 @@ std::string ResolvePathUWP(std::string path) {
 	return PathResolver(path).ToString();
 }
 
+// Resolved path (forward slashes) matches the Windows form of the original
+bool IsSameSpelling(const std::string& resolved, const std::string& original) {
+	if (resolved.size() != original.size()) {
+		return false;
+	}
+	for (size_t i = 0; i < resolved.size(); i++) {
+		char expected = resolved[i] == '/' ? '\\' : resolved[i];
+		if (original[i] != expected) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Wide only path that resolving leaves as is, no UTF-8 form is needed to resolve it
+bool IsResolvedWide(const PathStringUWP& path) {
+	return !path.HasUTF8() && IsPlainWidePathUWP(path.Wide()) && !HasMountedRoots();
+}
+
+// Resolved path of a call, built once for the cache keys and the tier checks
+// the caller's UTF-8 form is only made when the fallback needs it
+PathUWP ResolveDualPath(const PathStringUWP& path) {
+	if (IsResolvedWide(path)) {
+		return PathUWP(path.Wide());
+	}
+	return PathResolver(path.UTF8());
+}
+
+// Wide path for Win32 APIs, the caller's wide form is used as is
+// unless resolving changed it (root relative, prefixed or unclean paths)
+const std::wstring& ResolveWidePath(const PathStringUWP& path, std::wstring& resolved) {
+	if (IsResolvedWide(path)) {
+		return path.Wide();
+	}
+	auto p = PathResolver(path.UTF8());
+	if (IsSameSpelling(p.ToString(), path.UTF8())) {
+		return path.Wide();
+	}
+	resolved = p.ToWString();
+	return resolved;
+}
+
+#pragma region Caches
+NegativeCacheUWP MissingItems(NEGATIVE_CACHE_SIZE, NEGATIVE_CACHE_TTL);
+LRUCacheUWP<StorageItemW> ResolvedItems(RESOLVED_CACHE_SIZE, RESOLVED_CACHE_TTL);
+TierStrategyUWP AccessTiers(TIER_STRATEGY_SIZE, TIER_STRATEGY_REPROBE, TIER_STRATEGY_FAILURES);
+NameIndexUWP RealNames(NAME_INDEX_SIZE, NAME_INDEX_MAX_NAMES, NAME_INDEX_TTL);
+
+// Key of a path that is resolved already ('PathResolver')
+std::string GetCacheKey(const PathUWP& resolved) {
+	std::string key = resolved.ToString();
+	FoldCacheKey(key);
+	return key;
+}
+std::string GetCacheKey(const std::string& path) {
+	return GetCacheKey(PathResolver(path));
+}
+
+// Limits of the calling thread were reached ('StorageLimitScopeUWP')
+// remaining tiers are skipped, the call fails with 'ERROR_TIMEOUT' or 'ERROR_CANCELLED'
+bool IsCallStopped() {
+	auto state = CheckStorageLimitsUWP();
+	if (state == STORAGE_CALL_COMPLETED) {
+		return false;
+	}
+	SetStoppedError(state);
+	return true;
+}
+
+// Failures after a stop say nothing about the path, they must not be learned
+bool WasCallStopped() {
+	auto limits = CurrentStorageLimitsUWP();
+	return limits != nullptr && limits->result != STORAGE_CALL_COMPLETED;
+}
+
+// I/O executor (async versions, background work)
+// created once and never destroyed, workers may still be inside broker calls at exit
+StorageExecutorUWP& GetStorageExecutor() {
+	static StorageExecutorUWP* executor = new StorageExecutorUWP(IO_EXECUTOR_WORKERS, IO_EXECUTOR_BACKGROUND_WORKERS, IO_EXECUTOR_YIELD_MAX);
+	return *executor;
+}
+
+// Background jobs pause here while interactive requests are pending
+void YieldToInteractive() {
+	GetStorageExecutor().Yield();
+}
+
+// Path was not found by API nor by UWP fallback
+// helpers take the resolved path of the call ('ResolveDualPath'), string versions resolve it first
+bool IsKnownMissing(const PathUWP& resolved) {
+#if NEGATIVE_CACHE_ENABLED
+	return MissingItems.IsMissing(GetCacheKey(resolved));
+#else
+	return false;
+#endif
+}
+bool IsKnownMissing(const std::string& path) {
+	return IsKnownMissing(PathResolver(path));
+}
+
+void MarkAsMissing(const PathUWP& resolved) {
+#if NEGATIVE_CACHE_ENABLED
+	if (WasCallStopped()) {
+		return;
+	}
+	MissingItems.MarkMissing(GetCacheKey(resolved));
+#endif
+}
+void MarkAsMissing(const std::string& path) {
+	MarkAsMissing(PathResolver(path));
+}
+
+// Path (or anything below it) may exist now
+void InvalidateMissing(const PathUWP& resolved) {
+#if NEGATIVE_CACHE_ENABLED
+	MissingItems.Invalidate(GetCacheKey(resolved));
+#endif
+}
+void InvalidateMissing(const std::string& path) {
+	InvalidateMissing(PathResolver(path));
+}
+
+// Item at path (or anything below it) was deleted, moved or replaced
+void ForgetResolvedItem(const PathUWP& resolved) {
+#if RESOLVED_CACHE_ENABLED
+	ResolvedItems.EraseTree(GetCacheKey(resolved));
+#endif
+}
+void ForgetResolvedItem(const std::string& path) {
+	ForgetResolvedItem(PathResolver(path));
+}
+
+// Root routes to another location now, anything cached for its new route may be stale
+void ForgetCachedTree(const std::string& path) {
+	std::string key = GetCacheKey(path);
+#if NEGATIVE_CACHE_ENABLED
+	MissingItems.Invalidate(key);
+#endif
+#if RESOLVED_CACHE_ENABLED
+	ResolvedItems.EraseTree(key);
+#endif
+#if NAME_INDEX_ENABLED
+	RealNames.EraseTree(key);
+#endif
+}
+
+// Item created through storage manager, add it to the name index of its folder
+void IndexItemAdded(const PathUWP& resolved) {
+#if NAME_INDEX_ENABLED
+	RealNames.AddName(GetCacheKey(PathUWP(resolved.GetDirectory())), resolved.GetFilenameView());
+#endif
+}
+void IndexItemAdded(const std::string& path) {
+	IndexItemAdded(PathResolver(path));
+}
+
+// Item removed through storage manager (the folder itself may be indexed too)
+void IndexItemRemoved(const PathUWP& resolved) {
+#if NAME_INDEX_ENABLED
+	RealNames.RemoveName(GetCacheKey(PathUWP(resolved.GetDirectory())), resolved.GetFilenameView());
+	RealNames.EraseTree(GetCacheKey(resolved));
+#endif
+}
+void IndexItemRemoved(const std::string& path) {
+	IndexItemRemoved(PathResolver(path));
+}
+
+// Strategy root: deepest picked folder or volume
+std::string GetStrategyRoot(const PathUWP& resolved) {
+	const std::string& path = resolved.ToString();
+	size_t length = GetLookupSnapshot()->GetDeepestPrefixLength(path);
+	std::string root = (length > 0) ? path.substr(0, length) : resolved.GetRootVolume().ToString();
+	FoldCacheKey(root);
+	return root;
+}
+
+bool IsValidResolved(const PathUWP& p, bool allowForAppData = false);
+
+// Check if direct API should be tried before UWP fallback
+// 'tierRoot' stays empty when there is no fallback for the path
+bool ShouldTryAPI(const PathUWP& resolved, std::string& tierRoot) {
+#if TIER_STRATEGY_ENABLED
+	if (!IsValidResolved(resolved)) {
+		return true;
+	}
+	tierRoot = GetStrategyRoot(resolved);
+	return AccessTiers.ShouldTryAPI(tierRoot);
+#else
+	return true;
+#endif
+}
+bool ShouldTryAPI(const std::string& path, std::string& tierRoot) {
+	return ShouldTryAPI(PathResolver(path), tierRoot);
+}
+
+void ReportAPIResult(const std::string& tierRoot, bool success) {
+	if (WasCallStopped()) {
+		return;
+	}
+	AccessTiers.ReportAPI(tierRoot, success);
+}
+
+// 'missing' when the fallback reached the folder but there is no such item
+void ReportFallbackResult(const std::string& tierRoot, bool apiTried, bool success, bool missing = false) {
+	if (WasCallStopped()) {
+		return;
+	}
+	TierResultUWP result = success ? TIER_RESULT_SUCCESS : (missing ? TIER_RESULT_NOT_FOUND : TIER_RESULT_FAILED);
+	AccessTiers.ReportFallback(tierRoot, apiTried, result);
+}
+
+// Modes that don't create the file ('r', 'r+')
+bool IsReadMode(const char* mode) {
+	return mode != nullptr && mode[0] == 'r';
+}
+
+CacheStatsUWP GetNegativeCacheStats() {
+	return MissingItems.Stats();
+}
+
+CacheStatsUWP GetResolvedCacheStats() {
+	return ResolvedItems.Stats();
+}
+
+TierStatsUWP GetTierStrategyStats() {
+	return AccessTiers.Stats();
+}
+
+CacheStatsUWP GetNameIndexStats() {
+	return RealNames.Stats();
+}
+
+LatencyStatsUWP GetBrokerLatencyStats() {
+	return GetBrokerLatency().Stats();
+}
+
+void ClearStorageCaches() {
+	MissingItems.Clear();
+	ResolvedItems.Clear();
+	AccessTiers.Clear();
+	DriveAccessStates.Clear();
+	RealNames.Clear();
+}
+#pragma endregion
+
+// Lookup snapshot for the given path
+// picked items are restored in background, only wait for them
+// when the path is not covered by the known folders or by the warm snapshot
+LookupSnapshotUWP GetLookupSnapshotFor(const PathUWP& path) {
+	FillLookupList();
+
+	auto lookup = GetLookupSnapshot();
+	if (!IsLookupListReady()) {
+		std::vector<const StorageItemW*> ancestors;
+		lookup->GetAncestors(path.ToString(), ancestors, true);
+		if (ancestors.empty()) {
+			if (!ResolveWarmEntry(path.ToString())) {
+				WaitLookupListReady();
+			}
+			lookup = GetLookupSnapshot();
+		}
+	}
+	return lookup;
+}
+
+// Classification before picked items restored (warm snapshot)
+bool IsWarmContainsAccessibleItems(const PathUWP& path, bool anyLevel) {
+	FillLookupList();
+	if (IsLookupListReady()) {
+		return false;
+	}
+	auto warm = GetWarmLookupIndex();
+	return anyLevel ? warm->ContainsPrefix(path.ToString()) : warm->HasChildren(path.ToString());
+}
+
 // Return closer parent
 StorageItemW GetStorageItemParent(PathUWP path) {
 	path = PathResolver(path);
 	StorageItemW parent;
 
-	for (auto& fItem : FutureAccessItems) {
-		if (isChild(fItem.GetPath(), path.ToString())) {
-			if (fItem.IsDirectory()) {
-				parent = fItem;
-				break;
-			}
+	// Only true ancestors are checked (deepest first)
+	auto lookup = GetLookupSnapshotFor(path);
+	std::vector<const StorageItemW*> ancestors;
+	lookup->GetAncestors(path.ToString(), ancestors, true);
+	for (auto fItem : ancestors) {
+		if (fItem->IsDirectory()) {
+			parent = *fItem;
+			break;
 		}
 	}
 
 	return parent;
 }
 
-StorageItemW GetStorageItem(PathUWP path, bool createIfNotExists = false, bool forceFolderType = false) {
-	// Fill call will be ignored internally after the first call
-	FillLookupList();
+// First folder (deepest first) that contains the path
+// deepest folder is asked alone (usually enough), the others are asked at once
+StorageItemW FindInFolders(const PathUWP& path, std::vector<StorageItemW>& folders) {
+	if (folders.empty()) {
+		return StorageItemW();
+	}
+	IStorageItem^ storageItem;
+	if (folders[0].Contains(path, storageItem)) {
+		return StorageItemW(storageItem);
+	}
+	if (folders.size() == 1) {
+		return StorageItemW();
+	}
+	auto results = ExecuteBatch<IStorageItem^>(folders.size() - 1, [&](size_t index) {
+		return folders[index + 1].ContainsAsync(path);
+	}, nullptr);
+	for (auto& result : results) {
+		if (result.value != nullptr) {
+			return StorageItemW(result.value);
+		}
+	}
+	return StorageItemW();
+}
+
+#if NAME_INDEX_ENABLED
+// Resolve path below 'folder' with the real case of each name ('Data/ABC.PNG' -> 'data/abc.png')
+// folders on the way are listed once, then names are served from the index
+// listings per request are bounded ('NAME_INDEX_MAX_LISTINGS'), so misses stay cheap,
+// later requests continue from the indexed folders
+StorageItemW GetStorageItemByRealCase(const PathUWP& path, StorageItemW folder) {
+	std::string folderPath = folder.GetPath();
+	std::string_view relative;
+	if (!GetRelativePathUWP(folderPath, path.ToString(), relative) || relative.empty()) {
+		return StorageItemW();
+	}
+
+	std::string currentPath = folderPath;
+	std::string realRelative;
+	std::string realName;
+	int listings = 0;
+	for (auto component : PathComponentsUWP(relative)) {
+		std::string key = GetCacheKey(currentPath);
+		if (!RealNames.Lookup(key, component, realName)) {
+			if (listings++ >= NAME_INDEX_MAX_LISTINGS) {
+				return StorageItemW();
+			}
+			// Not indexed yet, list the folder
+			StorageItemW current = folder;
+			if (!realRelative.empty()) {
+				IStorageItem^ storageItem;
+				if (!folder.Contains(PathUWP(realRelative), storageItem)) {
+					return StorageItemW();
+				}
+				current = StorageItemW(storageItem);
+			}
+			if (!current.IsDirectory()) {
+				return StorageItemW();
+			}
+			// One extra name is enough to know the folder is too big to index
+			auto names = current.GetItemNames(NAME_INDEX_MAX_NAMES + 1);
+			if (WasCallStopped()) {
+				// Partial listing must not be indexed
+				return StorageItemW();
+			}
+			RealNames.Build(key, names);
+			RealNames.Lookup(key, component, realName);
+		}
+		if (realName.empty()) {
+			return StorageItemW();
+		}
+		if (!realRelative.empty()) {
+			realRelative.push_back('\\');
+		}
+		realRelative.append(realName);
+		currentPath.append("\\").append(realName);
+	}
+
+	IStorageItem^ storageItem;
+	if (folder.Contains(PathUWP(realRelative), storageItem)) {
+		UWP_DEBUG_LOG(UWPSMT, "Resolved by real case (%s)", currentPath.c_str());
+		return StorageItemW(storageItem);
+	}
+	return StorageItemW();
+}
+#endif
 
+StorageItemW GetStorageItem(PathUWP path, bool createIfNotExists = false, bool forceFolderType = false) {
 	path = PathResolver(path);
 	StorageItemW item;
 
+#if RESOLVED_CACHE_ENABLED
+	std::string cacheKey = GetCacheKey(path);
+	if (ResolvedItems.Get(cacheKey, item)) {
+		return item;
+	}
+#endif
+
+	// Cached items are still served after a stop
+	if (IsCallStopped()) {
+		return item;
+	}
+
 	// Look for match in FutureAccessItems
-	for (auto& fItem : FutureAccessItems) {
-		if (fItem.Equal(path)) {
-			item = fItem;
-			break;
-		}
+	auto lookup = GetLookupSnapshotFor(path);
+	auto match = lookup->Find(path.ToString());
+	if (match != nullptr) {
+		item = *match;
 	}
 
+	std::vector<const StorageItemW*> ancestors;
 	if (!item.IsValid()) {
 		// Look for match inside FutureAccessFolders
-		for (auto& fItem : FutureAccessItems) {
-			if (fItem.IsDirectory()) {
-				IStorageItem^ storageItem;
-				if (fItem.Contains(path, storageItem)) {
-					item = StorageItemW(storageItem);
-					break;
-				}
+		// only folders on the path can contain the item
+		lookup->GetAncestors(path.ToString(), ancestors);
+		// Snapshot items are shared between threads, work on copies
+		std::vector<StorageItemW> folders;
+		for (auto fItem : ancestors) {
+			if (fItem->IsDirectory()) {
+				folders.push_back(*fItem);
 			}
 		}
+		item = FindInFolders(path, folders);
 	}
 
+#if NAME_INDEX_ENABLED
+	if (!item.IsValid()) {
+		// Requested case may not match the real one, deepest folder is enough
+		for (auto fItem : ancestors) {
+			if (fItem->IsDirectory()) {
+				item = GetStorageItemByRealCase(path, *fItem);
+				break;
+			}
+		}
+	}
+#endif
+
 	if (!item.IsValid() && createIfNotExists) {
 		// Create and return new folder
 		auto parent = GetStorageItemParent(path);
@@ -211,6 +736,12 @@ StorageItemW GetStorageItem(PathUWP path, bool createIfNotExists = false, bool f
 			}
 		}
 	}
+
+#if RESOLVED_CACHE_ENABLED
+	if (item.IsValid()) {
+		ResolvedItems.Put(cacheKey, item);
+	}
+#endif
 	return item;
 }
 
@@ -223,10 +754,10 @@ std::list<StorageItemW> GetStorageItemsByParent(PathUWP path) {
 	std::list<StorageItemW> items;
 
 	// Look for match in FutureAccessItems
-	for (auto& fItem : FutureAccessItems) {
-		if (isParent(path.ToString(), fItem.GetPath(), fItem.GetName())) {
-			items.push_back(fItem);
-		}
+	std::vector<const StorageItemW*> children;
+	GetLookupSnapshotFor(path)->GetChildren(path.ToString(), children);
+	for (auto fItem : children) {
+		items.push_back(*fItem);
 	}
 
 	return items;
@@ -239,13 +770,10 @@ std::list<StorageItemW> GetStorageItemsByParent(std::string path) {
 bool IsContainsAccessibleItems(PathUWP path) {
 	path = PathResolver(path);
 
-	for (auto& fItem : FutureAccessItems) {
-		if (isParent(path.ToString(), fItem.GetPath(), fItem.GetName())) {
-			return true;
-		}
+	if (IsWarmContainsAccessibleItems(path, false)) {
+		return true;
 	}
-
-	return false;
+	return GetLookupSnapshotFor(path)->HasChildren(path.ToString());
 }
 
 bool IsContainsAccessibleItems(std::string path) {
@@ -258,27 +786,33 @@ bool IsContainsAccessibleItems(std::wstring path) {
 bool IsRootForAccessibleItems(PathUWP path, std::list<std::string>& subRoot, bool breakOnFirstMatch = false) {
 	path = PathResolver(path);
 
-	for (auto& fItem : FutureAccessItems) {
-		if (isChild(path.ToString(), fItem.GetPath())) {
-			if (breakOnFirstMatch) {
-				// Just checking, we don't need to loop for each item
-				return true;
-			}
-			auto sub = getSubRoot(path.ToString(), fItem.GetPath());
-
-			// This check can be better, but that's how I can do it in C++
-			if (!ends_with(sub, ":")) {
-				bool alreadyAdded = false;
-				for each (auto sItem in subRoot) {
-					if (iequals(sItem, sub)) {
-						alreadyAdded = true;
-						break;
-					}
-				}
-				if (!alreadyAdded) {
-					subRoot.push_back(sub);
+	if (breakOnFirstMatch && IsWarmContainsAccessibleItems(path, true)) {
+		return true;
+	}
+
+	auto lookup = GetLookupSnapshotFor(path);
+	if (breakOnFirstMatch) {
+		// Just checking, we don't need to collect the sub roots
+		return lookup->ContainsPrefix(path.ToString());
+	}
+
+	std::vector<std::string> names;
+	lookup->GetSubRoots(path.ToString(), names);
+	if (!names.empty()) {
+		std::string parent = path.ToString();
+		windowsPath(parent);
+		for (auto& name : names) {
+			auto sub = parent + "\\" + name;
+			bool alreadyAdded = false;
+			for each (auto sItem in subRoot) {
+				if (PathEqualsUWP(sItem, sub)) {
+					alreadyAdded = true;
+					break;
 				}
 			}
+			if (!alreadyAdded) {
+				subRoot.push_back(sub);
+			}
 		}
 	}
 	return !subRoot.empty();
@@ -309,75 +843,142 @@ bool CreateIfNotExists(int openMode) {
 	}
 }
 
-HANDLE CreateFileAPI(std::string path, long accessMode, long shareMode, long openMode) {
+HANDLE CreateFileAPI(const PathStringUWP& path, long accessMode, long shareMode, long openMode) {
+	if (IsCallStopped()) {
+		return INVALID_HANDLE_VALUE;
+	}
+	std::wstring resolved;
+	const std::wstring& widePath = ResolveWidePath(path, resolved);
 #ifdef TARGET_IS_16299_OR_LOWER
-	HANDLE hFile = CreateFile2(convertToLPCWSTR(path), accessMode, shareMode, openMode, nullptr);
+	HANDLE hFile = CreateFile2(widePath.c_str(), accessMode, shareMode, openMode, nullptr);
 #else
 	// If the item was in access future list, this will work fine
-	HANDLE hFile = CreateFile2FromAppW(convertToLPCWSTR(path), accessMode, shareMode, openMode, nullptr);
+	HANDLE hFile = CreateFile2FromAppW(widePath.c_str(), accessMode, shareMode, openMode, nullptr);
 #endif
 	return hFile;
 }
-HANDLE CreateFileUWP(std::string path, long accessMode, long shareMode, long openMode) {
-	HANDLE handle = CreateFileAPI(path, accessMode, shareMode, openMode);
-	if ((!handle || handle == INVALID_HANDLE_VALUE) && IsValidUWP(path)) {
-		bool createIfNotExists = CreateIfNotExists(openMode);
+HANDLE CreateFileUWP(const PathStringUWP& dualPath, long accessMode, long shareMode, long openMode) {
+	auto resolved = ResolveDualPath(dualPath);
+	bool createIfNotExists = CreateIfNotExists(openMode);
+	if (createIfNotExists) {
+		InvalidateMissing(resolved);
+	}
+	else if (IsKnownMissing(resolved)) {
+		SetLastError(ERROR_FILE_NOT_FOUND);
+		return INVALID_HANDLE_VALUE;
+	}
+
+	std::string tierRoot;
+	bool tryAPI = ShouldTryAPI(resolved, tierRoot);
+	HANDLE handle = INVALID_HANDLE_VALUE;
+	if (tryAPI) {
+		handle = CreateFileAPI(dualPath, accessMode, shareMode, openMode);
+		ReportAPIResult(tierRoot, handle && handle != INVALID_HANDLE_VALUE);
+	}
+	if ((!handle || handle == INVALID_HANDLE_VALUE) && IsValidResolved(resolved)) {
+		const std::string& path = dualPath.UTF8();
 		auto storageItem = GetStorageItem(path, createIfNotExists);
+		bool missing = false;
 
 		if (storageItem.IsValid()) {
 			UWP_DEBUG_LOG(UWPSMT, "Getting handle (%s)", path.c_str());
 			HRESULT hr = storageItem.GetHandle(&handle, accessMode, shareMode);
 			if (hr == E_FAIL) {
 				handle = INVALID_HANDLE_VALUE;
+				// Item could be changed outside storage manager
+				ForgetResolvedItem(resolved);
 			}
 		}
 		else {
 			handle = INVALID_HANDLE_VALUE;
 			UWP_ERROR_LOG(UWPSMT, "Couldn't find or access (%s)", path.c_str());
+			if (!createIfNotExists) {
+				MarkAsMissing(resolved);
+				missing = true;
+			}
 		}
+		ReportFallbackResult(tierRoot, tryAPI, handle != INVALID_HANDLE_VALUE, missing);
+	}
+	if (createIfNotExists && handle && handle != INVALID_HANDLE_VALUE) {
+		IndexItemAdded(resolved);
 	}
 	return handle;
 }
 
+HANDLE CreateFileUWP(std::string path, long accessMode, long shareMode, long openMode) {
+	return CreateFileUWP(PathStringUWP(std::move(path)), accessMode, shareMode, openMode);
+}
 HANDLE CreateFileUWP(std::wstring path, long accessMode, long shareMode, long openMode) {
-	auto pathString = convert(path);
-	return CreateFileUWP(pathString, accessMode, shareMode, openMode);
+	return CreateFileUWP(PathStringUWP(std::move(path)), accessMode, shareMode, openMode);
 }
 
-std::map<std::string, bool> accessState;
-bool CheckDriveAccess(std::string driveName, bool checkIfContainsFutureAccessItems) {
+ShardedCacheUWP<bool> DriveAccessStates(DRIVE_ACCESS_TTL);
+
+// Check if the direct API can write to the drive
+bool ProbeDriveAccess(const std::string& driveName) {
 	bool state = false;
+	try {
+#if DRIVE_ACCESS_PROBE_NO_TEST_FILE
+		// Open the drive root with the right to add files, same answer as writing a test file
+		// (fails for read-only and write protected drives) but nothing is written to the drive
+		auto root = std::string(driveName);
+		root.append("\\");
 
-	auto keyIter = accessState.find(driveName);
-	if (keyIter != accessState.end()) {
-		state = keyIter->second;
-	}
-	else {
-		try {
-			auto dwDesiredAccess = GENERIC_READ | GENERIC_WRITE;
-			auto dwShareMode = FILE_SHARE_READ | FILE_SHARE_WRITE;
-			auto dwCreationDisposition = CREATE_ALWAYS;
+		CREATEFILE2_EXTENDED_PARAMETERS params = { 0 };
+		params.dwSize = sizeof(CREATEFILE2_EXTENDED_PARAMETERS);
+		params.dwFileFlags = FILE_FLAG_BACKUP_SEMANTICS; // Required to open folders
 
-			auto testFile = std::string(driveName);
-			testFile.append("\\.UWPAccessCheck");
+		auto dwShareMode = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
 #if defined(_M_ARM)
-			HANDLE h = CreateFile2(convertToLPCWSTR(testFile), dwDesiredAccess, dwShareMode, dwCreationDisposition, nullptr);
+		HANDLE h = CreateFile2(convertToLPCWSTR(root), FILE_ADD_FILE, dwShareMode, OPEN_EXISTING, &params);
 #else
-			HANDLE h = CreateFile2FromAppW(convertToLPCWSTR(testFile), dwDesiredAccess, dwShareMode, dwCreationDisposition, nullptr);
+		HANDLE h = CreateFile2FromAppW(convertToLPCWSTR(root), FILE_ADD_FILE, dwShareMode, OPEN_EXISTING, &params);
 #endif
-			if (h != INVALID_HANDLE_VALUE) {
-				state = true;
-				CloseHandle(h);
+		if (h != INVALID_HANDLE_VALUE) {
+			state = true;
+			CloseHandle(h);
+		}
+#else
+		auto dwDesiredAccess = GENERIC_READ | GENERIC_WRITE;
+		auto dwShareMode = FILE_SHARE_READ | FILE_SHARE_WRITE;
+		auto dwCreationDisposition = CREATE_ALWAYS;
+
+		auto testFile = std::string(driveName);
+		testFile.append("\\.UWPAccessCheck");
 #if defined(_M_ARM)
-				DeleteFileW(convertToLPCWSTR(testFile));
+		HANDLE h = CreateFile2(convertToLPCWSTR(testFile), dwDesiredAccess, dwShareMode, dwCreationDisposition, nullptr);
 #else
-				DeleteFileFromAppW(convertToLPCWSTR(testFile));
+		HANDLE h = CreateFile2FromAppW(convertToLPCWSTR(testFile), dwDesiredAccess, dwShareMode, dwCreationDisposition, nullptr);
+#endif
+		if (h != INVALID_HANDLE_VALUE) {
+			state = true;
+			CloseHandle(h);
+#if defined(_M_ARM)
+			DeleteFileW(convertToLPCWSTR(testFile));
+#else
+			DeleteFileFromAppW(convertToLPCWSTR(testFile));
 #endif
-			}
-			accessState.insert(std::make_pair(driveName, state));
-		}
-		catch (...) {
 		}
+#endif
+	}
+	catch (...) {
+	}
+	return state;
+}
+
+bool CheckDriveAccess(std::string driveName, bool checkIfContainsFutureAccessItems) {
+	bool state = false;
+
+	// Same drive can be written as 'C:', 'c:' or 'C:\'
+	std::string key = driveName;
+	while (!key.empty() && (key.back() == '\\' || key.back() == '/')) {
+		key.pop_back();
+	}
+	FoldCacheKey(key);
+
+	if (!DriveAccessStates.Get(key, state)) {
+		state = ProbeDriveAccess(key);
+		DriveAccessStates.Put(key, state);
 	}
 
 	if (!state && checkIfContainsFutureAccessItems) {
@@ -390,15 +991,38 @@ bool CheckDriveAccess(std::wstring driveName, bool checkIfContainsFutureAccessIt
 	return CheckDriveAccess(convert(driveName), checkIfContainsFutureAccessItems);
 }
 
-bool IsValidUWP(std::string path, bool allowForAppData) {
+// Fill the drive access cache in background,
+// only fixed drives are probed (network and removable drives can take long to answer,
+// they are probed on first use), probes run on the background lane so only a few run at once
+std::once_flag driveSweepOnce;
+void StartDriveAccessSweep() {
+	std::call_once(driveSweepOnce, []() {
+		DWORD drives = GetLogicalDrives();
+		for (int i = 0; i < 26; i++) {
+			if ((drives & (1 << i)) == 0) {
+				continue;
+			}
+			std::string driveName = std::string(1, (char)('a' + i)) + ":";
+			if (GetDriveTypeW(convertToLPCWSTR(driveName + "\\")) != DRIVE_FIXED) {
+				continue;
+			}
+			GetStorageExecutor().Post(STORAGE_LANE_BACKGROUND, [driveName]() {
+				bool state = false;
+				if (!DriveAccessStates.Get(driveName, state)) {
+					DriveAccessStates.Put(driveName, ProbeDriveAccess(driveName));
+				}
+			});
+		}
+	});
+}
+
+bool IsValidResolved(const PathUWP& p, bool allowForAppData) {
 	// The idea of this functions is to determine whether we need to use native UWP fallback,
 	// this usually help to avoid unnecessary checks if file is not exists within accessible path,
 	// usually API will fail and storage manager will try to use native fallback solution,
 	// in this case as example we shouldn't fallback to check using UWP, it should end at API level,
 	// so the result will be reversed at the end, 
 	// means file/folder is not accessible by default and something prevent the API to work.
-	auto p = PathResolver(path);
-
 	//Check valid path
 	if (p.Type() == PathTypeUWP::UNDEFINED || !p.IsAbsolute()) {
 		// Nothing to do here
@@ -409,47 +1033,75 @@ bool IsValidUWP(std::string path, bool allowForAppData) {
 
 	bool state = false;
 	if (!allowForAppData) {
-		auto resolvedPathStr = p.ToString();
-		if (ends_with(resolvedPathStr, "LocalState") || ends_with(resolvedPathStr, "TempState") || ends_with(resolvedPathStr, "LocalCache")) {
+		// App folders (one pass over the known roots)
+		if (GetKnownLocations().registry.Classify(p.ToString()) != LocationTypeUWP::UNKNOWN) {
 			state = true;
 		}
-		else
-			if (isChild(GetLocalFolder(), resolvedPathStr)) {
-				state = true;
-			}
-			else if (isChild(GetInstallationFolder(), resolvedPathStr)) {
-				state = true;
-			}
-			else if (isChild(GetTempFolder(), resolvedPathStr)) {
-				state = true;
-			}
 
 		if (!state)
 		{
-			auto p = PathUWP(path);
 			std::string driveName = p.GetRootVolume().ToString();
 			state = CheckDriveAccess(driveName, false);
 		}
 	}
 	return !state;
 }
+bool IsValidUWP(std::string path, bool allowForAppData) {
+	return IsValidResolved(PathResolver(path), allowForAppData);
+}
 bool IsValidUWP(std::wstring path, bool allowForAppData) {
 	return IsValidUWP(convert(path), allowForAppData);
 }
 
-bool IsExistsAPI(std::string path) {
+LocationTypeUWP GetLocationTypeUWP(std::string path) {
 	auto p = PathResolver(path);
+	auto type = GetKnownLocations().registry.Classify(p.ToString());
+	if (type != LocationTypeUWP::UNKNOWN) {
+		return type;
+	}
+
+	// Picked items (or warm entries until they are restored)
+	FillLookupList();
+	std::vector<const StorageItemW*> items;
+	GetLookupSnapshot()->GetAncestors(p.ToString(), items, true);
+	if (!items.empty()) {
+		return LocationTypeUWP::PICKED;
+	}
+	if (!IsLookupListReady()) {
+		std::vector<const LookupSnapshotEntryUWP*> entries;
+		GetWarmLookupIndex()->GetAncestors(p.ToString(), entries, true);
+		if (!entries.empty()) {
+			return LocationTypeUWP::PICKED;
+		}
+	}
+
+	if (CheckDriveAccess(p.GetRootVolume().ToString(), false)) {
+		return LocationTypeUWP::DRIVE_ACCESSIBLE;
+	}
+	return LocationTypeUWP::UNKNOWN;
+}
+LocationTypeUWP GetLocationTypeUWP(std::wstring path) {
+	return GetLocationTypeUWP(convert(path));
+}
+
+bool IsExistsAPI(const PathStringUWP& dualPath) {
+	if (IsCallStopped()) {
+		return false;
+	}
+	std::wstring resolved;
+	const std::wstring& widePath = ResolveWidePath(dualPath, resolved);
 	WIN32_FILE_ATTRIBUTE_DATA data{};
 #ifdef TARGET_IS_16299_OR_LOWER
-	if (GetFileAttributesExW(p.ToWString().c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
+	if (GetFileAttributesExW(widePath.c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
 		return true;
 	}
 #else
 	// If the item was in access future list, this will work fine
-	if (GetFileAttributesExFromAppW(p.ToWString().c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
+	if (GetFileAttributesExFromAppW(widePath.c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
 		return true;
 	}
 #endif
+	const std::string& path = dualPath.UTF8();
 	if (!IsValidUWP(path)) {
 		// If folder is not accessible but is part of accessible items
 		// consider it exists
@@ -460,11 +1112,24 @@ bool IsExistsAPI(std::string path) {
 	}
 	return false;
 }
-bool IsExistsUWP(std::string path) {
-	bool defaultState = IsExistsAPI(path);
-	if (!defaultState && IsValidUWP(path)) {
+bool IsExistsUWP(const PathStringUWP& dualPath) {
+	auto resolved = ResolveDualPath(dualPath);
+	if (IsKnownMissing(resolved)) {
+		return false;
+	}
+
+	std::string tierRoot;
+	bool tryAPI = ShouldTryAPI(resolved, tierRoot);
+	bool defaultState = false;
+	if (tryAPI) {
+		defaultState = IsExistsAPI(dualPath);
+		ReportAPIResult(tierRoot, defaultState);
+	}
+	if (!defaultState && IsValidResolved(resolved)) {
+		const std::string& path = dualPath.UTF8();
 		auto storageItem = GetStorageItem(path);
 		if (storageItem.IsValid()) {
+			ReportFallbackResult(tierRoot, tryAPI, true);
 			return true;
 		}
 
@@ -480,30 +1145,45 @@ bool IsExistsUWP(std::string path) {
 		if (IsRootForAccessibleItems(path, tmp, true)) {
 			return true;
 		}
+
+		// Only UWP fallback misses are cached,
+		// app folders are usually changed outside storage manager
+		MarkAsMissing(resolved);
+		ReportFallbackResult(tierRoot, tryAPI, false, true);
+	}
+	else if (defaultState) {
+		return true;
 	}
 	// UWP_ERROR_LOG(UWPSMT, "Couldn't find or access (%s)", path.c_str());
 	return false;
 }
-
+bool IsExistsUWP(std::string path) {
+	return IsExistsUWP(PathStringUWP(std::move(path)));
+}
 bool IsExistsUWP(std::wstring path) {
-	return IsExistsUWP(convert(path));
+	return IsExistsUWP(PathStringUWP(std::move(path)));
 }
 
-bool IsDirectoryAPI(std::string path) {
-	auto p = PathResolver(path);
+bool IsDirectoryAPI(const PathStringUWP& dualPath) {
+	if (IsCallStopped()) {
+		return false;
+	}
+	std::wstring resolved;
+	const std::wstring& widePath = ResolveWidePath(dualPath, resolved);
 	WIN32_FILE_ATTRIBUTE_DATA data{};
 #ifdef TARGET_IS_16299_OR_LOWER
-	if (GetFileAttributesExW(p.ToWString().c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
+	if (GetFileAttributesExW(widePath.c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
 		DWORD result = data.dwFileAttributes;
 		return (result & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY;
 	}
 #else
 	// If the item was in access future list, this will work fine
-	if (GetFileAttributesExFromAppW(p.ToWString().c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
+	if (GetFileAttributesExFromAppW(widePath.c_str(), GetFileExInfoStandard, &data) || data.dwFileAttributes == INVALID_FILE_ATTRIBUTES) {
 		DWORD result = data.dwFileAttributes;
 		return (result & FILE_ATTRIBUTE_DIRECTORY) == FILE_ATTRIBUTE_DIRECTORY;
 	}
 #endif
+	const std::string& path = dualPath.UTF8();
 	if (!IsValidUWP(path)) {
 		// If folder is not accessible but is part of accessible items
 		// consider it folder
@@ -514,34 +1194,72 @@ bool IsDirectoryAPI(std::string path) {
 	}
 	return false;
 }
-bool IsDirectoryUWP(std::string path) {
-	bool defaultState = IsDirectoryAPI(path);
-	if (!defaultState && IsValidUWP(path)) {
+bool IsDirectoryUWP(const PathStringUWP& dualPath) {
+	auto resolved = ResolveDualPath(dualPath);
+	if (IsKnownMissing(resolved)) {
+		return false;
+	}
+
+	std::string tierRoot;
+	bool tryAPI = ShouldTryAPI(resolved, tierRoot);
+	bool defaultState = false;
+	if (tryAPI) {
+		defaultState = IsDirectoryAPI(dualPath);
+		ReportAPIResult(tierRoot, defaultState);
+	}
+	if (!defaultState && IsValidResolved(resolved)) {
+		const std::string& path = dualPath.UTF8();
 		auto storageItem = GetStorageItem(path);
+		ReportFallbackResult(tierRoot, tryAPI, storageItem.IsValid(), !storageItem.IsValid());
 		if (storageItem.IsValid()) {
 			if (storageItem.IsDirectory()) {
 				return true;
 			}
 		}
 	}
-	return false;
+	return defaultState;
 }
 
+bool IsDirectoryUWP(std::string path) {
+	return IsDirectoryUWP(PathStringUWP(std::move(path)));
+}
 bool IsDirectoryUWP(std::wstring path) {
-	return IsDirectoryUWP(convert(path));
+	return IsDirectoryUWP(PathStringUWP(std::move(path)));
 }
 
 FILE* GetFileStreamAPI(std::string path, const char* mode) {
+	if (IsCallStopped()) {
+		return nullptr;
+	}
 	// Try it with fopen may work within the accessible places (installation folder, app data folder, maybe HDD/SSD with cap. added)
-	FILE* file = fopen(path.c_str(), mode);
+	FILE* file = fopen(ResolvePathUWP(path).c_str(), mode);
 	return file;
 }
 FILE* GetFileStream(std::string path, const char* mode) {
-	FILE* file = GetFileStreamAPI(path, mode);
+	bool readMode = IsReadMode(mode);
+	if (!readMode) {
+		InvalidateMissing(path);
+	}
+	else if (IsKnownMissing(path)) {
+		return nullptr;
+	}
+
+	std::string tierRoot;
+	bool tryAPI = ShouldTryAPI(path, tierRoot);
+	FILE* file = nullptr;
+	if (tryAPI) {
+		file = GetFileStreamAPI(path, mode);
+		ReportAPIResult(tierRoot, file != nullptr);
+	}
 	if (!file && IsValidUWP(path)) {
 		auto storageItem = GetStorageItem(path);
+		bool missing = false;
 		if (storageItem.IsValid()) {
 			file = storageItem.GetStream(mode);
+			if (!file) {
+				// Item could be changed outside storage manager
+				ForgetResolvedItem(path);
+			}
 		}
 		else {
 			// Forward the request to parent folder
@@ -558,7 +1276,15 @@ FILE* GetFileStream(std::string path, const char* mode) {
 					UWP_ERROR_LOG(UWPSMT, "Couldn't find or access (%s)", path.c_str());
 				}
 			}
+			if (!file && readMode) {
+				MarkAsMissing(path);
+				missing = true;
+			}
 		}
+		ReportFallbackResult(tierRoot, tryAPI, file != nullptr, missing);
+	}
+	if (!readMode && file) {
+		IndexItemAdded(path);
 	}
 
 	return file;
@@ -569,6 +1295,9 @@ FILE* GetFileStream(std::wstring path, const char* mode) {
 }
 
 FILE* GetFileStreamFromApp(std::string path, const char* mode) {
+	if (!IsReadMode(mode)) {
+		InvalidateMissing(path);
+	}
 
 	FILE* file = GetFileStreamAPI(path, mode);
 	if (!file) {
@@ -660,6 +1389,9 @@ ItemInfoUWP GetFileInfoAPI(const std::wstring& path) {
 }
 std::list<ItemInfoUWP> GetFolderContentsAPI(const std::wstring& path, bool deepScan) {
 	std::list<ItemInfoUWP> contents;
+	if (IsCallStopped()) {
+		return contents;
+	}
 	WIN32_FIND_DATA fileData;
 #ifdef TARGET_IS_16299_OR_LOWER
 	HANDLE hFind = FindFirstFileW((path + L"\\*").c_str(), &fileData);
@@ -681,6 +1413,9 @@ std::list<ItemInfoUWP> GetFolderContentsAPI(const std::wstring& path, bool deepS
 
 		// Skip "." and ".."
 		if (fileOrDirName == L"." || fileOrDirName == L"..") continue;
+		// Deep scans can take long, stop with partial contents
+		if (IsCallStopped()) break;
+		YieldToInteractive();
 
 		std::wstring fullPath = path + L"\\" + fileOrDirName;
 		ItemInfoUWP info = GetFileInfoAPI(fullPath);
@@ -696,11 +1431,16 @@ std::list<ItemInfoUWP> GetFolderContentsAPI(const std::wstring& path, bool deepS
 	FindClose(hFind);
 	return contents;
 }
-std::list<ItemInfoUWP> GetFolderContents(std::string path, bool deepScan) {
-	Platform::String^ pathWide = convert(path);
-	std::list<ItemInfoUWP> contents = GetFolderContentsAPI(pathWide->Data(), deepScan);
+std::list<ItemInfoUWP> GetFolderContents(const PathStringUWP& dualPath, bool deepScan) {
+	std::wstring resolved;
+	std::list<ItemInfoUWP> contents = GetFolderContentsAPI(ResolveWidePath(dualPath, resolved), deepScan);
+	if (!contents.empty()) {
+		return contents;
+	}
 
-	if (contents.size() == 0 && IsValidUWP(path)) {
+	// Fallback and accessible items work with UTF-8 paths
+	const std::string& path = dualPath.UTF8();
+	if (IsValidUWP(path)) {
 		auto storageItem = GetStorageItem(path);
 		if (storageItem.IsValid()) {
 
@@ -708,6 +1448,7 @@ std::list<ItemInfoUWP> GetFolderContents(std::string path, bool deepScan) {
 			// deepScan is slow, try to avoid it
 			auto rfiles = deepScan ? storageItem.GetAllFiles() : storageItem.GetFiles();
 			for each (auto file in rfiles) {
+				YieldToInteractive();
 				contents.push_back(file.GetFileInfo());
 			}
 
@@ -715,6 +1456,7 @@ std::list<ItemInfoUWP> GetFolderContents(std::string path, bool deepScan) {
 			// deepScan is slow, try to avoid it
 			auto rfolders = deepScan ? storageItem.GetAllFolders() : storageItem.GetFolders();
 			for each (auto folder in rfolders) {
+				YieldToInteractive();
 				contents.push_back(folder.GetFolderInfo());
 			}
 		}
@@ -761,8 +1503,11 @@ std::list<ItemInfoUWP> GetFolderContents(std::string path, bool deepScan) {
 	}
 	return contents;
 }
+std::list<ItemInfoUWP> GetFolderContents(std::string path, bool deepScan) {
+	return GetFolderContents(PathStringUWP(std::move(path)), deepScan);
+}
 std::list<ItemInfoUWP> GetFolderContents(std::wstring path, bool deepScan) {
-	return GetFolderContents(convert(path), deepScan);
+	return GetFolderContents(PathStringUWP(std::move(path)), deepScan);
 }
 
 ItemInfoUWP GetItemInfoUWP(std::string path) {
@@ -807,18 +1552,24 @@ int64_t GetSizeUWP(std::wstring path) {
 	return GetSizeUWP(convert(path));
 }
 
-BOOL DeleteFileAPI(std::string path) {
-	auto convertedPath = convertToLPCWSTR(path);
+BOOL DeleteFileAPI(const PathStringUWP& path) {
+	if (IsCallStopped()) {
+		return FALSE;
+	}
+	std::wstring resolved;
+	const std::wstring& widePath = ResolveWidePath(path, resolved);
 #ifdef TARGET_IS_16299_OR_LOWER
-	return DeleteFileW(convertedPath) != 0;
+	return DeleteFileW(widePath.c_str()) != 0;
 #else
 	// If the item was in access future list, this will work fine
-	return DeleteFileFromAppW(convertedPath) != 0;
+	return DeleteFileFromAppW(widePath.c_str()) != 0;
 #endif
 }
-bool DeleteUWP(std::string path) {
-	bool state = DeleteFileAPI(path);
-	if (!state && IsValidUWP(path)) {
+bool DeleteUWP(const PathStringUWP& dualPath) {
+	auto resolved = ResolveDualPath(dualPath);
+	bool state = DeleteFileAPI(dualPath);
+	if (!state && IsValidResolved(resolved)) {
+		const std::string& path = dualPath.UTF8();
 		auto storageItem = GetStorageItem(path);
 		if (storageItem.IsValid()) {
 			UWP_DEBUG_LOG(UWPSMT, "Delete (%s)", path.c_str());
@@ -829,15 +1580,27 @@ bool DeleteUWP(std::string path) {
 		}
 	}
 
+	// Fallback may cache the item, forget it after the call
+	ForgetResolvedItem(resolved);
+	if (state) {
+		IndexItemRemoved(resolved);
+	}
 	return state;
 }
 
+bool DeleteUWP(std::string path) {
+	return DeleteUWP(PathStringUWP(std::move(path)));
+}
 bool DeleteUWP(std::wstring path) {
-	return DeleteUWP(convert(path));
+	return DeleteUWP(PathStringUWP(std::move(path)));
 }
 
-BOOL CreateDirectoryAPI(std::string path, bool replaceExisting) {
-	auto convertedPath = convertToLPCWSTR(path);
+BOOL CreateDirectoryAPI(const PathStringUWP& dualPath, bool replaceExisting) {
+	if (IsCallStopped()) {
+		return FALSE;
+	}
+	std::wstring resolved;
+	auto convertedPath = ResolveWidePath(dualPath, resolved).c_str();
 #ifdef TARGET_IS_16299_OR_LOWER
 	auto state = CreateDirectoryW(convertedPath, NULL);
 #else
@@ -846,8 +1609,8 @@ BOOL CreateDirectoryAPI(std::string path, bool replaceExisting) {
 #endif
 	if (state == 0 && replaceExisting && GetLastError() == ERROR_ALREADY_EXISTS) {
 		// Force replace
-		UWP_WARN_LOG(UWPSMT, "Folder already exists, replace folder requested, %s", path.c_str());
-		if (DeleteUWP(path)) {
+		UWP_WARN_LOG(UWPSMT, "Folder already exists, replace folder requested, %s", dualPath.UTF8().c_str());
+		if (DeleteUWP(dualPath)) {
 #ifdef TARGET_IS_16299_OR_LOWER
 			auto state = CreateDirectoryW(convertedPath, NULL);
 #else
@@ -856,14 +1619,18 @@ BOOL CreateDirectoryAPI(std::string path, bool replaceExisting) {
 		}
 		else {
 			auto lastError = GetLastErrorAsString();
-			UWP_ERROR_LOG(UWPSMT, "Cannot replace folder, %s: (%s)", lastError.c_str(), path.c_str());
+			UWP_ERROR_LOG(UWPSMT, "Cannot replace folder, %s: (%s)", lastError.c_str(), dualPath.UTF8().c_str());
 		}
 	}
 	return state != 0;
 }
-bool CreateDirectoryUWP(std::string path, bool replaceExisting) {
-	bool state = CreateDirectoryAPI(path, replaceExisting);
-	if (!state && IsValidUWP(path)) {
+bool CreateDirectoryUWP(const PathStringUWP& dualPath, bool replaceExisting) {
+	auto resolved = ResolveDualPath(dualPath);
+	InvalidateMissing(resolved);
+
+	bool state = CreateDirectoryAPI(dualPath, replaceExisting);
+	if (!state && IsValidResolved(resolved)) {
+		const std::string& path = dualPath.UTF8();
 		auto p = PathUWP(path);
 		auto itemName = p.GetFilename();
 		auto rootPath = p.GetDirectory();
@@ -879,17 +1646,27 @@ bool CreateDirectoryUWP(std::string path, bool replaceExisting) {
 			}
 		}
 	}
+	if (state) {
+		IndexItemAdded(resolved);
+	}
 	return state;
 }
 
+bool CreateDirectoryUWP(std::string path, bool replaceExisting) {
+	return CreateDirectoryUWP(PathStringUWP(std::move(path)), replaceExisting);
+}
 bool CreateDirectoryUWP(std::wstring path, bool replaceExisting) {
-	return CreateDirectoryUWP(convert(path), replaceExisting);
+	return CreateDirectoryUWP(PathStringUWP(std::move(path)), replaceExisting);
 }
 
 // TODO: Add overwrite option
-BOOL CopyAPI(std::string path, std::string dest) {
-	auto convertedPath = convertToLPCWSTR(path);
-	auto convertedDestPath = convertToLPCWSTR(dest);
+BOOL CopyAPI(const PathStringUWP& path, const PathStringUWP& dest) {
+	if (IsCallStopped()) {
+		return FALSE;
+	}
+	std::wstring resolved, resolvedDest;
+	auto convertedPath = ResolveWidePath(path, resolved).c_str();
+	auto convertedDestPath = ResolveWidePath(dest, resolvedDest).c_str();
 #ifdef TARGET_IS_16299_OR_LOWER
 	return CopyFileW(convertedPath, convertedDestPath, TRUE) != 0;
 #else
@@ -897,10 +1674,16 @@ BOOL CopyAPI(std::string path, std::string dest) {
 	return CopyFileFromAppW(convertedPath, convertedDestPath, TRUE) != 0;
 #endif
 }
-bool CopyUWP(std::string path, std::string dest) {
-	bool state = CopyAPI(path, dest);
+bool CopyUWP(const PathStringUWP& dualPath, const PathStringUWP& dualDest) {
+	auto resolved = ResolveDualPath(dualPath);
+	auto resolvedDest = ResolveDualPath(dualDest);
+	InvalidateMissing(resolvedDest);
 
-	if (!state && IsValidUWP(path, true) && IsValidUWP(dest, true)) {
+	bool state = CopyAPI(dualPath, dualDest);
+
+	if (!state && IsValidResolved(resolved, true) && IsValidResolved(resolvedDest, true)) {
+		const std::string& path = dualPath.UTF8();
+		const std::string& dest = dualDest.UTF8();
 		auto srcStorageItem = GetStorageItem(path);
 		if (srcStorageItem.IsValid()) {
 			auto destDir = dest;
@@ -923,17 +1706,29 @@ bool CopyUWP(std::string path, std::string dest) {
 		}
 	}
 
+	// Destination may be replaced
+	ForgetResolvedItem(resolvedDest);
+	if (state) {
+		IndexItemAdded(resolvedDest);
+	}
 	return state;
 }
 
+bool CopyUWP(std::string path, std::string dest) {
+	return CopyUWP(PathStringUWP(std::move(path)), PathStringUWP(std::move(dest)));
+}
 bool CopyUWP(std::wstring path, std::wstring dest) {
-	return CopyUWP(convert(path), convert(dest));
+	return CopyUWP(PathStringUWP(std::move(path)), PathStringUWP(std::move(dest)));
 }
 
 // TODO: Add overwrite option
-BOOL MoveAPI(std::string path, std::string dest) {
-	auto convertedPath = convertToLPCWSTR(path);
-	auto convertedDestPath = convertToLPCWSTR(dest);
+BOOL MoveAPI(const PathStringUWP& path, const PathStringUWP& dest) {
+	if (IsCallStopped()) {
+		return FALSE;
+	}
+	std::wstring resolved, resolvedDest;
+	auto convertedPath = ResolveWidePath(path, resolved).c_str();
+	auto convertedDestPath = ResolveWidePath(dest, resolvedDest).c_str();
 #ifdef TARGET_IS_16299_OR_LOWER
 	return MoveFileExW(convertedPath, convertedDestPath, NULL) != 0;
 #else
@@ -941,10 +1736,16 @@ BOOL MoveAPI(std::string path, std::string dest) {
 	return MoveFileFromAppW(convertedPath, convertedDestPath) != 0;
 #endif
 }
-bool MoveUWP(std::string path, std::string dest) {
-	bool state = MoveAPI(path, dest);
+bool MoveUWP(const PathStringUWP& dualPath, const PathStringUWP& dualDest) {
+	auto resolved = ResolveDualPath(dualPath);
+	auto resolvedDest = ResolveDualPath(dualDest);
+	InvalidateMissing(resolvedDest);
 
-	if (!state && IsValidUWP(path, true) && IsValidUWP(dest, true)) {
+	bool state = MoveAPI(dualPath, dualDest);
+
+	if (!state && IsValidResolved(resolved, true) && IsValidResolved(resolvedDest, true)) {
+		const std::string& path = dualPath.UTF8();
+		const std::string& dest = dualDest.UTF8();
 		auto srcStorageItem = GetStorageItem(path);
 
 		if (srcStorageItem.IsValid()) {
@@ -968,17 +1769,32 @@ bool MoveUWP(std::string path, std::string dest) {
 		}
 	}
 
+	ForgetResolvedItem(resolved);
+	ForgetResolvedItem(resolvedDest);
+	if (state) {
+		IndexItemRemoved(resolved);
+		IndexItemAdded(resolvedDest);
+	}
 	return state;
 }
 
+bool MoveUWP(std::string path, std::string dest) {
+	return MoveUWP(PathStringUWP(std::move(path)), PathStringUWP(std::move(dest)));
+}
 bool MoveUWP(std::wstring path, std::wstring dest) {
-	return MoveUWP(convert(path), convert(dest));
+	return MoveUWP(PathStringUWP(std::move(path)), PathStringUWP(std::move(dest)));
 }
 
-bool RenameUWP(std::string oldname, std::string newname) {
+bool RenameUWP(const PathStringUWP& dualOldName, const PathStringUWP& dualNewName) {
+	auto resolvedOld = ResolveDualPath(dualOldName);
+	auto resolvedNew = ResolveDualPath(dualNewName);
+	InvalidateMissing(resolvedNew);
+
 	// Not sure about testing using Move API here?
-	bool state = MoveAPI(oldname, newname);
+	bool state = MoveAPI(dualOldName, dualNewName);
 
+	const std::string& oldname = dualOldName.UTF8();
+	const std::string& newname = dualNewName.UTF8();
 	auto srcRoot = PathUWP(oldname).GetDirectory();
 	auto dstRoot = PathUWP(newname).GetDirectory();
 	// Check if system using rename to move
@@ -994,14 +1810,24 @@ bool RenameUWP(std::string oldname, std::string newname) {
 	}
 	else {
 		UWP_DEBUG_LOG(UWPSMT, " Rename used as move -> call move (%s) to (%s)", oldname.c_str(), newname.c_str());
-		state = MoveUWP(oldname, newname);
+		state = MoveUWP(dualOldName, dualNewName);
 	}
 
+
+	ForgetResolvedItem(resolvedOld);
+	ForgetResolvedItem(resolvedNew);
+	if (state) {
+		IndexItemRemoved(resolvedOld);
+		IndexItemAdded(resolvedNew);
+	}
 	return state;
 }
 
+bool RenameUWP(std::string oldname, std::string newname) {
+	return RenameUWP(PathStringUWP(std::move(oldname)), PathStringUWP(std::move(newname)));
+}
 bool RenameUWP(std::wstring oldname, std::wstring newname) {
-	return RenameUWP(convert(oldname), convert(newname));
+	return RenameUWP(PathStringUWP(std::move(oldname)), PathStringUWP(std::move(newname)));
 }
 #pragma endregion
 
@@ -1126,6 +1952,8 @@ bool writeFile(const std::string& originalPath, StorageFile^ file, const std::st
 }
 
 bool PutFileContents(std::string path, std::string content, const char* mode, bool backup) {
+	InvalidateMissing(path);
+
 	bool state = false;
 	// Open the file using fopen
 	FILE* file = GetFileStream(path, mode);
@@ -1143,6 +1971,102 @@ bool PutFileContents(std::wstring path, std::wstring content, const char* mode,
 }
 #pragma endregion
 
+#pragma region Async
+// Each call is a copy of its sync version running on the storage executor
+// stat/open go to the interactive lane, loads and changes to the normal lane, deep scans and copies to the background lane
+// sync versions block on broker calls only when they are not on STA thread
+// limits of the calling thread ('StorageLimitScopeUWP') apply to the task (see 'PostWithLimitsUWP')
+template<typename T>
+concurrency::task<T> RunOnLane(StorageLaneUWP lane, std::function<T()> work) {
+	concurrency::task_completion_event<T> completion;
+	PostWithLimitsUWP<T>(GetStorageExecutor(), lane, std::move(work), completion);
+	return concurrency::create_task(completion);
+}
+
+concurrency::task<void> PostStorageWorkUWP(StorageLaneUWP lane, std::function<void()> work) {
+	return RunOnLane<void>(lane, std::move(work));
+}
+
+LaneStatsUWP GetStorageLaneStats(StorageLaneUWP lane) {
+	return GetStorageExecutor().Stats(lane);
+}
+
+size_t GetStorageQueueDepth() {
+	return GetStorageExecutor().QueueDepth();
+}
+
+concurrency::task<HANDLE> CreateFileAsyncUWP(PathStringUWP path, long accessMode, long shareMode, long openMode) {
+	return RunOnLane<HANDLE>(STORAGE_LANE_INTERACTIVE, [path = std::move(path), accessMode, shareMode, openMode]() {
+		return CreateFileUWP(path, accessMode, shareMode, openMode);
+	});
+}
+concurrency::task<bool> IsExistsAsyncUWP(PathStringUWP path) {
+	return RunOnLane<bool>(STORAGE_LANE_INTERACTIVE, [path = std::move(path)]() {
+		return IsExistsUWP(path);
+	});
+}
+concurrency::task<bool> IsDirectoryAsyncUWP(PathStringUWP path) {
+	return RunOnLane<bool>(STORAGE_LANE_INTERACTIVE, [path = std::move(path)]() {
+		return IsDirectoryUWP(path);
+	});
+}
+concurrency::task<std::string> GetFileContentAsync(PathStringUWP path, std::string mode) {
+	return RunOnLane<std::string>(STORAGE_LANE_NORMAL, [path = std::move(path), mode = std::move(mode)]() {
+		return GetFileContent(path.UTF8(), mode.c_str());
+	});
+}
+concurrency::task<bool> PutFileContentsAsync(PathStringUWP path, std::string content, std::string mode, bool backup) {
+	return RunOnLane<bool>(backup ? STORAGE_LANE_BACKGROUND : STORAGE_LANE_NORMAL, [path = std::move(path), content = std::move(content), mode = std::move(mode), backup]() {
+		return PutFileContents(path.UTF8(), content, mode.c_str(), backup);
+	});
+}
+concurrency::task<std::list<ItemInfoUWP>> GetFolderContentsAsync(PathStringUWP path, bool deepScan) {
+	return RunOnLane<std::list<ItemInfoUWP>>(deepScan ? STORAGE_LANE_BACKGROUND : STORAGE_LANE_INTERACTIVE, [path = std::move(path), deepScan]() {
+		return GetFolderContents(path, deepScan);
+	});
+}
+concurrency::task<ItemInfoUWP> GetItemInfoAsync(PathStringUWP path) {
+	return RunOnLane<ItemInfoUWP>(STORAGE_LANE_INTERACTIVE, [path = std::move(path)]() {
+		return GetItemInfoUWP(path.UTF8());
+	});
+}
+concurrency::task<int64_t> GetSizeAsyncUWP(PathStringUWP path) {
+	return RunOnLane<int64_t>(STORAGE_LANE_INTERACTIVE, [path = std::move(path)]() {
+		return GetSizeUWP(path.UTF8());
+	});
+}
+concurrency::task<bool> DeleteAsyncUWP(PathStringUWP path) {
+	return RunOnLane<bool>(STORAGE_LANE_NORMAL, [path = std::move(path)]() {
+		return DeleteUWP(path);
+	});
+}
+concurrency::task<bool> CreateDirectoryAsyncUWP(PathStringUWP path, bool replaceExisting) {
+	return RunOnLane<bool>(STORAGE_LANE_NORMAL, [path = std::move(path), replaceExisting]() {
+		return CreateDirectoryUWP(path, replaceExisting);
+	});
+}
+concurrency::task<bool> RenameAsyncUWP(PathStringUWP oldname, PathStringUWP newname) {
+	return RunOnLane<bool>(STORAGE_LANE_NORMAL, [oldname = std::move(oldname), newname = std::move(newname)]() {
+		return RenameUWP(oldname, newname);
+	});
+}
+concurrency::task<bool> CopyAsyncUWP(PathStringUWP path, PathStringUWP dest) {
+	return RunOnLane<bool>(STORAGE_LANE_BACKGROUND, [path = std::move(path), dest = std::move(dest)]() {
+		return CopyUWP(path, dest);
+	});
+}
+concurrency::task<bool> MoveAsyncUWP(PathStringUWP path, PathStringUWP dest) {
+	return RunOnLane<bool>(STORAGE_LANE_NORMAL, [path = std::move(path), dest = std::move(dest)]() {
+		return MoveUWP(path, dest);
+	});
+}
+concurrency::task<void> CleanupLogsAsync() {
+	return PostStorageWorkUWP(STORAGE_LANE_BACKGROUND, []() {
+		CleanupLogs();
+	});
+}
+#pragma endregion
+
 #pragma region Helpers
 bool OpenFile(std::string path) {
 	bool state = false;
@@ -1303,6 +2227,7 @@ void CleanupLogs() {
 		std::list<StorageFileW> files = logsCache.GetFiles();
 		if (!files.empty()) {
 			for each (auto fItem in files) {
+				YieldToInteractive();
 				if (fItem.GetSize() == 0) {
 					fItem.Delete();
 				}
@@ -7,11 +7,22 @@
 #pragma once 
 
 #include <list>
+#include <ppltasks.h>
 
 #include "StoragePath.h"
 #include "StorageInfo.h"
 #include "StorageAccess.h"
 #include "StoragePickers.h"
+#include "StorageCache.h"
+#include "StorageLocations.h"
+#include "StoragePathString.h"
+#include "StorageMounts.h"
+#include "StorageLimits.h"
+#include "StorageLatency.h"
+#include "StorageExecutor.h"
+
+// Calls made on UI thread keep the window events running while they wait for the broker,
+// so UI callbacks can run inside them (see 'WaitLookupListReady' in 'StorageAccess.h')
 
 // Locations
 std::string GetWorkingFolder(); // Where main data is, default is app data
@@ -29,10 +40,26 @@ std::string GetMusicFolder(); // Requires 'musicLibrary' capability
 std::string GetPreviewPath(std::string path);
 bool isLocalState(std::string path);
 bool isLocalState(std::wstring path);
+LocationTypeUWP GetLocationTypeUWP(std::string path); // Classify path (app folders, picked items, accessible drive)
+LocationTypeUWP GetLocationTypeUWP(std::wstring path);
+
+// Mounts
+// virtual roots routed to real locations ('/roms/a.iso' -> 'D:\Games\ROMs\a.iso'), kept in LocalSettings
+// all functions below accept mounted paths, safe to call from any thread
+bool MountUWP(std::string root, std::string target); // Add or replace
+bool MountUWP(std::wstring root, std::wstring target);
+bool UnmountUWP(std::string root);
+bool UnmountUWP(std::wstring root);
+std::vector<MountPointUWP> GetMountPointsUWP();
+
+// Limits
+// any function below can be bounded with 'StorageLimitScopeUWP' (deadline, cancel token) from 'StorageLimits.h'
+// stopped calls fail as usual, the scope tells why ('TimedOut', 'Canceled')
 
 // Management
 HANDLE CreateFileUWP(std::string path, long accessMode = GENERIC_READ, long shareMode = FILE_SHARE_READ, long openMode = OPEN_EXISTING);
 HANDLE CreateFileUWP(std::wstring path, long accessMode = GENERIC_READ, long shareMode = FILE_SHARE_READ, long openMode = OPEN_EXISTING);
+HANDLE CreateFileUWP(const PathStringUWP& path, long accessMode = GENERIC_READ, long shareMode = FILE_SHARE_READ, long openMode = OPEN_EXISTING); // Keeps both encodings
 FILE* GetFileStream(std::string path, const char* mode);
 FILE* GetFileStream(std::wstring path, const char* mode);
 // `GetFileStreamFromApp` Will use Windows UWP API, use it instead of fopen..etc
@@ -44,8 +71,10 @@ bool IsValidUWP(std::string path, bool allowForAppData = false);
 bool IsValidUWP(std::wstring path, bool allowForAppData = false);
 bool IsExistsUWP(std::string path);
 bool IsExistsUWP(std::wstring path);
+bool IsExistsUWP(const PathStringUWP& path);
 bool IsDirectoryUWP(std::string path);
 bool IsDirectoryUWP(std::wstring path);
+bool IsDirectoryUWP(const PathStringUWP& path);
 
 // File Contents
 std::string GetFileContent(std::string path, const char* mode);
@@ -56,6 +85,7 @@ bool PutFileContents(std::wstring path, std::wstring content, const char* mode =
 // Folder Contents
 std::list<ItemInfoUWP> GetFolderContents(std::string path, bool deepScan = false);
 std::list<ItemInfoUWP> GetFolderContents(std::wstring path, bool deepScan = false);
+std::list<ItemInfoUWP> GetFolderContents(const PathStringUWP& path, bool deepScan = false);
 ItemInfoUWP GetItemInfoUWP(std::string path);
 ItemInfoUWP GetItemInfoUWP(std::wstring path);
 
@@ -64,17 +94,45 @@ int64_t GetSizeUWP(std::string path);
 int64_t GetSizeUWP(std::wstring path);
 bool DeleteUWP(std::string path);
 bool DeleteUWP(std::wstring path);
+bool DeleteUWP(const PathStringUWP& path);
 bool CreateDirectoryUWP(std::string path, bool replaceExisting = true);
 bool CreateDirectoryUWP(std::wstring path, bool replaceExisting = true);
+bool CreateDirectoryUWP(const PathStringUWP& path, bool replaceExisting = true);
 // Both (old, new) full path
 bool RenameUWP(std::string oldname, std::string newname);
 bool RenameUWP(std::wstring oldname, std::wstring newname);
+bool RenameUWP(const PathStringUWP& oldname, const PathStringUWP& newname);
 // Add file name to destination path
 bool CopyUWP(std::string path, std::string dest);
 bool CopyUWP(std::wstring path, std::wstring dest);
+bool CopyUWP(const PathStringUWP& path, const PathStringUWP& dest);
 // Add file name to destination path
 bool MoveUWP(std::string path, std::string dest);
 bool MoveUWP(std::wstring path, std::wstring dest);
+bool MoveUWP(const PathStringUWP& path, const PathStringUWP& dest);
+
+// Async
+// same functions on storage manager workers (priority lanes), calling thread (UI) is never blocked
+// chain with '.then' or 'co_await' (include <pplawait.h>), many tasks will run in parallel
+concurrency::task<HANDLE> CreateFileAsyncUWP(PathStringUWP path, long accessMode = GENERIC_READ, long shareMode = FILE_SHARE_READ, long openMode = OPEN_EXISTING);
+concurrency::task<bool> IsExistsAsyncUWP(PathStringUWP path);
+concurrency::task<bool> IsDirectoryAsyncUWP(PathStringUWP path);
+concurrency::task<std::string> GetFileContentAsync(PathStringUWP path, std::string mode = "r");
+concurrency::task<bool> PutFileContentsAsync(PathStringUWP path, std::string content, std::string mode = "w+", bool backup = false);
+concurrency::task<std::list<ItemInfoUWP>> GetFolderContentsAsync(PathStringUWP path, bool deepScan = false);
+concurrency::task<ItemInfoUWP> GetItemInfoAsync(PathStringUWP path);
+concurrency::task<int64_t> GetSizeAsyncUWP(PathStringUWP path);
+concurrency::task<bool> DeleteAsyncUWP(PathStringUWP path);
+concurrency::task<bool> CreateDirectoryAsyncUWP(PathStringUWP path, bool replaceExisting = true);
+concurrency::task<bool> RenameAsyncUWP(PathStringUWP oldname, PathStringUWP newname);
+concurrency::task<bool> CopyAsyncUWP(PathStringUWP path, PathStringUWP dest);
+concurrency::task<bool> MoveAsyncUWP(PathStringUWP path, PathStringUWP dest);
+concurrency::task<void> CleanupLogsAsync(); // Background lane
+// Own work on the executor ('STORAGE_LANE_NORMAL' for game loads..etc), jobs must not wait for other executor jobs
+// long background jobs should call storage functions in steps, they pause between them for interactive requests
+concurrency::task<void> PostStorageWorkUWP(StorageLaneUWP lane, std::function<void()> work);
+LaneStatsUWP GetStorageLaneStats(StorageLaneUWP lane); // Queue depth, wait/total latency per lane
+size_t GetStorageQueueDepth(); // Waiting jobs of all lanes
 
 // Helpers
 bool OpenFile(std::string path);
@@ -92,8 +150,17 @@ bool IsRootForAccessibleItems(std::wstring path);
 // 'checkIfContainsFutureAccessItems' for listing purposes not real access, 'driveName' like C:
 bool CheckDriveAccess(std::string driveName, bool checkIfContainsFutureAccessItems);
 bool CheckDriveAccess(std::wstring driveName, bool checkIfContainsFutureAccessItems);
+void StartDriveAccessSweep(); // Probe all drives in background (once)
 bool GetDriveFreeSpace(PathUWP path, int64_t& space);
 
+// Caches
+CacheStatsUWP GetNegativeCacheStats(); // Missing paths cache
+CacheStatsUWP GetResolvedCacheStats(); // Resolved items cache
+TierStatsUWP GetTierStrategyStats(); // Direct API attempts/skips
+CacheStatsUWP GetNameIndexStats(); // Case-insensitive name index (size is indexed folders)
+LatencyStatsUWP GetBrokerLatencyStats(); // Blocking broker waits (microseconds), with timeouts and cancels
+void ClearStorageCaches(); // Call it after changing files outside storage manager
+
 // Log helpers
 std::string GetLogFile();
 bool SaveLogs(); // With picker
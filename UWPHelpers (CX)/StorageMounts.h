@@ -0,0 +1,58 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Virtual mount table
+// logical roots ('/roms') are routed to real locations ('D:\Games\ROMs')
+// roots are matched by full components (case insensitive), deepest root wins
+// the table is a plain value, storage manager publishes it as immutable versions
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct MountPointUWP {
+	std::string root; // Virtual root ('/roms')
+	std::string target; // Real location ('D:/Games/ROMs')
+};
+
+class MountTableUWP {
+public:
+	// Add or replace mount point, both paths are normalized ('/' separators, no dot segments)
+	// false if any of them is empty, if root is '/' (app data) or target is not absolute
+	bool Mount(const std::string& root, const std::string& target);
+
+	// False if root is not mounted
+	bool Unmount(const std::string& root);
+
+	// Route path to its real location, the rest of the path is appended as is
+	// 'out' buffer is reused, false (and 'out' untouched) if no root matches
+	bool Resolve(std::string_view path, std::string& out) const;
+
+	// Real location of root (exact root only)
+	bool GetTarget(std::string_view root, std::string& target) const;
+
+	const std::vector<MountPointUWP>& GetMountPoints() const {
+		return mounts;
+	}
+
+	size_t size() const {
+		return mounts.size();
+	}
+
+	bool empty() const {
+		return mounts.empty();
+	}
+
+	// Settings form, one 'root|target' per line ('|' is not allowed in Windows paths)
+	std::string Serialize() const;
+	// Invalid lines are skipped, return the number of mounted roots
+	size_t Deserialize(std::string_view data);
+
+private:
+	std::vector<MountPointUWP> mounts; // Longest root first
+};
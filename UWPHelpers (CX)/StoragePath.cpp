@@ -8,7 +8,9 @@
 
 #include "StoragePath.h"
 #include "StorageLog.h"
-#include "StorageExtensions.h"
+#include "StorageEncoding.h"
+#include "StoragePathCompare.h"
+#include "StorageTransform.h"
 
 PathUWP::PathUWP(const std::string& str) {
 	Init(str);
@@ -16,39 +18,71 @@ PathUWP::PathUWP(const std::string& str) {
 
 PathUWP::PathUWP(const std::wstring& str) {
 	type_ = PathTypeUWP::NATIVE;
-	Init(convert(str));
+	std::string utf8;
+	WideToUTF8UWP(str, utf8);
+	Init(utf8);
 }
 
+// Device and NT prefixes, dropped from the start of the path
+static const char* const PathPrefixesUWP[] = { "\\\\?\\", "\\??\\", "??\\", "?\\" };
+
+// Single pass: drop prefix, flip slashes, collapse duplicated slashes and trim the trailing one
 void PathUWP::Init(const std::string& str) {
+	path_.clear();
 	if (str.empty()) {
 		type_ = PathTypeUWP::UNDEFINED;
-		path_.clear();
+		return;
 	}
-	else if (starts_with(str, "http://") || starts_with(str, "https://")) {
+
+	if (str.compare(0, 7, "http://") == 0 || str.compare(0, 8, "https://") == 0) {
 		type_ = PathTypeUWP::HTTP;
 		path_ = str;
+		ReplaceCharUWP(path_.data(), path_.size(), '\\', '/');
+		return;
 	}
-	else {
-		type_ = PathTypeUWP::NATIVE;
-		path_ = str;
+
+	type_ = PathTypeUWP::NATIVE;
+
+	size_t start = 0;
+	for (auto prefix : PathPrefixesUWP) {
+		size_t length = strlen(prefix);
+		if (str.compare(0, length, prefix) == 0) {
+			start = length;
+			break;
+		}
 	}
 
-	replace(path_, "??\\", "");
-	replace(path_, "\\??\\", "");
-	replace(path_, "\\\\?\\", "");
-	replace(path_, "?\\", "");
+	// '\\?\UNC\server\share' -> '//server/share'
+	bool isUNC = start > 0 && str.compare(start, 4, "UNC\\") == 0;
+	if (isUNC) {
+		start += 4;
+	}
 
-	// Flip all the slashes around. We flip them back on ToWString().
-	for (size_t i = 0; i < path_.size(); i++) {
-		if (path_[i] == '\\') {
-			path_[i] = '/';
+	path_.reserve(str.size() - start + (isUNC ? 2 : 0));
+	if (isUNC) {
+		path_.append("//");
+	}
+	for (size_t i = start; i < str.size(); i++) {
+		char c = str[i];
+		if (c == '\\') {
+			c = '/';
+		}
+		// Leading '//' (UNC) is the only place where two slashes are kept
+		if (c == '/' && path_.size() > 1 && path_.back() == '/') {
+			continue;
 		}
+		path_.push_back(c);
 	}
 
 	// Don't pop_back if it's just "/".
-	if (type_ == PathTypeUWP::NATIVE && path_.size() > 1 && path_.back() == '/') {
+	if (path_.size() > 1 && path_.back() == '/') {
 		path_.pop_back();
 	}
+
+	// 'C:/Games/../Games/x.iso' -> 'C:/Games/x.iso'
+	if (HasDotSegmentsUWP(path_)) {
+		CanonicalizePathUWP(path_);
+	}
 }
 
 // We always use forward slashes internally, we convert to backslash only when
@@ -80,7 +114,7 @@ PathUWP PathUWP::WithExtraExtension(const std::string& ext) const {
 }
 
 PathUWP PathUWP::WithReplacedExtension(const std::string& oldExtension, const std::string& newExtension) const {
-	if (ends_with(path_, oldExtension)) {
+	if (path_.size() >= oldExtension.size() && path_.compare(path_.size() - oldExtension.size(), oldExtension.size(), oldExtension) == 0) {
 		std::string newPath = path_.substr(0, path_.size() - oldExtension.size());
 		return PathUWP(newPath + newExtension);
 	}
@@ -93,80 +127,87 @@ PathUWP PathUWP::WithReplacedExtension(const std::string& newExtension) const {
 	if (path_.empty()) {
 		return PathUWP(*this);
 	}
-	std::string extension = GetFileExtension();
-	std::string newPath = path_.substr(0, path_.size() - extension.size()) + newExtension;
+	size_t extensionSize = GetFileExtensionView().size();
+	std::string newPath = path_.substr(0, path_.size() - extensionSize) + newExtension;
 	return PathUWP(newPath);
 }
 
 std::string PathUWP::GetFilename() const {
-	size_t pos = path_.rfind('/');
-	if (pos != std::string::npos) {
-		return path_.substr(pos + 1);
-	}
-	return path_;
+	return std::string(GetFilenameView());
 }
 
-static std::string GetExtFromString(const std::string& str) {
-	size_t pos = str.rfind(".");
-	if (pos == std::string::npos) {
-		return "";
+std::string_view PathUWP::GetFilenameView() const {
+	std::string_view view(path_);
+	size_t pos = view.rfind('/');
+	if (pos != std::string_view::npos) {
+		return view.substr(pos + 1);
 	}
-	size_t slash_pos = str.rfind("/");
-	if (slash_pos != std::string::npos && slash_pos > pos) {
-		// Don't want to detect "df/file" from "/as.df/file"
-		return "";
-	}
-	std::string ext = str.substr(pos);
-	tolower(ext);
+	return view;
+}
 
+std::string PathUWP::GetFileExtension() const {
+	std::string ext(GetFileExtensionView());
+	ToLowerASCIIUWP(ext.data(), ext.size());
 	return ext;
 }
 
-std::string PathUWP::GetFileExtension() const {
-	return GetExtFromString(path_);
+std::string_view PathUWP::GetFileExtensionView() const {
+	std::string_view view(path_);
+	size_t pos = view.rfind('.');
+	if (pos == std::string_view::npos) {
+		return std::string_view();
+	}
+	size_t slash_pos = view.rfind('/');
+	if (slash_pos != std::string_view::npos && slash_pos > pos) {
+		// Don't want to detect "df/file" from "/as.df/file"
+		return std::string_view();
+	}
+	return view.substr(pos);
 }
 
 std::string PathUWP::GetDirectory() const {
-	size_t pos = path_.rfind('/');
+	return std::string(GetDirectoryView());
+}
+
+std::string_view PathUWP::GetDirectoryView() const {
+	std::string_view view(path_);
+	size_t pos = view.rfind('/');
 	if (type_ == PathTypeUWP::HTTP) {
 		// Things are a bit different for HTTP, because we probably ended with /.
-		if (pos + 1 == path_.size()) {
-			pos = path_.rfind('/', pos - 1);
-			if (pos != path_.npos && pos > 8) {
-				return path_.substr(0, pos + 1);
+		if (pos + 1 == view.size()) {
+			pos = view.rfind('/', pos - 1);
+			if (pos != view.npos && pos > 8) {
+				return view.substr(0, pos + 1);
 			}
 		}
 	}
 
-	if (pos != std::string::npos) {
+	if (pos != std::string_view::npos) {
 		if (pos == 0) {
 			return "/";  // We're at the root.
 		}
-		return path_.substr(0, pos);
+		return view.substr(0, pos);
 	}
-	else if (path_.size() == 2 && path_[1] == ':') {
+	else if (view.size() == 2 && view[1] == ':') {
 		// Windows fake-root.
 		return "/";
 	}
 	else {
 		// There could be a ':', too. Unlike the slash, let's include that
 		// in the returned directory.
-		size_t c_pos = path_.rfind(':');
-		if (c_pos != std::string::npos) {
-			return path_.substr(0, c_pos + 1);
+		size_t c_pos = view.rfind(':');
+		if (c_pos != std::string_view::npos) {
+			return view.substr(0, c_pos + 1);
 		}
 	}
 	// No directory components, we're a relative path.
-	return path_;
+	return view;
 }
 
 bool PathUWP::FilePathContainsNoCase(const std::string& needle) const {
-	std::string haystack;
-
-	haystack = path_;
 	auto pred = [](char ch1, char ch2) { return std::toupper(ch1) == std::toupper(ch2); };
-	auto found = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(), pred);
-	return found != haystack.end();
+	auto found = std::search(path_.begin(), path_.end(), needle.begin(), needle.end(), pred);
+	return found != path_.end();
 }
 
 bool PathUWP::StartsWith(const PathUWP& other) const {
@@ -174,7 +215,7 @@ bool PathUWP::StartsWith(const PathUWP& other) const {
 		// Bad
 		return false;
 	}
-	return starts_with(path_, other.path_);
+	return path_.compare(0, other.path_.size(), other.path_) == 0;
 }
 
 const std::string& PathUWP::ToString() const {
@@ -182,18 +223,17 @@ const std::string& PathUWP::ToString() const {
 }
 
 std::wstring PathUWP::ToWString() const {
-	std::wstring w = convertToWString(path_);
-	for (size_t i = 0; i < w.size(); i++) {
-		if (w[i] == '/') {
-			w[i] = '\\';
-		}
-	}
+	std::wstring w;
+	UTF8ToWideUWP(path_, w);
+	ReplaceCharUWP(w.data(), w.size(), L'/', L'\\');
 	return w;
 }
 
 std::string PathUWP::ToVisualString() const {
 	if (type_ == PathTypeUWP::NATIVE) {
-		return replace2(path_, "/", "\\");
+		std::string visual = path_;
+		ReplaceCharUWP(visual.data(), visual.size(), '/', '\\');
+		return visual;
 	}
 	else {
 		return path_;
@@ -256,28 +296,209 @@ bool PathUWP::IsAbsolute() const {
 }
 
 bool PathUWP::ComputePathTo(const PathUWP& other, std::string& path) const {
-	if (other == *this) {
-		path.clear();
-		return true;
+	if (type_ != other.type_) {
+		return false;
 	}
 
-	if (!other.StartsWith(*this)) {
+	std::string_view relative;
+	if (!GetRelativePathUWP(path_, other.path_, relative)) {
 		// Can't do this. Should return an error.
 		return false;
 	}
+	path.assign(relative.data(), relative.size());
+	return true;
+}
 
-	if (*this == other) {
-		// Equal, the path is empty.
-		path.clear();
-		return true;
+PathUWP PathUWP::CommonAncestor(const PathUWP& other) const {
+	if (type_ != other.type_) {
+		return PathUWP();
 	}
 
-	if (path_ == "/") {
-		path = other.path_.substr(1);
-		return true;
+	auto components = Components();
+	auto otherComponents = other.Components();
+	auto iter = components.begin();
+	auto otherIter = otherComponents.begin();
+	size_t length = 0;
+	for (; iter != components.end() && otherIter != otherComponents.end(); ++iter, ++otherIter) {
+		if (!PathEqualsUWP(*iter, *otherIter)) {
+			break;
+		}
+		length = iter.End();
+	}
+
+	if (length == 0) {
+		// Both could still share the root '/'
+		if (!path_.empty() && path_[0] == '/' && !other.path_.empty() && other.path_[0] == '/') {
+			return PathUWP("/");
+		}
+		return PathUWP();
+	}
+	return PathUWP(path_.substr(0, length));
+}
+
+static inline bool IsPathSeparator(char c) {
+	return c == '/' || c == '\\';
+}
+
+PathComponentIteratorUWP::PathComponentIteratorUWP(std::string_view path, bool atEnd) : path_(path) {
+	start_ = end_ = atEnd ? path.size() : 0;
+	if (!atEnd) {
+		++*this;
+	}
+}
+
+PathComponentIteratorUWP& PathComponentIteratorUWP::operator++() {
+	size_t i = end_;
+	while (i < path_.size() && IsPathSeparator(path_[i])) {
+		i++;
+	}
+	start_ = i;
+	while (i < path_.size() && !IsPathSeparator(path_[i])) {
+		i++;
+	}
+	end_ = i;
+	return *this;
+}
+
+PathComponentIteratorUWP& PathComponentIteratorUWP::operator--() {
+	size_t i = start_;
+	while (i > 0 && IsPathSeparator(path_[i - 1])) {
+		i--;
+	}
+	end_ = i;
+	while (i > 0 && !IsPathSeparator(path_[i - 1])) {
+		i--;
+	}
+	start_ = i;
+	return *this;
+}
+
+bool GetRelativePathUWP(std::string_view base, std::string_view path, std::string_view& relative) {
+	PathComponentsUWP baseComponents(base);
+	PathComponentsUWP pathComponents(path);
+	auto baseIter = baseComponents.begin();
+	auto pathIter = pathComponents.begin();
+	for (; baseIter != baseComponents.end(); ++baseIter, ++pathIter) {
+		if (pathIter == pathComponents.end() || !PathEqualsUWP(*baseIter, *pathIter)) {
+			return false;
+		}
+	}
+	relative = pathIter != pathComponents.end() ? path.substr(pathIter.Begin()) : std::string_view();
+	while (!relative.empty() && IsPathSeparator(relative.back())) {
+		relative.remove_suffix(1);
+	}
+	return true;
+}
+
+static inline bool IsDotSegment(std::string_view segment) {
+	return segment == "." || segment == "..";
+}
+
+bool HasDotSegmentsUWP(std::string_view path) {
+	for (auto component : PathComponentsUWP(path)) {
+		if (IsDotSegment(component)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void CanonicalizePathUWP(std::string& path, char separator) {
+	size_t size = path.size();
+	if (size == 0) {
+		return;
+	}
+
+	// Output is never longer than input, so it's written in place
+	char* data = &path[0];
+	size_t read = 0;
+	size_t write = 0;
+	bool rooted = true;
+	bool separateFirst = true; // Separator between root and first segment
+
+	if (size >= 2 && IsPathSeparator(data[0]) && IsPathSeparator(data[1])) {
+		// UNC, root is '//server/share'
+		data[write++] = separator;
+		data[write++] = separator;
+		read = 2;
+		for (int part = 0; part < 2; part++) {
+			while (read < size && IsPathSeparator(data[read])) {
+				read++;
+			}
+			if (read >= size) {
+				break;
+			}
+			if (part > 0) {
+				data[write++] = separator;
+			}
+			while (read < size && !IsPathSeparator(data[read])) {
+				data[write++] = data[read++];
+			}
+		}
+		separateFirst = write > 2;
+	}
+	else if (size >= 2 && data[1] == ':' && isalpha((unsigned char)data[0])) {
+		// Drive, 'C:name' is drive relative (no separator after the drive)
+		write = read = 2;
+		separateFirst = read < size && IsPathSeparator(data[read]);
+	}
+	else if (IsPathSeparator(data[0])) {
+		data[write++] = separator;
+		read = 1;
+		separateFirst = false;
 	}
 	else {
-		path = other.path_.substr(path_.size() + 1);
-		return true;
+		rooted = false;
+		separateFirst = false;
+	}
+	size_t rootEnd = write;
+
+	while (read < size) {
+		while (read < size && IsPathSeparator(data[read])) {
+			read++;
+		}
+		size_t start = read;
+		while (read < size && !IsPathSeparator(data[read])) {
+			read++;
+		}
+		std::string_view segment(data + start, read - start);
+		if (segment.empty() || segment == ".") {
+			continue;
+		}
+		if (segment == "..") {
+			size_t last = write;
+			while (last > rootEnd && data[last - 1] != separator) {
+				last--;
+			}
+			bool lastIsParent = write - last == 2 && data[last] == '.' && data[last + 1] == '.';
+			if (write > rootEnd && !lastIsParent) {
+				// Drop previous segment with its separator
+				write = (last > rootEnd) ? last - 1 : last;
+				continue;
+			}
+			if (rooted) {
+				// Never above the root
+				continue;
+			}
+		}
+		if (write > rootEnd || (write == rootEnd && separateFirst)) {
+			data[write++] = separator;
+		}
+		for (size_t i = start; i < read; i++) {
+			data[write++] = data[i];
+		}
+	}
+
+	if (write == 0) {
+		// Relative path that collapsed completely
+		path.assign(".");
+		return;
+	}
+	path.resize(write);
+
+	if (!rooted && write >= 2 && data[1] == ':' && isalpha((unsigned char)data[0])) {
+		// 'a/../c:x' must not turn into drive path
+		path.insert(0, 1, separator);
+		path.insert(0, 1, '.');
 	}
 }
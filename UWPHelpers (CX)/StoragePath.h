@@ -5,6 +5,8 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <iterator>
 
 #define HOST_IS_CASE_SENSITIVE 0
 
@@ -15,6 +17,94 @@ enum class PathTypeUWP {
 	HTTP = 3,  // http://, https://
 };
 
+// Path components without copies, both '/' and '\' are separators
+// 'C:/Games//PSP/' -> 'C:', 'Games', 'PSP' (empty components are skipped)
+// views are valid as long as the source string is not changed
+class PathComponentIteratorUWP {
+public:
+	typedef std::bidirectional_iterator_tag iterator_category;
+	typedef std::string_view value_type;
+	typedef std::ptrdiff_t difference_type;
+	typedef const std::string_view* pointer;
+	typedef std::string_view reference;
+
+	PathComponentIteratorUWP() {}
+	PathComponentIteratorUWP(std::string_view path, bool atEnd);
+
+	std::string_view operator*() const {
+		return path_.substr(start_, end_ - start_);
+	}
+
+	PathComponentIteratorUWP& operator++();
+	PathComponentIteratorUWP& operator--();
+
+	PathComponentIteratorUWP operator++(int) {
+		auto copy = *this;
+		++*this;
+		return copy;
+	}
+	PathComponentIteratorUWP operator--(int) {
+		auto copy = *this;
+		--*this;
+		return copy;
+	}
+
+	bool operator ==(const PathComponentIteratorUWP& other) const {
+		return start_ == other.start_ && path_.data() == other.path_.data();
+	}
+	bool operator !=(const PathComponentIteratorUWP& other) const {
+		return !(*this == other);
+	}
+
+	// Start and end of the component in the source string
+	size_t Begin() const {
+		return start_;
+	}
+	size_t End() const {
+		return end_;
+	}
+
+private:
+	std::string_view path_;
+	size_t start_ = 0;
+	size_t end_ = 0;
+};
+
+class PathComponentsUWP {
+public:
+	typedef PathComponentIteratorUWP iterator;
+	typedef std::reverse_iterator<PathComponentIteratorUWP> reverse_iterator;
+
+	explicit PathComponentsUWP(std::string_view path) : path_(path) {}
+
+	iterator begin() const {
+		return iterator(path_, false);
+	}
+	iterator end() const {
+		return iterator(path_, true);
+	}
+	reverse_iterator rbegin() const {
+		return reverse_iterator(end());
+	}
+	reverse_iterator rend() const {
+		return reverse_iterator(begin());
+	}
+
+private:
+	std::string_view path_;
+};
+
+// Part of 'path' below 'base' (no leading separator, empty if both are the same)
+// compared by components (case insensitive), false if 'path' is not under 'base'
+bool GetRelativePathUWP(std::string_view base, std::string_view path, std::string_view& relative);
+
+// Lexical canonical form, both separators are accepted and 'separator' is used for output
+// repeated separators and '.' segments are removed, '..' removes the previous segment
+// drive ('C:') and UNC ('//server/share') roots are kept and '..' never goes above them
+// relative paths keep their leading '..', a relative path that collapses completely becomes '.'
+void CanonicalizePathUWP(std::string& path, char separator = '/');
+bool HasDotSegmentsUWP(std::string_view path);
+
 // Windows paths are always stored with '/' slashes in a Path.
 // On .ToWString(), they are flipped back to '\'.
 
@@ -68,6 +158,11 @@ public:
 	std::string GetFileExtension() const;  // Always lowercase return. Includes the dot.
 	std::string GetDirectory() const;
 
+	// Same as above without copying, valid as long as the path is not changed.
+	std::string_view GetFilenameView() const;
+	std::string_view GetFileExtensionView() const;  // Original case. Includes the dot.
+	std::string_view GetDirectoryView() const;
+
 	const std::string& ToString() const;
 
 	std::wstring ToWString() const;
@@ -82,8 +177,17 @@ public:
 	// For Android directory trees, navigates to the root of the tree.
 	PathUWP GetRootVolume() const;
 
+	// Relative path from this to 'other' ('C:/Games' to 'C:/Games/PSP/Save' is 'PSP/Save')
 	bool ComputePathTo(const PathUWP& other, std::string& path) const;
 
+	// Deepest shared parent (case insensitive), empty path if there is none
+	PathUWP CommonAncestor(const PathUWP& other) const;
+
+	// Components iterator ('for (auto part : path.Components())')
+	PathComponentsUWP Components() const {
+		return PathComponentsUWP(path_);
+	}
+
 	bool operator ==(const PathUWP& other) const {
 		return path_ == other.path_ && type_ == other.type_;
 	}
@@ -0,0 +1,32 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Case insensitive path comparison without copies
+// '/' and '\' are treated as the same separator
+// ASCII is compared 16 bytes at a time (SSE2/NEON when available),
+// non-ASCII (UTF-8) falls back to simple case folding
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// 'C:\Games' and 'c:/games/' are equal
+bool PathEqualsUWP(std::string_view a, std::string_view b);
+
+// Component boundary aware: 'C:\Games' is parent of 'C:\Games\PSP' but not of 'C:\GamesX'
+// path itself is included ('C:\Games' starts with 'C:\Games')
+bool PathStartsWithUWP(std::string_view path, std::string_view parent);
+
+// Exactly one level below: 'C:\Games\PSP' is direct child of 'C:\Games'
+bool PathIsDirectChildUWP(std::string_view parent, std::string_view child);
+
+// Simple case folding of single code point (BMP)
+uint32_t FoldCodePointUWP(uint32_t codePoint);
+
+// Fold the case of UTF-8 string in place (separators are kept as is)
+void FoldCaseUWP(std::string& input);
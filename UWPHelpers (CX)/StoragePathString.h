@@ -0,0 +1,99 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Path that keeps both UTF-8 and UTF-16 forms
+// the form the caller didn't provide is converted on first use and cached,
+// so a wide path reaches the Win32 (W) APIs without a round trip through UTF-8
+// not thread safe, meant to be passed down a single call
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <string_view>
+
+#include "StorageEncoding.h"
+
+class PathStringUWP {
+public:
+	PathStringUWP(const std::string& path) : utf8_(path), hasUTF8_(true) {
+	}
+
+	PathStringUWP(std::string&& path) : utf8_(std::move(path)), hasUTF8_(true) {
+	}
+
+	PathStringUWP(const std::wstring& path) : wide_(path), hasWide_(true) {
+	}
+
+	PathStringUWP(std::wstring&& path) : wide_(std::move(path)), hasWide_(true) {
+	}
+
+	// Explicit to keep 'std::wstring' overloads unambiguous for literals
+	explicit PathStringUWP(const wchar_t* path) : wide_(path != nullptr ? path : L""), hasWide_(true) {
+	}
+
+	const std::string& UTF8() const {
+		if (!hasUTF8_) {
+			WideToUTF8UWP(wide_, utf8_);
+			hasUTF8_ = true;
+		}
+		return utf8_;
+	}
+
+	const std::wstring& Wide() const {
+		if (!hasWide_) {
+			UTF8ToWideUWP(utf8_, wide_);
+			hasWide_ = true;
+		}
+		return wide_;
+	}
+
+	// Form provided by the caller (or already converted)
+	bool HasUTF8() const {
+		return hasUTF8_;
+	}
+
+	bool HasWide() const {
+		return hasWide_;
+	}
+
+	bool empty() const {
+		return hasUTF8_ ? utf8_.empty() : wide_.empty();
+	}
+
+private:
+	mutable std::string utf8_;
+	mutable std::wstring wide_;
+	mutable bool hasUTF8_ = false;
+	mutable bool hasWide_ = false;
+};
+
+// Wide path that resolving gives back as is: drive path with '\' only ('C:\Games\a.iso'),
+// no doubled or trailing separator and no '.' or '..' names (mount points are not checked)
+inline bool IsPlainWidePathUWP(std::wstring_view path) {
+	if (path.size() < 4 || path[1] != L':' || path[2] != L'\\') {
+		return false;
+	}
+	wchar_t drive = path[0] | 0x20;
+	if (drive < L'a' || drive > L'z') {
+		return false;
+	}
+	size_t start = 3;
+	for (size_t i = start; i <= path.size(); i++) {
+		if (i < path.size() && path[i] != L'\\') {
+			if (path[i] == L'/') {
+				return false;
+			}
+			continue;
+		}
+		auto name = path.substr(start, i - start);
+		if (name.empty() || name == L"." || name == L"..") {
+			return false;
+		}
+		start = i + 1;
+	}
+	return true;
+}
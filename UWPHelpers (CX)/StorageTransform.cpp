@@ -0,0 +1,333 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+#include "StorageTransform.h"
+
+#include <cstdint>
+#include <cwchar>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define TRANSFORM_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TRANSFORM_AVX2_TARGET
+#else
+#define TRANSFORM_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define TRANSFORM_NEON 1
+#include <arm_neon.h>
+#endif
+
+// 'RangeXor': units in [low, high] are xor'ed with 'bit' (case mapping)
+// 'Replace': units equal to 'from' become 'to' (slashes)
+typedef void (*RangeXor8UWP)(uint8_t* data, size_t size, uint8_t low, uint8_t high, uint8_t bit);
+typedef void (*Replace8UWP)(uint8_t* data, size_t size, uint8_t from, uint8_t to);
+typedef void (*RangeXor16UWP)(uint16_t* data, size_t size, uint16_t low, uint16_t high, uint16_t bit);
+typedef void (*Replace16UWP)(uint16_t* data, size_t size, uint16_t from, uint16_t to);
+
+struct TransformKernelsUWP {
+	RangeXor8UWP rangeXor8;
+	Replace8UWP replace8;
+	RangeXor16UWP rangeXor16;
+	Replace16UWP replace16;
+	const char* name;
+};
+
+#pragma region Scalar
+template<typename T>
+static void RangeXorScalar(T* data, size_t size, T low, T high, T bit) {
+	for (size_t i = 0; i < size; i++) {
+		if (data[i] >= low && data[i] <= high) {
+			data[i] ^= bit;
+		}
+	}
+}
+
+template<typename T>
+static void ReplaceScalar(T* data, size_t size, T from, T to) {
+	for (size_t i = 0; i < size; i++) {
+		if (data[i] == from) {
+			data[i] = to;
+		}
+	}
+}
+
+static void RangeXor8Scalar(uint8_t* data, size_t size, uint8_t low, uint8_t high, uint8_t bit) {
+	RangeXorScalar<uint8_t>(data, size, low, high, bit);
+}
+
+static void Replace8Scalar(uint8_t* data, size_t size, uint8_t from, uint8_t to) {
+	ReplaceScalar<uint8_t>(data, size, from, to);
+}
+
+static void RangeXor16Scalar(uint16_t* data, size_t size, uint16_t low, uint16_t high, uint16_t bit) {
+	RangeXorScalar<uint16_t>(data, size, low, high, bit);
+}
+
+static void Replace16Scalar(uint16_t* data, size_t size, uint16_t from, uint16_t to) {
+	ReplaceScalar<uint16_t>(data, size, from, to);
+}
+#pragma endregion
+
+#if TRANSFORM_X86
+#pragma region SSE2
+// Signed compares are fine, 'low'/'high' are ASCII and non-ASCII units are negative or above them
+static void RangeXor8SSE2(uint8_t* data, size_t size, uint8_t low, uint8_t high, uint8_t bit) {
+	const __m128i vlow = _mm_set1_epi8((char)(low - 1));
+	const __m128i vhigh = _mm_set1_epi8((char)(high + 1));
+	const __m128i vbit = _mm_set1_epi8((char)bit);
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i mask = _mm_and_si128(_mm_cmpgt_epi8(v, vlow), _mm_cmplt_epi8(v, vhigh));
+		_mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(v, _mm_and_si128(mask, vbit)));
+	}
+	RangeXor8Scalar(data + i, size - i, low, high, bit);
+}
+
+static void Replace8SSE2(uint8_t* data, size_t size, uint8_t from, uint8_t to) {
+	const __m128i vfrom = _mm_set1_epi8((char)from);
+	const __m128i vto = _mm_set1_epi8((char)to);
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i mask = _mm_cmpeq_epi8(v, vfrom);
+		_mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(_mm_andnot_si128(mask, v), _mm_and_si128(mask, vto)));
+	}
+	Replace8Scalar(data + i, size - i, from, to);
+}
+
+static void RangeXor16SSE2(uint16_t* data, size_t size, uint16_t low, uint16_t high, uint16_t bit) {
+	const __m128i vlow = _mm_set1_epi16((short)(low - 1));
+	const __m128i vhigh = _mm_set1_epi16((short)(high + 1));
+	const __m128i vbit = _mm_set1_epi16((short)bit);
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i mask = _mm_and_si128(_mm_cmpgt_epi16(v, vlow), _mm_cmplt_epi16(v, vhigh));
+		_mm_storeu_si128((__m128i*)(data + i), _mm_xor_si128(v, _mm_and_si128(mask, vbit)));
+	}
+	RangeXor16Scalar(data + i, size - i, low, high, bit);
+}
+
+static void Replace16SSE2(uint16_t* data, size_t size, uint16_t from, uint16_t to) {
+	const __m128i vfrom = _mm_set1_epi16((short)from);
+	const __m128i vto = _mm_set1_epi16((short)to);
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(data + i));
+		__m128i mask = _mm_cmpeq_epi16(v, vfrom);
+		_mm_storeu_si128((__m128i*)(data + i), _mm_or_si128(_mm_andnot_si128(mask, v), _mm_and_si128(mask, vto)));
+	}
+	Replace16Scalar(data + i, size - i, from, to);
+}
+#pragma endregion
+
+#pragma region AVX2
+TRANSFORM_AVX2_TARGET static void RangeXor8AVX2(uint8_t* data, size_t size, uint8_t low, uint8_t high, uint8_t bit) {
+	const __m256i vlow = _mm256_set1_epi8((char)(low - 1));
+	const __m256i vhigh = _mm256_set1_epi8((char)(high + 1));
+	const __m256i vbit = _mm256_set1_epi8((char)bit);
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i mask = _mm256_and_si256(_mm256_cmpgt_epi8(v, vlow), _mm256_cmpgt_epi8(vhigh, v));
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(v, _mm256_and_si256(mask, vbit)));
+	}
+	RangeXor8SSE2(data + i, size - i, low, high, bit);
+}
+
+TRANSFORM_AVX2_TARGET static void Replace8AVX2(uint8_t* data, size_t size, uint8_t from, uint8_t to) {
+	const __m256i vfrom = _mm256_set1_epi8((char)from);
+	const __m256i vto = _mm256_set1_epi8((char)to);
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i mask = _mm256_cmpeq_epi8(v, vfrom);
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_blendv_epi8(v, vto, mask));
+	}
+	Replace8SSE2(data + i, size - i, from, to);
+}
+
+TRANSFORM_AVX2_TARGET static void RangeXor16AVX2(uint16_t* data, size_t size, uint16_t low, uint16_t high, uint16_t bit) {
+	const __m256i vlow = _mm256_set1_epi16((short)(low - 1));
+	const __m256i vhigh = _mm256_set1_epi16((short)(high + 1));
+	const __m256i vbit = _mm256_set1_epi16((short)bit);
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i mask = _mm256_and_si256(_mm256_cmpgt_epi16(v, vlow), _mm256_cmpgt_epi16(vhigh, v));
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_xor_si256(v, _mm256_and_si256(mask, vbit)));
+	}
+	RangeXor16SSE2(data + i, size - i, low, high, bit);
+}
+
+TRANSFORM_AVX2_TARGET static void Replace16AVX2(uint16_t* data, size_t size, uint16_t from, uint16_t to) {
+	const __m256i vfrom = _mm256_set1_epi16((short)from);
+	const __m256i vto = _mm256_set1_epi16((short)to);
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)(data + i));
+		__m256i mask = _mm256_cmpeq_epi16(v, vfrom);
+		_mm256_storeu_si256((__m256i*)(data + i), _mm256_blendv_epi8(v, vto, mask));
+	}
+	Replace16SSE2(data + i, size - i, from, to);
+}
+#pragma endregion
+
+static bool IsAVX2Supported() {
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx) {
+		return false;
+	}
+	// OS must save YMM registers
+	if ((_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+#if TRANSFORM_NEON
+#pragma region NEON
+static void RangeXor8NEON(uint8_t* data, size_t size, uint8_t low, uint8_t high, uint8_t bit) {
+	const uint8x16_t vlow = vdupq_n_u8(low);
+	const uint8x16_t vhigh = vdupq_n_u8(high);
+	const uint8x16_t vbit = vdupq_n_u8(bit);
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		uint8x16_t v = vld1q_u8(data + i);
+		uint8x16_t mask = vandq_u8(vcgeq_u8(v, vlow), vcleq_u8(v, vhigh));
+		vst1q_u8(data + i, veorq_u8(v, vandq_u8(mask, vbit)));
+	}
+	RangeXor8Scalar(data + i, size - i, low, high, bit);
+}
+
+static void Replace8NEON(uint8_t* data, size_t size, uint8_t from, uint8_t to) {
+	const uint8x16_t vfrom = vdupq_n_u8(from);
+	const uint8x16_t vto = vdupq_n_u8(to);
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		uint8x16_t v = vld1q_u8(data + i);
+		vst1q_u8(data + i, vbslq_u8(vceqq_u8(v, vfrom), vto, v));
+	}
+	Replace8Scalar(data + i, size - i, from, to);
+}
+
+static void RangeXor16NEON(uint16_t* data, size_t size, uint16_t low, uint16_t high, uint16_t bit) {
+	const uint16x8_t vlow = vdupq_n_u16(low);
+	const uint16x8_t vhigh = vdupq_n_u16(high);
+	const uint16x8_t vbit = vdupq_n_u16(bit);
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint16x8_t v = vld1q_u16(data + i);
+		uint16x8_t mask = vandq_u16(vcgeq_u16(v, vlow), vcleq_u16(v, vhigh));
+		vst1q_u16(data + i, veorq_u16(v, vandq_u16(mask, vbit)));
+	}
+	RangeXor16Scalar(data + i, size - i, low, high, bit);
+}
+
+static void Replace16NEON(uint16_t* data, size_t size, uint16_t from, uint16_t to) {
+	const uint16x8_t vfrom = vdupq_n_u16(from);
+	const uint16x8_t vto = vdupq_n_u16(to);
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		uint16x8_t v = vld1q_u16(data + i);
+		vst1q_u16(data + i, vbslq_u16(vceqq_u16(v, vfrom), vto, v));
+	}
+	Replace16Scalar(data + i, size - i, from, to);
+}
+#pragma endregion
+#endif
+
+static TransformKernelsUWP SelectKernels() {
+#if TRANSFORM_X86
+	if (IsAVX2Supported()) {
+		return { RangeXor8AVX2, Replace8AVX2, RangeXor16AVX2, Replace16AVX2, "AVX2" };
+	}
+	return { RangeXor8SSE2, Replace8SSE2, RangeXor16SSE2, Replace16SSE2, "SSE2" };
+#elif TRANSFORM_NEON
+	return { RangeXor8NEON, Replace8NEON, RangeXor16NEON, Replace16NEON, "NEON" };
+#else
+	return { RangeXor8Scalar, Replace8Scalar, RangeXor16Scalar, Replace16Scalar, "Scalar" };
+#endif
+}
+
+static const TransformKernelsUWP& GetKernels() {
+	static const TransformKernelsUWP kernels = SelectKernels();
+	return kernels;
+}
+
+const char* GetTransformKernelUWP() {
+	return GetKernels().name;
+}
+
+void ToLowerASCIIUWP(char* data, size_t size) {
+	GetKernels().rangeXor8((uint8_t*)data, size, 'A', 'Z', 0x20);
+}
+
+void ToUpperASCIIUWP(char* data, size_t size) {
+	GetKernels().rangeXor8((uint8_t*)data, size, 'a', 'z', 0x20);
+}
+
+void ReplaceCharUWP(char* data, size_t size, char from, char to) {
+	GetKernels().replace8((uint8_t*)data, size, (uint8_t)from, (uint8_t)to);
+}
+
+void ToLowerASCIIUWP(char16_t* data, size_t size) {
+	GetKernels().rangeXor16((uint16_t*)data, size, 'A', 'Z', 0x20);
+}
+
+void ToUpperASCIIUWP(char16_t* data, size_t size) {
+	GetKernels().rangeXor16((uint16_t*)data, size, 'a', 'z', 0x20);
+}
+
+void ReplaceCharUWP(char16_t* data, size_t size, char16_t from, char16_t to) {
+	GetKernels().replace16((uint16_t*)data, size, (uint16_t)from, (uint16_t)to);
+}
+
+#if WCHAR_MAX <= 0xFFFF
+void ToLowerASCIIUWP(wchar_t* data, size_t size) {
+	ToLowerASCIIUWP((char16_t*)data, size);
+}
+
+void ToUpperASCIIUWP(wchar_t* data, size_t size) {
+	ToUpperASCIIUWP((char16_t*)data, size);
+}
+
+void ReplaceCharUWP(wchar_t* data, size_t size, wchar_t from, wchar_t to) {
+	ReplaceCharUWP((char16_t*)data, size, (char16_t)from, (char16_t)to);
+}
+#else
+// 32-bit wchar_t (non Windows builds)
+void ToLowerASCIIUWP(wchar_t* data, size_t size) {
+	RangeXorScalar<wchar_t>(data, size, L'A', L'Z', 0x20);
+}
+
+void ToUpperASCIIUWP(wchar_t* data, size_t size) {
+	RangeXorScalar<wchar_t>(data, size, L'a', L'z', 0x20);
+}
+
+void ReplaceCharUWP(wchar_t* data, size_t size, wchar_t from, wchar_t to) {
+	ReplaceScalar<wchar_t>(data, size, from, to);
+}
+#endif
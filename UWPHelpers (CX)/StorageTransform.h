@@ -0,0 +1,31 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// In place ASCII transforms for UTF-8 and UTF-16 buffers
+// only ASCII units are changed, non-ASCII bytes/units are kept as is (so UTF-8/UTF-16 stays valid)
+// best kernel is selected once at runtime (AVX2, SSE2, NEON or scalar)
+
+#pragma once
+
+#include <cstddef>
+
+// UTF-8
+void ToLowerASCIIUWP(char* data, size_t size);
+void ToUpperASCIIUWP(char* data, size_t size);
+void ReplaceCharUWP(char* data, size_t size, char from, char to);
+
+// UTF-16
+void ToLowerASCIIUWP(char16_t* data, size_t size);
+void ToUpperASCIIUWP(char16_t* data, size_t size);
+void ReplaceCharUWP(char16_t* data, size_t size, char16_t from, char16_t to);
+
+// wchar_t is UTF-16 on Windows
+void ToLowerASCIIUWP(wchar_t* data, size_t size);
+void ToUpperASCIIUWP(wchar_t* data, size_t size);
+void ReplaceCharUWP(wchar_t* data, size_t size, wchar_t from, wchar_t to);
+
+// Selected kernel name (for logs)
+const char* GetTransformKernelUWP();
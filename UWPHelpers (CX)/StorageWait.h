@@ -0,0 +1,186 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Blocking bridge for async results [Internal usage]
+// the waiting thread sleeps until the result is ready,
+// UI thread keeps processing its events meanwhile (through 'WaitDispatcherUWP')
+// waits are bounded by the limits of the thread ('StorageLimits.h')
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <condition_variable>
+
+#include "StorageLimits.h"
+
+// Events source of the waiting thread
+class WaitDispatcherUWP {
+public:
+	virtual ~WaitDispatcherUWP() {
+	}
+
+	// Thread has events that must keep running while waiting (UI thread)
+	virtual bool NeedsPumping() = 0;
+
+	// Block until there is an event, then process all pending events
+	// return false if events can't be processed anymore (plain wait will be used)
+	virtual bool ProcessEvents() = 0;
+
+	// Make 'ProcessEvents' return, called from the completion thread
+	virtual void Wake() = 0;
+
+	// Make 'ProcessEvents' return at 'time' (deadline of the wait)
+	virtual void WakeAt(std::chrono::steady_clock::time_point time) = 0;
+};
+
+class WaitSignalUWP : public CancelTargetUWP {
+public:
+	// Completion side (any thread)
+	// Notified under the lock, the waiter may destroy the signal right after
+	void Set() {
+		std::lock_guard<std::mutex> lock(signalLock);
+		done = true;
+		if (waker != nullptr) {
+			waker->Wake();
+		}
+		signalCondition.notify_all();
+	}
+
+	bool IsSet() const {
+		return done;
+	}
+
+	// Token side, wakes the waiter without completing
+	void Interrupt() override {
+		std::lock_guard<std::mutex> lock(signalLock);
+		interrupted = true;
+		if (waker != nullptr) {
+			waker->Wake();
+		}
+		signalCondition.notify_all();
+	}
+
+	// Waiting side, 'dispatcher' and 'limits' can be nullptr
+	// return 'STORAGE_CALL_COMPLETED' once set, otherwise why the limits stopped the wait
+	StorageCallResultUWP Wait(WaitDispatcherUWP* dispatcher, const StorageLimitsUWP* limits = nullptr) {
+		CancelTokenUWP* token = (limits != nullptr) ? limits->token.get() : nullptr;
+		if (token != nullptr) {
+			token->Add(this);
+		}
+		auto state = WaitUntilStopped(dispatcher, limits);
+		if (token != nullptr) {
+			token->Remove(this);
+		}
+		return state;
+	}
+
+private:
+	bool IsStopped(const StorageLimitsUWP* limits) const {
+		return done || interrupted || (limits != nullptr && limits->Check() != STORAGE_CALL_COMPLETED);
+	}
+
+	StorageCallResultUWP WaitUntilStopped(WaitDispatcherUWP* dispatcher, const StorageLimitsUWP* limits) {
+		if (dispatcher != nullptr && dispatcher->NeedsPumping()) {
+			{
+				std::lock_guard<std::mutex> lock(signalLock);
+				if (IsStopped(limits)) {
+					return Result(limits);
+				}
+				waker = dispatcher;
+			}
+			if (limits != nullptr && limits->HasDeadline()) {
+				dispatcher->WakeAt(limits->deadline);
+			}
+			bool pumping = true;
+			while (!IsStopped(limits) && pumping) {
+				pumping = dispatcher->ProcessEvents();
+			}
+			// 'Set' may be inside 'Wake' still, dispatcher must outlive it
+			std::lock_guard<std::mutex> lock(signalLock);
+			waker = nullptr;
+		}
+
+		std::unique_lock<std::mutex> lock(signalLock);
+		auto stopped = [this, limits]() { return IsStopped(limits); };
+		if (limits != nullptr && limits->HasDeadline()) {
+			signalCondition.wait_until(lock, limits->deadline, stopped);
+		}
+		else {
+			signalCondition.wait(lock, stopped);
+		}
+		return Result(limits);
+	}
+
+	StorageCallResultUWP Result(const StorageLimitsUWP* limits) const {
+		if (done || limits == nullptr) {
+			return STORAGE_CALL_COMPLETED;
+		}
+		return limits->IsCanceled() ? STORAGE_CALL_CANCELED : STORAGE_CALL_TIMEOUT;
+	}
+
+	std::mutex signalLock;
+	std::condition_variable signalCondition;
+	std::atomic<bool> done{ false };
+	std::atomic<bool> interrupted{ false };
+	WaitDispatcherUWP* waker = nullptr;
+};
+
+// One time initialization with a ready state
+// 'Start' runs the fast phase once (other callers block until it returned),
+// slow phase runs anywhere and calls 'SetReady' once it's done
+class ReadyStateUWP {
+public:
+	void Start(const std::function<void()>& init) {
+		std::call_once(startOnce, init);
+	}
+
+	void SetReady() {
+		std::vector<std::shared_ptr<WaitSignalUWP>> signals;
+		{
+			std::lock_guard<std::mutex> lock(readyLock);
+			ready = true;
+			signals.swap(waiters);
+		}
+		for (auto& signal : signals) {
+			signal->Set();
+		}
+	}
+
+	bool IsReady() {
+		std::lock_guard<std::mutex> lock(readyLock);
+		return ready;
+	}
+
+	// Same as 'WaitSignalUWP::Wait', each waiter has its own signal (many threads can wait)
+	StorageCallResultUWP Wait(WaitDispatcherUWP* dispatcher, const StorageLimitsUWP* limits = nullptr) {
+		auto signal = std::make_shared<WaitSignalUWP>();
+		{
+			std::lock_guard<std::mutex> lock(readyLock);
+			if (ready) {
+				return STORAGE_CALL_COMPLETED;
+			}
+			waiters.push_back(signal);
+		}
+		auto state = signal->Wait(dispatcher, limits);
+		if (state != STORAGE_CALL_COMPLETED) {
+			std::lock_guard<std::mutex> lock(readyLock);
+			waiters.erase(std::remove(waiters.begin(), waiters.end(), signal), waiters.end());
+		}
+		return state;
+	}
+
+private:
+	std::once_flag startOnce;
+	std::mutex readyLock;
+	bool ready = false;
+	std::vector<std::shared_ptr<WaitSignalUWP>> waiters;
+};
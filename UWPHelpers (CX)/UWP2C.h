@@ -15,6 +15,8 @@ extern "C" {
 	void* CreateFileUWP(const char* path, int accessMode, int shareMode, int openMode);
 	int GetFileAttributesUWP(const void* name, void* lpFileInformation);
 	int DeleteFileUWP(const void* name);
+	int MountUWP(const void* root, const void* target); // Wide strings ('/roms', 'D:\\Games\\ROMs')
+	int UnmountUWP(const void* root);
 
 #ifdef __cplusplus
 }
@@ -10,6 +10,9 @@
 #include "StorageAsync.h"
 #include "StorageAccess.h"
 #include "StorageItemW.h"
+#include "StorageLookup.h"
+#include "StorageParallel.h"
+#include "StorageManager.h"
 
 #include <winrt/Windows.Foundation.Collections.h>
 #include <winrt/Windows.Foundation.Metadata.h>
@@ -21,6 +24,15 @@
 #include <winrt/Windows.ApplicationModel.h>
 #include <winrt/Windows.UI.Core.h>
 
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
 using namespace winrt::Windows::Storage;
 using namespace winrt::Windows::Foundation::Collections;
 using namespace winrt::Windows::Storage::AccessCache;
@@ -28,7 +40,17 @@ using namespace winrt::Windows::ApplicationModel;
 using namespace winrt::Windows::UI::Core;
 
 // Main lookup list
-std::list<StorageItemW> FutureAccessItems;
+// indexed by path components, see 'StoragePathTrie.h'
+// never modified in place, see 'StorageLookup.h'
+VersionedUWP<LookupIndexUWP> FutureAccessItems;
+
+LookupSnapshotUWP GetLookupSnapshot() {
+	return FutureAccessItems.Get();
+}
+
+void UpdateLookupList(std::function<void(LookupIndexUWP&)> update) {
+	FutureAccessItems.Update(update);
+}
 
 // Get value from app local settings
 winrt::hstring GetDataFromLocalSettings(winrt::hstring key) {
@@ -73,20 +95,41 @@ bool AddDataToLocalSettings(std::string key, std::string data, bool replace) {
 
 // Add item to history list (FutureAccessItems)
 void AddToAccessibleItems(IStorageItem item) {
-	bool isFolderAddedBefore = false;
-	for (auto folderItem : FutureAccessItems) {
-		if (folderItem.Equal(item)) {
-			isFolderAddedBefore = true;
-			break;
-		}
+	if (item == nullptr) {
+		return;
 	}
 
+	std::string itemPath = convert(item.Path());
+	bool isFolderAddedBefore = GetLookupSnapshot()->Find(itemPath) != nullptr;
+
 	if (!isFolderAddedBefore) {
-		FutureAccessItems.push_back(StorageItemW(item));
+		UpdateLookupList([&](LookupIndexUWP& lookup) {
+			if (lookup.Find(itemPath) == nullptr) {
+				lookup.Insert(itemPath, StorageItemW(item));
+			}
+		});
 	}
 }
 
 
+// Add many items at once (single lookup list version)
+void AddToAccessibleItems(const std::vector<IStorageItem>& items) {
+	if (items.empty()) {
+		return;
+	}
+
+	UpdateLookupList([&](LookupIndexUWP& lookup) {
+		for (auto& item : items) {
+			if (item != nullptr) {
+				std::string itemPath = convert(item.Path());
+				if (lookup.Find(itemPath) == nullptr) {
+					lookup.Insert(itemPath, StorageItemW(item));
+				}
+			}
+		}
+	});
+}
+
 // Add folder to future list (to avoid request picker again)
 void AddItemToFutureList(IStorageItem item) {
 	try {
@@ -124,91 +167,290 @@ void AppendItemByToken(winrt::hstring token) {
 	}
 }
 
-// Update the history list by the future list (to restore all the picked items)
-void UpdateItemsByFutureList() {
-	auto AccessList = AccessCache::StorageApplicationPermissions::FutureAccessList().Entries();
-	for (auto ListItem : AccessList) {
-		winrt::hstring itemToken = ListItem.Token;
-		AppendItemByToken(itemToken);
+// Warm start snapshot
+// entries are only classification hints, tokens are resolved on first use
+VersionedUWP<WarmIndexUWP> WarmAccessItems;
+
+std::shared_ptr<const WarmIndexUWP> GetWarmLookupIndex() {
+	return WarmAccessItems.Get();
+}
+
+std::wstring GetLookupSnapshotFile() {
+	return std::wstring(ApplicationData::Current().LocalFolder().Path().c_str()) + L"\\" + LOOKUP_SNAPSHOT_FILE;
+}
+
+void LoadWarmLookupList() {
+#if LOOKUP_SNAPSHOT_ENABLED
+	try {
+		std::ifstream file(GetLookupSnapshotFile(), std::ios::binary);
+		if (!file.is_open()) {
+			return;
+		}
+		std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		std::vector<LookupSnapshotEntryUWP> entries;
+		int64_t created;
+		if (!DeserializeLookupSnapshot(data, entries, created)) {
+			UWP_WARN_LOG(UWPSMT, "Lookup snapshot is not valid, ignored");
+			return;
+		}
+		int64_t now = (int64_t)std::time(nullptr);
+		if (created > now || now - created > LOOKUP_SNAPSHOT_MAX_AGE) {
+			UWP_WARN_LOG(UWPSMT, "Lookup snapshot is too old, ignored");
+			return;
+		}
+
+		auto warm = std::make_shared<WarmIndexUWP>();
+		for (auto& entry : entries) {
+			warm->Insert(entry.path, entry);
+		}
+		WarmAccessItems.Publish(warm);
+		UWP_DEBUG_LOG(UWPSMT, "Lookup snapshot loaded (%d items)", (int)entries.size());
 	}
+	catch (...) {
+	}
+#endif
 }
 
-bool fillListsCalled = false;
-bool fillListInProgress = false;
-void FillLookupList() {
-	if (fillListsCalled) {
-		// Should be called only once
-		// but let's wait in case we got too calls at once
-		CoreWindow corewindow = CoreWindow::GetForCurrentThread();
-		while (fillListInProgress)
+void SaveWarmLookupList(const std::vector<LookupSnapshotEntryUWP>& entries) {
+#if LOOKUP_SNAPSHOT_ENABLED
+	try {
+		std::string data;
+		SerializeLookupSnapshot(entries, (int64_t)std::time(nullptr), data);
+
+		// Write to temp file first, a broken write will never replace a good snapshot
+		std::wstring file = GetLookupSnapshotFile();
+		std::wstring temp = file + L".tmp";
 		{
-			try {
-				if (corewindow) {
-					corewindow.Dispatcher().ProcessEvents(CoreProcessEventsOption::ProcessAllIfPresent);
-				}
-				else {
-					corewindow = CoreWindow::GetForCurrentThread();
-				}
+			std::ofstream output(temp, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) {
+				return;
 			}
-			catch (...) {
+			output.write(data.data(), data.size());
+			if (!output.good()) {
+				output.close();
+				_wremove(temp.c_str());
+				return;
+			}
+		}
+		// Single replace, readers see the old snapshot or the new one (never none)
+		if (!MoveFileExW(temp.c_str(), file.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+			_wremove(temp.c_str());
+		}
+	}
+	catch (...) {
+	}
+#endif
+}
+
+bool ResolveWarmEntry(const std::string& path) {
+	auto warm = GetWarmLookupIndex();
+	if (warm->empty()) {
+		return false;
+	}
 
+	std::vector<const LookupSnapshotEntryUWP*> entries;
+	warm->GetAncestors(path, entries, true);
+	for (auto entry : entries) {
+		if (GetLookupSnapshot()->Find(entry->path) != nullptr) {
+			// Already resolved by other call or by the background restore
+			return true;
+		}
+		try {
+			winrt::hstring token = convert(entry->token);
+			if (AccessCache::StorageApplicationPermissions::FutureAccessList().ContainsItem(token)) {
+				IStorageItem storageItem;
+				ExecuteTask(storageItem, AccessCache::StorageApplicationPermissions::FutureAccessList().GetItemAsync(token));
+				if (storageItem != nullptr) {
+					AddToAccessibleItems(storageItem);
+					return true;
+				}
 			}
 		}
-		return;
+		catch (...) {
+			// Access denied or file moved/deleted, background restore will prune it
+		}
 	}
-	fillListsCalled = true;
-	fillListInProgress = true;
-	// Clean access list from any deleted/moved items
+	return false;
+}
+
+// Update the history list by the future list (to restore all the picked items)
+// each token is resolved once, the result decides both pruning and insertion
+// tokens are resolved by 'FUTURE_ACCESS_RESOLVE_WORKERS' threads at once
+// must not be called from UI thread (it will wait for the workers)
+FutureAccessStatsUWP futureAccessStats;
+std::mutex futureAccessStatsLock;
+
+void UpdateItemsByFutureList() {
+	auto startTime = std::chrono::steady_clock::now();
+
+	std::vector<winrt::hstring> tokens;
 	for (auto listItem : AccessCache::StorageApplicationPermissions::FutureAccessList().Entries()) {
+		tokens.push_back(listItem.Token);
+	}
+
+	std::vector<IStorageItem> items(tokens.size(), nullptr);
+	std::vector<double> latency(tokens.size(), 0);
+
+	ParallelForUWP(tokens.size(), FUTURE_ACCESS_RESOLVE_WORKERS, [&](size_t i) {
+		// Each slot is written by one worker only
+		auto tokenStart = std::chrono::steady_clock::now();
 		try {
-			IStorageItem test;
-			ExecuteTask(test, AccessCache::StorageApplicationPermissions::FutureAccessList().GetItemAsync(listItem.Token));
-			if (test == nullptr) {
-				// Access denied or file moved/deleted
-				AccessCache::StorageApplicationPermissions::FutureAccessList().Remove(listItem.Token);
-			}
+			IStorageItem storageItem;
+			ExecuteTask(storageItem, AccessCache::StorageApplicationPermissions::FutureAccessList().GetItemAsync(tokens[i]));
+			items[i] = storageItem;
 		}
 		catch (...) {
 			// Access denied or file moved/deleted
-			AccessCache::StorageApplicationPermissions::FutureAccessList().Remove(listItem.Token);
+		}
+		latency[i] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - tokenStart).count();
+		UWP_VERBOSE_LOG(UWPSMT, "Token resolved in %.2fms (%s)", latency[i], convert(tokens[i]).c_str());
+	});
+
+	// FutureAccessList is changed only here, after all workers are done
+	FutureAccessStatsUWP stats;
+	std::vector<LookupSnapshotEntryUWP> snapshotEntries;
+	int64_t validated = (int64_t)std::time(nullptr);
+	for (size_t i = 0; i < tokens.size(); i++) {
+		stats.totalMs += latency[i];
+		if (latency[i] > stats.maxMs) {
+			stats.maxMs = latency[i];
+		}
+		if (items[i] == nullptr) {
+			try {
+				AccessCache::StorageApplicationPermissions::FutureAccessList().Remove(tokens[i]);
+			}
+			catch (...) {
+			}
+			stats.pruned++;
+		}
+		else {
+			stats.resolved++;
+
+			LookupSnapshotEntryUWP entry;
+			entry.token = convert(tokens[i]);
+			entry.path = convert(items[i].Path());
+			entry.isDirectory = items[i].IsOfType(StorageItemTypes::Folder);
+			entry.validated = validated;
+			snapshotEntries.push_back(entry);
 		}
 	}
+	AddToAccessibleItems(items);
+	SaveWarmLookupList(snapshotEntries);
+
+	stats.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+	UWP_DEBUG_LOG(UWPSMT, "Picked items restored: %d valid, %d pruned, %.2fms (token avg %.2fms, max %.2fms)",
+		(int)stats.resolved, (int)stats.pruned, stats.wallMs, tokens.empty() ? 0.0 : stats.totalMs / tokens.size(), stats.maxMs);
 
-	// Get files/folders selected by the user
-	UpdateItemsByFutureList();
+	std::lock_guard<std::mutex> lock(futureAccessStatsLock);
+	futureAccessStats = stats;
+}
 
+FutureAccessStatsUWP GetFutureAccessStats() {
+	std::lock_guard<std::mutex> lock(futureAccessStatsLock);
+	return futureAccessStats;
+}
+
+// Lookup list initialization
+// fast phase (known folders) runs once on the first caller thread,
+// slow phase (FutureAccessList restore) runs in background
+ReadyStateUWP fillListState;
+concurrency::task_completion_event<void> fillListReadyEvent;
+
+void AppendKnownFolders() {
 	// Append known folders
+	std::vector<IStorageItem> knownFolders;
 #if APPEND_APP_LOCALDATA_LOCATION
-	AddToAccessibleItems(ApplicationData::Current().LocalFolder());
-	AddToAccessibleItems(ApplicationData::Current().TemporaryFolder());
+	knownFolders.push_back(ApplicationData::Current().LocalFolder());
+	knownFolders.push_back(ApplicationData::Current().TemporaryFolder());
 #endif
 
 #if APPEND_APP_INSTALLATION_LOCATION
-	AddToAccessibleItems(Package::Current().InstalledLocation());
+	knownFolders.push_back(Package::Current().InstalledLocation());
 #endif
 
 #if APPEND_DOCUMENTS_LOCATION
 	// >>>>DOCUMENTS (requires 'documentsLibrary' capability)
-	AddToAccessibleItems(KnownFolders::DocumentsLibrary());
+	knownFolders.push_back(KnownFolders::DocumentsLibrary());
 #endif
 
 #if APPEND_VIDEOS_LOCATION
 	// >>>>VIDEOS (requires 'videosLibrary' capability)
-	AddToAccessibleItems(KnownFolders::VideosLibrary());
+	knownFolders.push_back(KnownFolders::VideosLibrary());
 #endif
 
 #if APPEND_PICTURES_LOCATION
 	// >>>>VIDEOS (requires 'picturesLibrary' capability)
-	AddToAccessibleItems(KnownFolders::PicturesLibrary());
+	knownFolders.push_back(KnownFolders::PicturesLibrary());
 #endif
 
 #if APPEND_MUSIC_LOCATION
 	// >>>>MUSIC (requires 'musicLibrary' capability)
-	AddToAccessibleItems(KnownFolders::MusicLibrary());
+	knownFolders.push_back(KnownFolders::MusicLibrary());
 #endif
+	AddToAccessibleItems(knownFolders);
 
 	// No need to append `RemovableDevices`
 	// they will be allowed for access once you added the capability
 
-	fillListInProgress = false;
+}
+
+void SetLookupListReady() {
+	// Warm entries are not needed anymore
+	WarmAccessItems.Publish(std::make_shared<WarmIndexUWP>());
+	fillListState.SetReady();
+	fillListReadyEvent.set();
+}
+
+void FillLookupList() {
+	// Should be called only once,
+	// other callers will wait here until the fast phase is done
+	fillListState.Start([]() {
+		AppendKnownFolders();
+		LoadWarmLookupList();
+#if DRIVE_ACCESS_SWEEP_ON_START
+		StartDriveAccessSweep();
+#endif
+
+		concurrency::create_task([]() {
+			try {
+				UpdateItemsByFutureList();
+			}
+			catch (...) {
+			}
+			SetLookupListReady();
+		});
+	});
+}
+
+bool IsLookupListReady() {
+	return fillListState.IsReady();
+}
+
+// UI thread keeps processing its events meanwhile (see 'WaitLookupListReady' in 'StorageAccess.h'),
+// the wait is bounded by the limits of the thread
+void WaitLookupListReady() {
+	FillLookupList();
+	if (IsLookupListReady()) {
+		return;
+	}
+
+	auto limits = CurrentStorageLimitsUWP();
+	StorageCallResultUWP state;
+	if (winrt::impl::is_sta_thread()) {
+		CoreWaitDispatcherUWP dispatcher;
+		state = fillListState.Wait(&dispatcher, limits);
+	}
+	else {
+		state = fillListState.Wait(nullptr, limits);
+	}
+	if (state != STORAGE_CALL_COMPLETED && limits != nullptr) {
+		limits->Stop(state);
+		SetStoppedError(state);
+	}
+}
+
+concurrency::task<void> GetLookupListReadyTask() {
+	FillLookupList();
+	return concurrency::create_task(fillListReadyEvent);
 }
@@ -9,6 +9,13 @@
 
 #include "StorageAsync.h"
 
+LatencyHistogramUWP BrokerLatency;
+
+LatencyHistogramUWP& GetBrokerLatency()
+{
+	return BrokerLatency;
+}
+
 bool ActionPass(winrt::Windows::Foundation::IAsyncAction action)
 {
 	try {
@@ -27,3 +34,37 @@ bool ExecuteTask(winrt::Windows::Foundation::IAsyncAction action)
 {
 	return ActionPass(action);
 };
+
+std::vector<BatchItemUWP<bool>> ExecuteActionBatch(size_t count, std::function<winrt::Windows::Foundation::IAsyncAction(size_t)> launch, size_t maxConcurrent)
+{
+	auto runner = std::make_shared<BatchRunnerUWP<bool>>(count, false);
+	runner->Start([launch](size_t index, std::shared_ptr<BatchRunnerUWP<bool>> runner) {
+		winrt::Windows::Foundation::IAsyncAction action{ nullptr };
+		try {
+			action = launch(index);
+		}
+		catch (const winrt::hresult_error& e) {
+			runner->Complete(index, false, false, e.code());
+			return;
+		}
+		if (action == nullptr) {
+			runner->Complete(index, false, false, 0);
+			return;
+		}
+		runner->Track(index, [action]() {
+			action.Cancel();
+		});
+		action.Completed([index, runner](auto&& sender, winrt::AsyncStatus status) {
+			int32_t error = E_ABORT;
+			if (status == winrt::AsyncStatus::Completed) {
+				error = 0;
+			}
+			else if (status == winrt::AsyncStatus::Error) {
+				error = sender.ErrorCode();
+			}
+			runner->Complete(index, error == 0, error == 0, error);
+		});
+	}, maxConcurrent);
+	WaitBatch(runner);
+	return runner->Results();
+}
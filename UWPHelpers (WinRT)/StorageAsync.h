@@ -25,8 +25,12 @@
 #include <winrt/Windows.UI.Input.h>
 #include <winrt/Windows.UI.ViewManagement.h>
 
+#include "StorageConfig.h"
 #include "StorageLog.h"
 #include "StorageExtensions.h"
+#include "StorageBatch.h"
+#include "StorageLimits.h"
+#include "StorageLatency.h"
 
 using namespace winrt::Windows::UI::Core;
 
@@ -38,11 +42,115 @@ namespace winrt
 	using namespace Windows::Foundation;
 }
 
+// UI thread dispatcher, pumped only while waiting on the thread that owns a CoreWindow
+class CoreWaitDispatcherUWP : public WaitDispatcherUWP
+{
+public:
+	CoreWaitDispatcherUWP()
+	{
+		try {
+			CoreWindow corewindow = CoreWindow::GetForCurrentThread();
+			if (corewindow) {
+				dispatcher = corewindow.Dispatcher();
+			}
+		}
+		catch (...) {
+		}
+	}
+
+	bool NeedsPumping() override
+	{
+		return dispatcher != nullptr;
+	}
+
+	bool ProcessEvents() override
+	{
+		try {
+			// Sleeps until there is an event ('Wake' posts one)
+			dispatcher.ProcessEvents(CoreProcessEventsOption::ProcessOneAndAllPending);
+			return true;
+		}
+		catch (...) {
+			return false;
+		}
+	}
+
+	void Wake() override
+	{
+		try {
+			dispatcher.RunAsync(CoreDispatcherPriority::Normal, []() {});
+		}
+		catch (...) {
+		}
+	}
+
+	void WakeAt(std::chrono::steady_clock::time_point time) override
+	{
+		auto delay = time - std::chrono::steady_clock::now();
+		winrt::TimeSpan span = delay.count() > 0 ? std::chrono::duration_cast<winrt::TimeSpan>(delay) : winrt::TimeSpan(0);
+		CoreDispatcher target = dispatcher;
+		try {
+			winrt::Windows::System::Threading::ThreadPoolTimer::CreateTimer([target](auto&&) {
+				target.RunAsync(CoreDispatcherPriority::Normal, []() {});
+			}, span);
+		}
+		catch (...) {
+		}
+	}
+
+private:
+	CoreDispatcher dispatcher{ nullptr };
+};
+
+// Broker waits of all threads
+LatencyHistogramUWP& GetBrokerLatency();
+
+// 'ERROR_TIMEOUT' or 'ERROR_CANCELLED', also set as last error
+inline DWORD SetStoppedError(StorageCallResultUWP state)
+{
+	DWORD error = (state == STORAGE_CALL_CANCELED) ? ERROR_CANCELLED : ERROR_TIMEOUT;
+	SetLastError(error);
+	return error;
+}
+
+// Stopped wait, the operation is canceled and the call fails like any broker error
+inline void ThrowStoppedWait(StorageCallResultUWP state)
+{
+	throw winrt::hresult_error(HRESULT_FROM_WIN32(SetStoppedError(state)));
+}
+
+// Wait within the limits of the calling thread ('StorageLimitScopeUWP')
+template <typename TAsync> inline
+void WaitLimited(const TAsync& asyncOp, StorageLimitsUWP* limits)
+{
+	LatencyScopeUWP latency(GetBrokerLatency());
+	auto state = limits->Check();
+	if (state == STORAGE_CALL_COMPLETED) {
+		auto signal = std::make_shared<WaitSignalUWP>();
+		asyncOp.Completed([signal](auto&&, auto&&) {
+			signal->Set();
+		});
+		state = signal->Wait(nullptr, limits);
+	}
+	if (state != STORAGE_CALL_COMPLETED) {
+		asyncOp.Cancel();
+		limits->Stop(state);
+		latency.SetResult(state);
+		ThrowStoppedWait(state);
+	}
+}
+
 inline void WaitTask(const winrt::IAsyncAction& asyncOp)
 {
 	if (asyncOp.Status() == winrt::AsyncStatus::Completed)
 		return;
 
+	if (auto limits = CurrentStorageLimitsUWP()) {
+		WaitLimited(asyncOp, limits);
+		return asyncOp.GetResults();
+	}
+
+	LatencyScopeUWP latency(GetBrokerLatency());
 	if (!winrt::impl::is_sta_thread())
 		return asyncOp.get();
 
@@ -59,6 +167,12 @@ TResult WaitTask(const winrt::IAsyncOperationWithProgress<TResult, TProgress>& a
 	if (asyncOp.Status() == winrt::AsyncStatus::Completed)
 		return asyncOp.GetResults();
 
+	if (auto limits = CurrentStorageLimitsUWP()) {
+		WaitLimited(asyncOp, limits);
+		return asyncOp.GetResults();
+	}
+
+	LatencyScopeUWP latency(GetBrokerLatency());
 	if (!winrt::impl::is_sta_thread())
 		return asyncOp.get();
 
@@ -77,6 +191,12 @@ TResult WaitTask(const winrt::IAsyncOperation<TResult>& asyncOp)
 	if (asyncOp.Status() == winrt::AsyncStatus::Completed)
 		return asyncOp.GetResults();
 
+	if (auto limits = CurrentStorageLimitsUWP()) {
+		WaitLimited(asyncOp, limits);
+		return asyncOp.GetResults();
+	}
+
+	LatencyScopeUWP latency(GetBrokerLatency());
 	if (!winrt::impl::is_sta_thread())
 		return asyncOp.get();
 
@@ -90,12 +210,29 @@ TResult WaitTask(const winrt::IAsyncOperation<TResult>& asyncOp)
 	return asyncOp.GetResults();
 }
 
+// Tasks can't be canceled from here, a stopped wait only stops waiting
 template <typename TResult> inline
 TResult WaitTask(const Concurrency::task<TResult>& asyncOp)
 {
 	if (asyncOp.is_done())
 		return asyncOp.get();
 
+	if (auto limits = CurrentStorageLimitsUWP()) {
+		LatencyScopeUWP latency(GetBrokerLatency());
+		auto signal = std::make_shared<WaitSignalUWP>();
+		asyncOp.then([signal](Concurrency::task<TResult>) {
+			signal->Set();
+		}, concurrency::task_continuation_context::use_arbitrary());
+		auto state = signal->Wait(nullptr, limits);
+		if (state != STORAGE_CALL_COMPLETED) {
+			limits->Stop(state);
+			latency.SetResult(state);
+			ThrowStoppedWait(state);
+		}
+		return asyncOp.get();
+	}
+
+	LatencyScopeUWP latency(GetBrokerLatency());
 	if (!winrt::impl::is_sta_thread()) // blocking suspend is allowed
 		return asyncOp.get();
 
@@ -155,3 +292,67 @@ void ExecuteTask(T& out, winrt::Windows::Foundation::IAsyncOperation<T> task, T
 // @action: async action
 // return false when action failed
 bool ExecuteTask(winrt::Windows::Foundation::IAsyncAction action);
+
+
+// Wait for batch within the limits of the calling thread
+template<typename T>
+void WaitBatch(std::shared_ptr<BatchRunnerUWP<T>> runner)
+{
+	auto limits = CurrentStorageLimitsUWP();
+	auto state = runner->Wait(nullptr, limits);
+	if (state != STORAGE_CALL_COMPLETED) {
+		if (limits != nullptr) {
+			limits->Stop(state);
+		}
+		SetStoppedError(state);
+	}
+}
+
+// Run 'count' async operations and wait once for all of them
+// @launch: starts the operation of index (nullptr to skip it)
+// @def: value of failed or skipped items
+// results keep the index order with their errors
+template<typename T>
+std::vector<BatchItemUWP<T>> ExecuteBatch(size_t count, std::function<winrt::Windows::Foundation::IAsyncOperation<T>(size_t)> launch, T def, size_t maxConcurrent = BATCH_MAX_CONCURRENT)
+{
+	auto runner = std::make_shared<BatchRunnerUWP<T>>(count, def);
+	runner->Start([launch, def](size_t index, std::shared_ptr<BatchRunnerUWP<T>> runner) {
+		winrt::Windows::Foundation::IAsyncOperation<T> operation{ nullptr };
+		try {
+			operation = launch(index);
+		}
+		catch (const winrt::hresult_error& e) {
+			runner->Complete(index, def, false, e.code());
+			return;
+		}
+		if (operation == nullptr) {
+			runner->Complete(index, def, false, 0);
+			return;
+		}
+		runner->Track(index, [operation]() {
+			operation.Cancel();
+		});
+		operation.Completed([index, runner, def](auto&& sender, winrt::AsyncStatus status) {
+			T value = def;
+			int32_t error = E_ABORT;
+			if (status == winrt::AsyncStatus::Completed) {
+				try {
+					value = sender.GetResults();
+					error = 0;
+				}
+				catch (const winrt::hresult_error& e) {
+					error = e.code();
+				}
+			}
+			else if (status == winrt::AsyncStatus::Error) {
+				error = sender.ErrorCode();
+			}
+			runner->Complete(index, value, error == 0, error);
+		});
+	}, maxConcurrent);
+	WaitBatch(runner);
+	return runner->Results();
+}
+
+// Same for actions ('Delete', 'Move'..etc), value is true for completed actions
+std::vector<BatchItemUWP<bool>> ExecuteActionBatch(size_t count, std::function<winrt::Windows::Foundation::IAsyncAction(size_t)> launch, size_t maxConcurrent = BATCH_MAX_CONCURRENT);
@@ -0,0 +1,151 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Batched async operations [Internal usage]
+// up to 'maxConcurrent' operations are in flight, the next one starts when any of them completes,
+// the caller waits once for all of them, results keep the launch order
+// a stopped wait (deadline, cancel) cancels operations in flight and skips the rest
+// see 'ExecuteBatch' in 'StorageAsync.h'
+
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <functional>
+
+#include "StorageWait.h"
+
+template<typename T>
+struct BatchItemUWP {
+	T value;
+	bool succeeded = false;
+	int32_t error = 0; // HRESULT of the failure (0 if the operation was skipped)
+};
+
+template<typename T>
+class BatchRunnerUWP : public std::enable_shared_from_this<BatchRunnerUWP<T>> {
+public:
+	// Starts the operation of 'index' (must not throw), 'Complete' must be called once for it (from any thread)
+	typedef std::function<void(size_t, std::shared_ptr<BatchRunnerUWP<T>>)> LaunchFunc;
+
+	// 'def' is copied because some types have no default value (WinRT classes)
+	BatchRunnerUWP(size_t count, T def) : items(count, BatchItemUWP<T>{ def, false, 0 }) {
+	}
+
+	void Start(LaunchFunc launchFunc, size_t maxConcurrent) {
+		{
+			std::lock_guard<std::mutex> lock(batchLock);
+			launch = launchFunc;
+			limit = maxConcurrent > 0 ? maxConcurrent : 1;
+		}
+		if (items.empty()) {
+			signal.Set();
+			return;
+		}
+		Pump();
+	}
+
+	// Optional, how to cancel the operation of 'index' while it's in flight
+	// call it before the completion handler is attached
+	void Track(size_t index, std::function<void()> cancel) {
+		bool canceled;
+		{
+			std::lock_guard<std::mutex> lock(batchLock);
+			canceled = stopped;
+			if (!canceled) {
+				cancels[index] = cancel;
+			}
+		}
+		if (canceled) {
+			cancel();
+		}
+	}
+
+	void Complete(size_t index, T value, bool succeeded, int32_t error) {
+		bool allDone;
+		{
+			std::lock_guard<std::mutex> lock(batchLock);
+			cancels.erase(index);
+			inFlight--;
+			if (stopped) {
+				return;
+			}
+			auto& item = items[index];
+			item.value = value;
+			item.succeeded = succeeded;
+			item.error = error;
+			allDone = ++completed == items.size();
+		}
+		if (allDone) {
+			signal.Set();
+		}
+		else {
+			Pump();
+		}
+	}
+
+	// Block until all operations completed or 'limits' stopped the batch, 'dispatcher' and 'limits' can be nullptr
+	StorageCallResultUWP Wait(WaitDispatcherUWP* dispatcher = nullptr, const StorageLimitsUWP* limits = nullptr) {
+		auto state = signal.Wait(dispatcher, limits);
+		if (state != STORAGE_CALL_COMPLETED) {
+			Stop();
+		}
+		return state;
+	}
+
+	// Call once after 'Wait', unfinished items of a stopped batch are reported as skipped
+	std::vector<BatchItemUWP<T>> Results() {
+		std::lock_guard<std::mutex> lock(batchLock);
+		return std::move(items);
+	}
+
+private:
+	// Late completions are ignored, so results are stable once 'Wait' returned
+	void Stop() {
+		std::unordered_map<size_t, std::function<void()>> pending;
+		{
+			std::lock_guard<std::mutex> lock(batchLock);
+			stopped = true;
+			pending.swap(cancels);
+		}
+		for (auto& cancel : pending) {
+			cancel.second();
+		}
+	}
+
+	// Launch while there is room, operations completing meanwhile only update the counters
+	// so launches never nest (operations may complete right away on the launching thread)
+	void Pump() {
+		std::unique_lock<std::mutex> lock(batchLock);
+		if (pumping) {
+			return;
+		}
+		pumping = true;
+		while (!stopped && inFlight < limit && next < items.size()) {
+			size_t index = next++;
+			inFlight++;
+			lock.unlock();
+			launch(index, this->shared_from_this());
+			lock.lock();
+		}
+		pumping = false;
+	}
+
+	std::vector<BatchItemUWP<T>> items;
+	LaunchFunc launch;
+	size_t limit = 1;
+	size_t next = 0;
+	size_t inFlight = 0;
+	size_t completed = 0;
+	bool pumping = false;
+	bool stopped = false;
+	std::unordered_map<size_t, std::function<void()>> cancels; // Operations in flight
+	std::mutex batchLock;
+	WaitSignalUWP signal;
+};
@@ -0,0 +1,667 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Path caches
+// keys are normalized paths (see 'PathUWP') folded by 'FoldCacheKey'
+// all caches are thread safe and size bounded
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <string_view>
+#include <functional>
+#include <unordered_map>
+
+#include "StoragePathCompare.h"
+
+struct CacheStatsUWP {
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+	uint64_t inserts = 0;
+	uint64_t invalidations = 0; // Entries removed by mutators
+	uint64_t expired = 0; // Entries removed by TTL
+	size_t size = 0;
+
+	double HitRate() const {
+		uint64_t total = hits + misses;
+		return total > 0 ? (double)hits / total : 0;
+	}
+};
+
+// ASCII case folding, non-ASCII bytes kept as is
+inline void FoldCacheKey(std::string& key) {
+	FoldCaseUWP(key);
+}
+
+// Check if 'key' is 'root' itself or anything below it
+inline bool IsCacheKeyInTree(const std::string& key, const std::string& root) {
+	if (key.size() < root.size() || key.compare(0, root.size(), root) != 0) {
+		return false;
+	}
+	if (key.size() == root.size() || root.empty()) {
+		return true;
+	}
+	char next = key[root.size()];
+	return next == '/' || next == '\\' || root.back() == '/' || root.back() == '\\';
+}
+
+// Least recently used cache
+// 'ttl' in milliseconds, 0 means entries never expire
+template<typename V>
+class LRUCacheUWP {
+public:
+	LRUCacheUWP(size_t capacity, uint32_t ttl = 0) : capacity(capacity > 0 ? capacity : 1), ttl(ttl) {
+	}
+
+	bool Get(const std::string& key, V& value) {
+		std::lock_guard<std::mutex> lock(cacheLock);
+		auto iter = index.find(key);
+		if (iter == index.end()) {
+			stats.misses++;
+			return false;
+		}
+		if (IsExpired(*iter->second)) {
+			entries.erase(iter->second);
+			index.erase(iter);
+			stats.expired++;
+			stats.misses++;
+			return false;
+		}
+		// Move to front (most recent)
+		entries.splice(entries.begin(), entries, iter->second);
+		value = iter->second->value;
+		stats.hits++;
+		return true;
+	}
+
+	void Put(const std::string& key, const V& value) {
+		std::lock_guard<std::mutex> lock(cacheLock);
+		auto iter = index.find(key);
+		if (iter != index.end()) {
+			iter->second->value = value;
+			iter->second->time = Clock::now();
+			entries.splice(entries.begin(), entries, iter->second);
+			return;
+		}
+		entries.push_front(Entry{ key, value, Clock::now() });
+		index[key] = entries.begin();
+		stats.inserts++;
+		while (entries.size() > capacity) {
+			index.erase(entries.back().key);
+			entries.pop_back();
+		}
+	}
+
+	bool Erase(const std::string& key) {
+		std::lock_guard<std::mutex> lock(cacheLock);
+		auto iter = index.find(key);
+		if (iter == index.end()) {
+			return false;
+		}
+		entries.erase(iter->second);
+		index.erase(iter);
+		stats.invalidations++;
+		return true;
+	}
+
+	// Erase 'root' and everything below it
+	size_t EraseTree(const std::string& root) {
+		std::lock_guard<std::mutex> lock(cacheLock);
+		size_t count = 0;
+		for (auto iter = entries.begin(); iter != entries.end();) {
+			if (IsCacheKeyInTree(iter->key, root)) {
+				index.erase(iter->key);
+				iter = entries.erase(iter);
+				count++;
+			}
+			else {
+				++iter;
+			}
+		}
+		stats.invalidations += count;
+		return count;
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(cacheLock);
+		stats.invalidations += entries.size();
+		entries.clear();
+		index.clear();
+	}
+
+	template<typename F>
+	void ForEachKey(F func) {
+		std::lock_guard<std::mutex> lock(cacheLock);
+		for (auto& entry : entries) {
+			func(entry.key);
+		}
+	}
+
+	CacheStatsUWP Stats() {
+		std::lock_guard<std::mutex> lock(cacheLock);
+		CacheStatsUWP result = stats;
+		result.size = entries.size();
+		return result;
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Entry {
+		std::string key;
+		V value;
+		Clock::time_point time;
+	};
+
+	bool IsExpired(const Entry& entry) const {
+		return ttl > 0 && Clock::now() - entry.time > std::chrono::milliseconds(ttl);
+	}
+
+	size_t capacity;
+	uint32_t ttl;
+	std::list<Entry> entries;
+	std::unordered_map<std::string, typename std::list<Entry>::iterator> index;
+	std::mutex cacheLock;
+	CacheStatsUWP stats;
+};
+
+// Small key/value cache split into shards (one lock per shard)
+// for values that are read from many threads and rarely written
+// 'ttl' in milliseconds, 0 means entries never expire
+template<typename V, size_t Shards = 16>
+class ShardedCacheUWP {
+public:
+	ShardedCacheUWP(uint32_t ttl = 0) : ttl(ttl) {
+	}
+
+	bool Get(const std::string& key, V& value) {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard.shardLock);
+		auto iter = shard.entries.find(key);
+		if (iter == shard.entries.end()) {
+			return false;
+		}
+		if (ttl > 0 && Clock::now() - iter->second.time > std::chrono::milliseconds(ttl)) {
+			shard.entries.erase(iter);
+			return false;
+		}
+		value = iter->second.value;
+		return true;
+	}
+
+	void Put(const std::string& key, const V& value) {
+		auto& shard = GetShard(key);
+		std::lock_guard<std::mutex> lock(shard.shardLock);
+		auto& entry = shard.entries[key];
+		entry.value = value;
+		entry.time = Clock::now();
+	}
+
+	void Clear() {
+		for (auto& shard : shards) {
+			std::lock_guard<std::mutex> lock(shard.shardLock);
+			shard.entries.clear();
+		}
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Entry {
+		V value;
+		Clock::time_point time;
+	};
+
+	struct Shard {
+		std::unordered_map<std::string, Entry> entries;
+		std::mutex shardLock;
+	};
+
+	Shard& GetShard(const std::string& key) {
+		return shards[std::hash<std::string>()(key) % Shards];
+	}
+
+	uint32_t ttl;
+	Shard shards[Shards];
+};
+
+// Paths known to be missing
+// bloom filter in front of exact LRU, most probes are for existing paths
+// and they will be answered by the filter without taking the lock,
+// second filter holds parent folders of missing paths so writes rarely scan the LRU
+class NegativeCacheUWP {
+public:
+	NegativeCacheUWP(size_t capacity, uint32_t ttl) : cache(capacity, ttl), capacity(capacity) {
+		ClearFilter();
+	}
+
+	bool IsMissing(const std::string& key) {
+		if (!MayContain(filter, key)) {
+			filtered++;
+			return false;
+		}
+		bool value;
+		return cache.Get(key, value);
+	}
+
+	void MarkMissing(const std::string& key) {
+		std::lock_guard<std::mutex> lock(writeLock);
+		AddToFilter(key);
+		cache.Put(key, true);
+		if (++filterInserts > capacity * 2) {
+			// Erased keys stay in the filter, rebuild it from the live entries
+			RebuildFilter();
+		}
+	}
+
+	// Path (or something below it) was created
+	// the LRU is scanned only when missing paths may be below 'key'
+	void Invalidate(const std::string& key) {
+		// Filters must not be rebuilt between the check and the erase
+		std::lock_guard<std::mutex> lock(writeLock);
+		if (key.empty() || MayContain(treeFilter, key)) {
+			cache.EraseTree(key);
+		}
+		else if (MayContain(filter, key)) {
+			cache.Erase(key);
+		}
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(writeLock);
+		cache.Clear();
+		ClearFilter();
+	}
+
+	// Filter answers are counted as misses
+	CacheStatsUWP Stats() {
+		CacheStatsUWP result = cache.Stats();
+		result.misses += filtered;
+		return result;
+	}
+
+private:
+	static const size_t FilterBits = 1 << 16;
+	static const size_t FilterWords = FilterBits / 64;
+
+	LRUCacheUWP<bool> cache;
+	size_t capacity;
+	std::atomic<uint64_t> filter[FilterWords]; // Missing paths
+	std::atomic<uint64_t> treeFilter[FilterWords]; // Their parent folders
+	std::atomic<size_t> filterInserts{ 0 };
+	std::atomic<uint64_t> filtered{ 0 };
+	std::mutex writeLock; // Mark, invalidate and rebuild, lookups don't take it
+
+	static uint64_t Hash(std::string_view key) {
+		// FNV-1a 64
+		uint64_t hash = 14695981039346656037ull;
+		for (auto c : key) {
+			hash ^= (uint8_t)c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	// 3 probes from one hash (double hashing)
+	template<typename F>
+	static void ForEachBit(std::string_view key, F func) {
+		uint64_t hash = Hash(key);
+		uint32_t h1 = (uint32_t)hash;
+		uint32_t h2 = (uint32_t)(hash >> 32) | 1;
+		for (uint32_t i = 0; i < 3; i++) {
+			func((h1 + i * h2) % FilterBits);
+		}
+	}
+
+	static bool MayContain(const std::atomic<uint64_t>* bits, std::string_view key) {
+		bool state = true;
+		ForEachBit(key, [&](size_t bit) {
+			if (!(bits[bit / 64].load(std::memory_order_relaxed) & (1ull << (bit % 64)))) {
+				state = false;
+			}
+		});
+		return state;
+	}
+
+	static void AddBits(std::atomic<uint64_t>* bits, std::string_view key) {
+		ForEachBit(key, [&](size_t bit) {
+			bits[bit / 64].fetch_or(1ull << (bit % 64), std::memory_order_relaxed);
+		});
+	}
+
+	// Parents are added with and without the trailing separator ('a/b' and 'a/b/'),
+	// 'Invalidate' gets either form
+	void AddToFilter(const std::string& key) {
+		AddBits(filter, key);
+		for (size_t i = 0; i < key.size(); i++) {
+			if (key[i] == '/' || key[i] == '\\') {
+				AddBits(treeFilter, std::string_view(key.data(), i));
+				AddBits(treeFilter, std::string_view(key.data(), i + 1));
+			}
+		}
+	}
+
+	void ClearFilter() {
+		for (size_t i = 0; i < FilterWords; i++) {
+			filter[i].store(0, std::memory_order_relaxed);
+			treeFilter[i].store(0, std::memory_order_relaxed);
+		}
+		filterInserts = 0;
+	}
+
+	// Called with 'writeLock' held
+	void RebuildFilter() {
+		ClearFilter();
+		// Keys are added back before the lookups can miss them for long,
+		// a missed key only costs one more API probe
+		cache.ForEachKey([&](const std::string& key) {
+			AddToFilter(key);
+			filterInserts++;
+		});
+	}
+};
+
+struct TierStatsUWP {
+	uint64_t apiAttempts = 0; // Direct API tried first
+	uint64_t apiSkipped = 0; // Direct API skipped, went straight to fallback
+	uint64_t reprobes = 0; // Direct API retried on fallback roots
+	uint64_t switches = 0; // Roots switched to fallback
+	size_t roots = 0;
+};
+
+enum TierResultUWP {
+	TIER_RESULT_SUCCESS,
+	TIER_RESULT_NOT_FOUND, // Tier works, the item doesn't exist
+	TIER_RESULT_FAILED, // Tier couldn't reach the item
+};
+
+// Learned access tier per root (picked folder or volume)
+// a root switches to fallback once the API failed and the fallback worked there
+// 'failures' times in a row (one bad call says little about the root),
+// API will be tried again every 'reprobe' milliseconds or after fallback failure,
+// missing items say nothing about the tier and keep the learned one
+class TierStrategyUWP {
+public:
+	TierStrategyUWP(size_t capacity, uint32_t reprobe, uint32_t failures) : capacity(capacity > 0 ? capacity : 1), reprobe(reprobe), failures(failures > 0 ? failures : 1) {
+	}
+
+	// Empty root means API is always the right tier
+	bool ShouldTryAPI(const std::string& root) {
+		if (root.empty()) {
+			return true;
+		}
+		std::lock_guard<std::mutex> lock(strategyLock);
+		auto iter = roots.find(root);
+		if (iter == roots.end() || !iter->second.preferFallback) {
+			stats.apiAttempts++;
+			return true;
+		}
+		auto now = Clock::now();
+		if (now >= iter->second.nextProbe) {
+			iter->second.nextProbe = now + std::chrono::milliseconds(reprobe);
+			stats.reprobes++;
+			stats.apiAttempts++;
+			return true;
+		}
+		stats.apiSkipped++;
+		return false;
+	}
+
+	void ReportAPI(const std::string& root, bool success) {
+		if (root.empty() || !success) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(strategyLock);
+		auto iter = roots.find(root);
+		if (iter != roots.end()) {
+			iter->second.preferFallback = false;
+			iter->second.failures = 0;
+		}
+	}
+
+	void ReportFallback(const std::string& root, bool apiTried, TierResultUWP result) {
+		if (root.empty() || result == TIER_RESULT_NOT_FOUND) {
+			return;
+		}
+		std::lock_guard<std::mutex> lock(strategyLock);
+		if (apiTried && result == TIER_RESULT_SUCCESS) {
+			if (roots.size() >= capacity && roots.find(root) == roots.end()) {
+				EvictOne();
+			}
+			auto& state = roots[root];
+			if (!state.preferFallback) {
+				if (++state.failures < failures) {
+					return;
+				}
+				state.preferFallback = true;
+				stats.switches++;
+			}
+			state.nextProbe = Clock::now() + std::chrono::milliseconds(reprobe);
+		}
+		else if (!apiTried && result == TIER_RESULT_FAILED) {
+			// Fallback didn't help, let API decide next time
+			auto iter = roots.find(root);
+			if (iter != roots.end()) {
+				iter->second.preferFallback = false;
+				iter->second.failures = 0;
+			}
+		}
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(strategyLock);
+		roots.clear();
+	}
+
+	TierStatsUWP Stats() {
+		std::lock_guard<std::mutex> lock(strategyLock);
+		TierStatsUWP result = stats;
+		result.roots = roots.size();
+		return result;
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct State {
+		bool preferFallback = false;
+		uint32_t failures = 0; // API failures with fallback success in a row
+		Clock::time_point nextProbe;
+	};
+
+	// Roots back on API go first, otherwise the one probed longest ago
+	void EvictOne() {
+		auto victim = roots.begin();
+		for (auto iter = roots.begin(); iter != roots.end(); ++iter) {
+			if (!iter->second.preferFallback) {
+				victim = iter;
+				break;
+			}
+			if (iter->second.nextProbe < victim->second.nextProbe) {
+				victim = iter;
+			}
+		}
+		if (victim != roots.end()) {
+			roots.erase(victim);
+		}
+	}
+
+	size_t capacity;
+	uint32_t reprobe;
+	uint32_t failures;
+	std::unordered_map<std::string, State> roots;
+	std::mutex strategyLock;
+	TierStatsUWP stats;
+};
+
+// Real names per folder for case-insensitive requests ('ABC.PNG' -> 'abc.png')
+// folder keys are cache keys, names are folded with 'FoldCaseUWP'
+// folders are evicted by LRU and expire after 'ttl' (changes made outside storage manager),
+// folders with more than 'maxNames' items are kept without names (lookups give back the requested name)
+class NameIndexUWP {
+public:
+	NameIndexUWP(size_t capacity, size_t maxNames, uint32_t ttl = 0) : capacity(capacity > 0 ? capacity : 1), maxNames(maxNames), ttl(ttl) {
+	}
+
+	// False if the folder is not indexed yet,
+	// otherwise 'realName' is the name on disk or empty if there is no such name
+	// folders too big to index will give back the requested name as is
+	bool Lookup(const std::string& folder, std::string_view name, std::string& realName) {
+		std::string key(name);
+		FoldCaseUWP(key);
+
+		std::lock_guard<std::mutex> lock(indexLock);
+		auto iter = index.find(folder);
+		if (iter == index.end()) {
+			stats.misses++;
+			return false;
+		}
+		if (IsExpired(*iter->second)) {
+			entries.erase(iter->second);
+			index.erase(iter);
+			stats.expired++;
+			stats.misses++;
+			return false;
+		}
+		entries.splice(entries.begin(), entries, iter->second);
+		stats.hits++;
+
+		if (!iter->second->complete) {
+			realName.assign(name);
+			return true;
+		}
+		auto& names = iter->second->names;
+		auto found = names.find(key);
+		if (found != names.end()) {
+			realName = found->second;
+		}
+		else {
+			realName.clear();
+		}
+		return true;
+	}
+
+	// Replace folder names with a fresh listing
+	void Build(const std::string& folder, const std::vector<std::string>& names) {
+		Entry entry{ folder, {}, Clock::now(), names.size() <= maxNames };
+		if (entry.complete) {
+			entry.names.reserve(names.size());
+			for (auto& name : names) {
+				std::string key = name;
+				FoldCaseUWP(key);
+				entry.names.emplace(std::move(key), name);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(indexLock);
+		auto iter = index.find(folder);
+		if (iter != index.end()) {
+			entries.erase(iter->second);
+			index.erase(iter);
+		}
+		entries.push_front(std::move(entry));
+		index[folder] = entries.begin();
+		stats.inserts++;
+		while (entries.size() > capacity) {
+			index.erase(entries.back().folder);
+			entries.pop_back();
+		}
+	}
+
+	// Item created through storage manager (ignored if folder is not indexed)
+	void AddName(const std::string& folder, std::string_view name) {
+		std::string key(name);
+		FoldCaseUWP(key);
+
+		std::lock_guard<std::mutex> lock(indexLock);
+		auto iter = index.find(folder);
+		if (iter == index.end() || !iter->second->complete) {
+			return;
+		}
+		auto& entry = *iter->second;
+		if (entry.names.size() >= maxNames && entry.names.find(key) == entry.names.end()) {
+			// Too big now, keep it bounded
+			entry.names.clear();
+			entry.complete = false;
+			stats.invalidations++;
+			return;
+		}
+		entry.names[key] = std::string(name);
+	}
+
+	// Item removed through storage manager
+	void RemoveName(const std::string& folder, std::string_view name) {
+		std::string key(name);
+		FoldCaseUWP(key);
+
+		std::lock_guard<std::mutex> lock(indexLock);
+		auto iter = index.find(folder);
+		if (iter != index.end()) {
+			iter->second->names.erase(key);
+		}
+	}
+
+	// Erase 'root' and every folder below it
+	size_t EraseTree(const std::string& root) {
+		std::lock_guard<std::mutex> lock(indexLock);
+		size_t count = 0;
+		for (auto iter = entries.begin(); iter != entries.end();) {
+			if (IsCacheKeyInTree(iter->folder, root)) {
+				index.erase(iter->folder);
+				iter = entries.erase(iter);
+				count++;
+			}
+			else {
+				++iter;
+			}
+		}
+		stats.invalidations += count;
+		return count;
+	}
+
+	void Clear() {
+		std::lock_guard<std::mutex> lock(indexLock);
+		stats.invalidations += entries.size();
+		entries.clear();
+		index.clear();
+	}
+
+	// 'size' is the number of indexed folders
+	CacheStatsUWP Stats() {
+		std::lock_guard<std::mutex> lock(indexLock);
+		CacheStatsUWP result = stats;
+		result.size = entries.size();
+		return result;
+	}
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Entry {
+		std::string folder;
+		std::unordered_map<std::string, std::string> names; // Folded -> real
+		Clock::time_point time;
+		bool complete; // False when the folder is too big to index
+	};
+
+	bool IsExpired(const Entry& entry) const {
+		return ttl > 0 && Clock::now() - entry.time > std::chrono::milliseconds(ttl);
+	}
+
+	size_t capacity;
+	size_t maxNames;
+	uint32_t ttl;
+	std::list<Entry> entries;
+	std::unordered_map<std::string, std::list<Entry>::iterator> index;
+	std::mutex indexLock;
+	CacheStatsUWP stats;
+};
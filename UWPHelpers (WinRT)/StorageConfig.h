@@ -17,6 +17,65 @@
 #define APPEND_MUSIC_LOCATION 0 // (requires musicLibrary' capability)
 #define APPEND_PICTURES_LOCATION 0 // (requires 'picturesLibrary' capability)
 
+// Picked items restore
+// how many FutureAccessList tokens are resolved at once on startup
+#define FUTURE_ACCESS_RESOLVE_WORKERS 8
+
+// Warm start
+// picked items are saved to LocalState, next launch can classify paths right away
+#define LOOKUP_SNAPSHOT_ENABLED 1
+#define LOOKUP_SNAPSHOT_FILE L"UWPLookupList.bin"
+#define LOOKUP_SNAPSHOT_MAX_AGE (30 * 24 * 60 * 60) // Seconds, older snapshot will be ignored
+
+// Missing paths cache
+// repeated probes for missing files will end without API/broker calls,
+// paths created through storage manager are removed from the cache right away
+#define NEGATIVE_CACHE_ENABLED 1
+#define NEGATIVE_CACHE_SIZE 4096 // Max missing paths to remember
+#define NEGATIVE_CACHE_TTL 5000 // Milliseconds, for changes made outside storage manager
+
+// Resolved items cache
+// reopening the same file will not repeat the lookup/broker resolution
+#define RESOLVED_CACHE_ENABLED 1
+#define RESOLVED_CACHE_SIZE 512 // Max items to keep
+#define RESOLVED_CACHE_TTL 30000 // Milliseconds, for changes made outside storage manager
+
+// Access tier strategy
+// roots (picked folders, volumes) where direct API always fails will go straight to UWP fallback
+#define TIER_STRATEGY_ENABLED 1
+#define TIER_STRATEGY_SIZE 256 // Max roots to remember
+#define TIER_STRATEGY_REPROBE 60000 // Milliseconds, try direct API again after
+#define TIER_STRATEGY_FAILURES 3 // API failures (with fallback success) in a row before switching
+
+// Drive access probing
+#define DRIVE_ACCESS_TTL 60000 // Milliseconds, probe the drive again after
+#define DRIVE_ACCESS_PROBE_NO_TEST_FILE 1 // Check write access by opening the drive root (no test file)
+#define DRIVE_ACCESS_SWEEP_ON_START 1 // Probe all drives in background while the lookup list is filling
+
+// Case-insensitive name index
+// requests with different case ('ABC.PNG' for 'abc.png') are mapped to the real names,
+// each folder is listed once after a miss and kept in sync with changes made through storage manager
+#define NAME_INDEX_ENABLED 1
+#define NAME_INDEX_SIZE 128 // Max folders to keep
+#define NAME_INDEX_MAX_NAMES 8192 // Folders with more items are not indexed
+#define NAME_INDEX_TTL 30000 // Milliseconds, for changes made outside storage manager
+#define NAME_INDEX_MAX_LISTINGS 1 // Folders listed per request, a missing item costs one listing at most
+
+// Batched broker calls
+// fallbacks with many items (folder copy, candidate lookups) run this many operations at once
+#define BATCH_MAX_CONCURRENT 8
+
+// I/O executor
+// async versions run on these workers with priority lanes (interactive, normal, background)
+#define IO_EXECUTOR_WORKERS 3 // Normal and background lanes leave one of them for interactive requests
+#define IO_EXECUTOR_BACKGROUND_WORKERS 1 // Max deep scans, copies..etc at once
+#define IO_EXECUTOR_YIELD_MAX 100 // Milliseconds, longest pause of background work for interactive requests
+
+// Mount table
+// virtual roots ('/roms') routed to real locations, see 'MountUWP' in 'StorageManager.h'
+#define MOUNT_TABLE_PERSIST 1 // Keep mount points in LocalSettings
+#define MOUNT_TABLE_SETTINGS_KEY "storage_mounts"
+
 // To force legacy APIs, define `UWP_LEGACY` (using header or project settings which is better)
 //#define UWP_LEGACY 1
 
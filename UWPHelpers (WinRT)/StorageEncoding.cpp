@@ -0,0 +1,288 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+#include "StorageEncoding.h"
+
+#include <cstdint>
+#include <cwchar>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define ENCODING_SSE2 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define ENCODING_NEON 1
+#endif
+
+#define REPLACEMENT_CHAR 0xFFFD
+
+#pragma region ASCII
+// Widen leading ASCII bytes, return how many were converted
+template<typename T>
+static size_t WidenASCII(const uint8_t* input, size_t size, T* output) {
+	size_t i = 0;
+	if (sizeof(T) == 2) {
+		uint16_t* out = (uint16_t*)output;
+#if ENCODING_SSE2
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= size; i += 16) {
+			__m128i v = _mm_loadu_si128((const __m128i*)(input + i));
+			if (_mm_movemask_epi8(v) != 0) {
+				break;
+			}
+			_mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi8(v, zero));
+			_mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpackhi_epi8(v, zero));
+		}
+#elif ENCODING_NEON
+		for (; i + 16 <= size; i += 16) {
+			uint8x16_t v = vld1q_u8(input + i);
+			if (vmaxvq_u8(v) >= 0x80) {
+				break;
+			}
+			vst1q_u16(out + i, vmovl_u8(vget_low_u8(v)));
+			vst1q_u16(out + i + 8, vmovl_u8(vget_high_u8(v)));
+		}
+#endif
+	}
+	for (; i < size && input[i] < 0x80; i++) {
+		output[i] = (T)input[i];
+	}
+	return i;
+}
+
+// Narrow leading ASCII units, return how many were converted
+template<typename T>
+static size_t NarrowASCII(const T* input, size_t size, uint8_t* output) {
+	size_t i = 0;
+	if (sizeof(T) == 2) {
+		const uint16_t* in = (const uint16_t*)input;
+#if ENCODING_SSE2
+		const __m128i nonASCII = _mm_set1_epi16((short)0xFF80);
+		const __m128i zero = _mm_setzero_si128();
+		for (; i + 16 <= size; i += 16) {
+			__m128i a = _mm_loadu_si128((const __m128i*)(in + i));
+			__m128i b = _mm_loadu_si128((const __m128i*)(in + i + 8));
+			__m128i test = _mm_and_si128(_mm_or_si128(a, b), nonASCII);
+			if (_mm_movemask_epi8(_mm_cmpeq_epi16(test, zero)) != 0xFFFF) {
+				break;
+			}
+			_mm_storeu_si128((__m128i*)(output + i), _mm_packus_epi16(a, b));
+		}
+#elif ENCODING_NEON
+		for (; i + 16 <= size; i += 16) {
+			uint16x8_t a = vld1q_u16(in + i);
+			uint16x8_t b = vld1q_u16(in + i + 8);
+			if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) {
+				break;
+			}
+			vst1q_u8(output + i, vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+		}
+#endif
+	}
+	for (; i < size && (uint32_t)input[i] < 0x80; i++) {
+		output[i] = (uint8_t)input[i];
+	}
+	return i;
+}
+#pragma endregion
+
+#pragma region Decode
+// Decode one code point starting at 'i' (non-ASCII lead)
+// invalid sequence returns REPLACEMENT_CHAR and consumes the maximal subpart (at least one byte)
+static uint32_t DecodeUTF8(const uint8_t* input, size_t size, size_t& i) {
+	uint8_t lead = input[i++];
+	size_t needed;
+	uint32_t codePoint;
+	uint8_t lower = 0x80;
+	uint8_t upper = 0xBF;
+
+	if (lead >= 0xC2 && lead <= 0xDF) {
+		needed = 1;
+		codePoint = lead & 0x1F;
+	}
+	else if (lead >= 0xE0 && lead <= 0xEF) {
+		needed = 2;
+		codePoint = lead & 0x0F;
+		if (lead == 0xE0) {
+			lower = 0xA0; // Overlong
+		}
+		else if (lead == 0xED) {
+			upper = 0x9F; // Surrogates
+		}
+	}
+	else if (lead >= 0xF0 && lead <= 0xF4) {
+		needed = 3;
+		codePoint = lead & 0x07;
+		if (lead == 0xF0) {
+			lower = 0x90; // Overlong
+		}
+		else if (lead == 0xF4) {
+			upper = 0x8F; // Above U+10FFFF
+		}
+	}
+	else {
+		return REPLACEMENT_CHAR;
+	}
+
+	for (size_t n = 0; n < needed; n++) {
+		if (i >= size || input[i] < lower || input[i] > upper) {
+			return REPLACEMENT_CHAR;
+		}
+		codePoint = (codePoint << 6) | (input[i] & 0x3F);
+		lower = 0x80;
+		upper = 0xBF;
+		i++;
+	}
+	return codePoint;
+}
+
+// Decode one code point from UTF-16, unpaired surrogate returns REPLACEMENT_CHAR
+template<typename T>
+static uint32_t DecodeUTF16(const T* input, size_t size, size_t& i) {
+	uint32_t unit = (uint32_t)input[i++];
+	if (unit < 0xD800 || unit > 0xDFFF) {
+		return unit;
+	}
+	if (unit <= 0xDBFF && i < size) {
+		uint32_t next = (uint32_t)input[i];
+		if (next >= 0xDC00 && next <= 0xDFFF) {
+			i++;
+			return 0x10000 + ((unit - 0xD800) << 10) + (next - 0xDC00);
+		}
+	}
+	return REPLACEMENT_CHAR;
+}
+#pragma endregion
+
+#pragma region Convert
+template<typename T>
+static size_t UTF8ToUTF16(std::string_view input, T* output) {
+	const uint8_t* in = (const uint8_t*)input.data();
+	size_t size = input.size();
+	size_t i = 0;
+	size_t written = 0;
+	while (i < size) {
+		size_t ascii = WidenASCII(in + i, size - i, output + written);
+		i += ascii;
+		written += ascii;
+		if (i >= size) {
+			break;
+		}
+
+		uint32_t codePoint = DecodeUTF8(in, size, i);
+		if (codePoint >= 0x10000) {
+			codePoint -= 0x10000;
+			output[written++] = (T)(0xD800 + (codePoint >> 10));
+			output[written++] = (T)(0xDC00 + (codePoint & 0x3FF));
+		}
+		else {
+			output[written++] = (T)codePoint;
+		}
+	}
+	return written;
+}
+
+template<typename T>
+static size_t UTF16ToUTF8(const T* in, size_t size, char* output) {
+	uint8_t* out = (uint8_t*)output;
+	size_t i = 0;
+	size_t written = 0;
+	while (i < size) {
+		size_t ascii = NarrowASCII(in + i, size - i, out + written);
+		i += ascii;
+		written += ascii;
+		if (i >= size) {
+			break;
+		}
+
+		uint32_t codePoint = DecodeUTF16(in, size, i);
+		if (codePoint < 0x800) {
+			out[written++] = (uint8_t)(0xC0 | (codePoint >> 6));
+			out[written++] = (uint8_t)(0x80 | (codePoint & 0x3F));
+		}
+		else if (codePoint < 0x10000) {
+			out[written++] = (uint8_t)(0xE0 | (codePoint >> 12));
+			out[written++] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+			out[written++] = (uint8_t)(0x80 | (codePoint & 0x3F));
+		}
+		else {
+			out[written++] = (uint8_t)(0xF0 | (codePoint >> 18));
+			out[written++] = (uint8_t)(0x80 | ((codePoint >> 12) & 0x3F));
+			out[written++] = (uint8_t)(0x80 | ((codePoint >> 6) & 0x3F));
+			out[written++] = (uint8_t)(0x80 | (codePoint & 0x3F));
+		}
+	}
+	return written;
+}
+
+size_t UTF8ToUTF16UWP(std::string_view input, wchar_t* output) {
+	return UTF8ToUTF16(input, output);
+}
+
+size_t UTF8ToUTF16UWP(std::string_view input, char16_t* output) {
+	return UTF8ToUTF16(input, output);
+}
+
+size_t UTF16ToUTF8UWP(std::wstring_view input, char* output) {
+	return UTF16ToUTF8(input.data(), input.size(), output);
+}
+
+size_t UTF16ToUTF8UWP(std::u16string_view input, char* output) {
+	return UTF16ToUTF8(input.data(), input.size(), output);
+}
+#pragma endregion
+
+#pragma region Validate
+bool IsValidUTF8UWP(std::string_view input) {
+	const uint8_t* in = (const uint8_t*)input.data();
+	size_t size = input.size();
+	size_t i = 0;
+	while (i < size) {
+		if (in[i] < 0x80) {
+			i++;
+			continue;
+		}
+		size_t start = i;
+		uint32_t codePoint = DecodeUTF8(in, size, i);
+		// Real U+FFFD is 3 bytes, replacement for invalid input is not
+		if (codePoint == REPLACEMENT_CHAR && (i - start != 3 || in[start] != 0xEF)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool IsValidUTF16UWP(std::wstring_view input) {
+	size_t i = 0;
+	while (i < input.size()) {
+		uint32_t unit = (uint32_t)input[i];
+		uint32_t codePoint = DecodeUTF16(input.data(), input.size(), i);
+		if (codePoint == REPLACEMENT_CHAR && unit != REPLACEMENT_CHAR) {
+			return false;
+		}
+	}
+	return true;
+}
+#pragma endregion
+
+#pragma region Owned
+WideStringUWP UTF8ToWideStringUWP(std::string_view input) {
+	WideStringUWP output;
+	wchar_t* buffer = output.Reserve(GetUTF16CapacityUWP(input.size()));
+	output.SetSize(UTF8ToUTF16UWP(input, buffer));
+	return output;
+}
+
+void UTF8ToWideUWP(std::string_view input, std::wstring& output) {
+	output.resize(GetUTF16CapacityUWP(input.size()));
+	output.resize(UTF8ToUTF16UWP(input, &output[0]));
+}
+
+void WideToUTF8UWP(std::wstring_view input, std::string& output) {
+	output.resize(GetUTF8CapacityUWP(input.size()));
+	output.resize(UTF16ToUTF8UWP(input, &output[0]));
+}
+#pragma endregion
@@ -0,0 +1,118 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Storage I/O executor with priority lanes
+// few worker threads owned by storage manager, queued jobs are picked by lane priority:
+// interactive (stat, open for visible UI) -> normal (game loads) -> background (deep scans, copies, cleanup)
+// background lane is limited to few workers and its jobs pause at 'Yield' while interactive work is pending,
+// normal and background lanes together never take the last worker, it's kept for interactive requests
+
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <type_traits>
+#include <condition_variable>
+
+#include "StorageLatency.h"
+#include "StorageLimits.h"
+
+enum StorageLaneUWP {
+	STORAGE_LANE_INTERACTIVE,
+	STORAGE_LANE_NORMAL,
+	STORAGE_LANE_BACKGROUND,
+	STORAGE_LANES,
+};
+
+struct LaneStatsUWP {
+	size_t queued = 0; // Waiting jobs (queue depth)
+	size_t running = 0;
+	uint64_t completed = 0;
+	LatencyStatsUWP wait; // Queued time (microseconds)
+	LatencyStatsUWP total; // Queued + running time (microseconds)
+};
+
+class StorageExecutorUWP {
+public:
+	// Threads are started with the first job, a single worker can't keep one for interactive requests
+	// 'backgroundWorkers' is the max background jobs at once
+	// 'yieldMax' in milliseconds, longest pause of a yielding background job
+	StorageExecutorUWP(size_t workers, size_t backgroundWorkers, uint32_t yieldMax);
+	// Queued jobs are dropped, running ones are joined
+	~StorageExecutorUWP();
+
+	StorageExecutorUWP(const StorageExecutorUWP&) = delete;
+	StorageExecutorUWP& operator=(const StorageExecutorUWP&) = delete;
+
+	// Jobs must not wait for other jobs of the same executor (they may be queued behind them)
+	void Post(StorageLaneUWP lane, std::function<void()> job);
+
+	// Called by long jobs between steps, background jobs pause while interactive jobs are queued or running
+	// does nothing for other lanes and outside executor threads
+	void Yield();
+
+	LaneStatsUWP Stats(StorageLaneUWP lane);
+
+	// Waiting jobs of all lanes
+	size_t QueueDepth();
+
+private:
+	struct Job {
+		std::function<void()> work;
+		std::chrono::steady_clock::time_point posted;
+	};
+
+	struct Lane {
+		std::deque<Job> queue;
+		size_t running = 0;
+		size_t limit = 1; // Max running jobs
+		uint64_t completed = 0;
+		LatencyHistogramUWP wait;
+		LatencyHistogramUWP total;
+	};
+
+	bool CanRun(size_t index) const;
+	bool HasRunnable() const;
+	void Work();
+
+	std::mutex executorLock;
+	std::condition_variable jobsCondition; // Idle workers
+	std::condition_variable interactiveCondition; // Yielding background jobs
+	Lane lanes[STORAGE_LANES];
+	std::vector<std::thread> threads;
+	size_t workers;
+	size_t sharedLimit = 1; // Max normal + background jobs at once
+	uint32_t yieldMax;
+	bool stopping = false;
+};
+
+// Post 'work' to 'lane', its result (or exception) goes to 'completion'
+// ('concurrency::task_completion_event' or anything with the same 'set' and 'set_exception'),
+// limits of the calling thread ('StorageLimitScopeUWP') apply to the job
+template<typename T, typename Completion>
+void PostWithLimitsUWP(StorageExecutorUWP& executor, StorageLaneUWP lane, std::function<T()> work, Completion completion) {
+	executor.Post(lane, [work = std::move(work), completion, limits = CaptureStorageLimitsUWP()]() {
+		StorageLimitScopeUWP scope(limits);
+		try {
+			if constexpr (std::is_void<T>::value) {
+				work();
+				completion.set();
+			}
+			else {
+				completion.set(work());
+			}
+		}
+		catch (...) {
+			completion.set_exception(std::current_exception());
+		}
+	});
+}
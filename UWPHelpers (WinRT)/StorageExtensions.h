@@ -8,12 +8,15 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <list>
 #include <wtypes.h>
 
 #include <winrt/base.h>
 
+#include "StorageEncoding.h"
+
 typedef struct {
 	DWORD dwDesiredAccess;
 	DWORD dwShareMode;
@@ -27,24 +30,24 @@ typedef struct {
 bool replace(std::string& str, const std::string& from, const std::string& to);
 std::string replace2(const std::string str, const std::string& from, const std::string& to);
 std::vector<std::string> split(const std::string s, char seperator);
-// Parent full path, child full path
-bool isChild(std::string parent, std::string child);
+// Parent full path, child full path (child is the parent itself or anything below it)
+bool isChild(std::string_view parent, std::string_view child);
 // Parent full path, child full path, child name only
-bool isParent(std::string parent, std::string child, std::string childName);
+bool isParent(std::string_view parent, std::string_view child, std::string_view childName);
 
 bool iequals(const std::string a, const std::string b);
 bool equals(const std::string a, const std::string b);
 bool ends_with(std::string const& value, std::string const& ending);
 bool starts_with(std::string str, std::string prefix);
 
-winrt::hstring convert(const std::string input);
-std::wstring convertToWString(const std::string input);
-std::string convert(winrt::hstring input);
-std::string convert(std::wstring input);
+winrt::hstring convert(const std::string& input);
+std::wstring convertToWString(const std::string& input);
+std::string convert(const winrt::hstring& input);
+std::string convert(const std::wstring& input);
 std::string convert(const char* input);
-LPCWSTR convertToLPCWSTR(std::string input);
-LPCWSTR convertToLPCWSTR(winrt::hstring input);
-const char* convertToChar(winrt::hstring input);
+WideStringUWP convertToLPCWSTR(const std::string& input);
+LPCWSTR convertToLPCWSTR(const winrt::hstring& input);
+const char* convertToChar(const winrt::hstring& input);
 
 void tolower(std::string& input);
 void tolower(winrt::hstring& input);
@@ -11,6 +11,7 @@
 
 #include "StorageLog.h"
 #include "StoragePath.h"
+#include "StoragePathCompare.h"
 #include "StorageExtensions.h"
 #include "StorageHandler.h"
 #include "StorageAsync.h"
@@ -52,7 +53,7 @@ public:
 	~StorageItemW() {
 	}
 
-	bool IsDirectory() {
+	bool IsDirectory() const {
 		return isDirectory;
 	}
 
@@ -156,11 +157,7 @@ public:
 
 	// Compare item with std::string
 	bool Equal(std::string path) {
-		std::string itemPath = GetPath();
-
-		// Fix slashs back from '/' to '\'
-		windowsPath(path);
-		return iequals(itemPath, path);
+		return PathEqualsUWP(GetPath(), path);
 	}
 
 	// Compare item with winrt::hstring
@@ -252,6 +249,11 @@ public:
 		return storageFolderW.Contains(path, storageItem);
 	}
 
+	// Lookup operation for batched calls (folders only)
+	winrt::Windows::Foundation::IAsyncOperation<IStorageItem> ContainsAsync(PathUWP path) {
+		return storageFolderW.ContainsAsync(path);
+	}
+
 	// Get all sub folders (deep scan)
 	std::list<StorageFolderW> GetAllFolders(bool useWindowsIndexer = false) {
 		return storageFolderW.GetAllFolders(useWindowsIndexer);
@@ -270,6 +272,10 @@ public:
 		return storageFolderW.GetFiles();
 	}
 
+	std::vector<std::string> GetItemNames(uint32_t maxCount = 0) {
+		return storageFolderW.GetItemNames(maxCount);
+	}
+
 	// Get item properties
 	FILE_BASIC_INFO* GetProperties() {
 		if (IsDirectory()) {
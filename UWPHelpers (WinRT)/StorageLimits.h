@@ -0,0 +1,198 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Deadlines and cancellation for storage calls
+// limits apply to the calling thread while 'StorageLimitScopeUWP' is alive,
+// so any storage function can be bounded without changing its signature:
+//
+//	auto token = std::make_shared<CancelTokenUWP>();
+//	StorageLimitScopeUWP limits(500, token); // 500ms
+//	FILE* file = GetFileStream(path, "rb");
+//	if (file == nullptr && limits.TimedOut()) { ... }
+//
+// stopped broker operations are canceled, the call fails as usual
+// and the scope reports why ('GetLastError' is 'ERROR_TIMEOUT' or 'ERROR_CANCELLED' too)
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+enum StorageCallResultUWP {
+	STORAGE_CALL_COMPLETED,
+	STORAGE_CALL_TIMEOUT,
+	STORAGE_CALL_CANCELED,
+};
+
+// Blocked wait that must return once the token is canceled
+class CancelTargetUWP {
+public:
+	virtual ~CancelTargetUWP() {
+	}
+
+	virtual void Interrupt() = 0;
+};
+
+// Can be shared with other threads (UI button, watchdog), canceled once
+class CancelTokenUWP {
+public:
+	void Cancel() {
+		std::lock_guard<std::mutex> lock(tokenLock);
+		canceled = true;
+		for (auto target : targets) {
+			target->Interrupt();
+		}
+	}
+
+	bool IsCanceled() const {
+		return canceled;
+	}
+
+	// Waiting side, target must be removed before it's destroyed
+	void Add(CancelTargetUWP* target) {
+		std::lock_guard<std::mutex> lock(tokenLock);
+		targets.push_back(target);
+	}
+
+	void Remove(CancelTargetUWP* target) {
+		std::lock_guard<std::mutex> lock(tokenLock);
+		targets.erase(std::remove(targets.begin(), targets.end(), target), targets.end());
+	}
+
+private:
+	std::mutex tokenLock;
+	std::vector<CancelTargetUWP*> targets;
+	std::atomic<bool> canceled{ false };
+};
+
+struct StorageLimitsUWP {
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+	std::shared_ptr<CancelTokenUWP> token;
+	StorageCallResultUWP result = STORAGE_CALL_COMPLETED; // First stop inside the scope
+
+	bool HasDeadline() const {
+		return deadline != std::chrono::steady_clock::time_point::max();
+	}
+
+	bool IsCanceled() const {
+		return token != nullptr && token->IsCanceled();
+	}
+
+	bool IsExpired() const {
+		return HasDeadline() && std::chrono::steady_clock::now() >= deadline;
+	}
+
+	// Check before starting more work
+	StorageCallResultUWP Check() const {
+		if (IsCanceled()) {
+			return STORAGE_CALL_CANCELED;
+		}
+		return IsExpired() ? STORAGE_CALL_TIMEOUT : STORAGE_CALL_COMPLETED;
+	}
+
+	void Stop(StorageCallResultUWP reason) {
+		if (result == STORAGE_CALL_COMPLETED) {
+			result = reason;
+		}
+	}
+};
+
+// Limits of the calling thread (nullptr if there is no scope)
+inline StorageLimitsUWP*& CurrentStorageLimitsUWP() {
+	thread_local StorageLimitsUWP* current = nullptr;
+	return current;
+}
+
+// Stop the current call if its limits are reached, records the reason in the scope
+// return 'STORAGE_CALL_COMPLETED' when it's fine to continue
+inline StorageCallResultUWP CheckStorageLimitsUWP() {
+	StorageLimitsUWP* limits = CurrentStorageLimitsUWP();
+	if (limits == nullptr) {
+		return STORAGE_CALL_COMPLETED;
+	}
+	auto state = limits->Check();
+	if (state != STORAGE_CALL_COMPLETED) {
+		limits->Stop(state);
+	}
+	return state;
+}
+
+// Copy of the calling thread limits (deadline, token), for work that continues on another thread
+inline StorageLimitsUWP CaptureStorageLimitsUWP() {
+	StorageLimitsUWP captured;
+	if (StorageLimitsUWP* limits = CurrentStorageLimitsUWP()) {
+		captured.deadline = limits->deadline;
+		captured.token = limits->token;
+	}
+	return captured;
+}
+
+// Scopes can be nested, inner scope keeps the earliest deadline and the outer token (if it has none)
+class StorageLimitScopeUWP {
+public:
+	// 'timeout' in milliseconds, 0 means no deadline (token only)
+	explicit StorageLimitScopeUWP(uint32_t timeout, std::shared_ptr<CancelTokenUWP> token = nullptr) {
+		previous = CurrentStorageLimitsUWP();
+		if (timeout > 0) {
+			limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+		}
+		limits.token = token;
+		if (previous != nullptr) {
+			limits.deadline = (std::min)(limits.deadline, previous->deadline);
+			if (limits.token == nullptr) {
+				limits.token = previous->token;
+			}
+		}
+		CurrentStorageLimitsUWP() = &limits;
+	}
+
+	// Limits captured on another thread ('CaptureStorageLimitsUWP'), nothing is applied if they are empty
+	explicit StorageLimitScopeUWP(const StorageLimitsUWP& captured) {
+		previous = CurrentStorageLimitsUWP();
+		limits.deadline = captured.deadline;
+		limits.token = captured.token;
+		applied = limits.HasDeadline() || limits.token != nullptr;
+		if (applied) {
+			CurrentStorageLimitsUWP() = &limits;
+		}
+	}
+
+	~StorageLimitScopeUWP() {
+		if (!applied) {
+			return;
+		}
+		if (previous != nullptr) {
+			previous->Stop(limits.result);
+		}
+		CurrentStorageLimitsUWP() = previous;
+	}
+
+	StorageLimitScopeUWP(const StorageLimitScopeUWP&) = delete;
+	StorageLimitScopeUWP& operator=(const StorageLimitScopeUWP&) = delete;
+
+	// 'STORAGE_CALL_TIMEOUT' or 'STORAGE_CALL_CANCELED' if any call inside the scope was stopped
+	StorageCallResultUWP Result() const {
+		return limits.result;
+	}
+
+	bool TimedOut() const {
+		return limits.result == STORAGE_CALL_TIMEOUT;
+	}
+
+	bool Canceled() const {
+		return limits.result == STORAGE_CALL_CANCELED;
+	}
+
+private:
+	StorageLimitsUWP limits;
+	StorageLimitsUWP* previous = nullptr;
+	bool applied = true;
+};
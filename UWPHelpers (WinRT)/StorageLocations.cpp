@@ -0,0 +1,56 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+#include "StorageLocations.h"
+#include "StoragePathCompare.h"
+#include "StoragePath.h"
+
+static inline char FoldChar(char c) {
+	return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+}
+
+void LocationRegistryUWP::AddRoot(LocationTypeUWP type, const std::string& path) {
+	Root root;
+	root.type = type;
+	root.path = path;
+	root.prefix = path;
+	CanonicalizePathUWP(root.prefix, '\\');
+	for (auto& c : root.prefix) {
+		c = FoldChar(c);
+	}
+	if (root.prefix.empty() || root.prefix == ".") {
+		return;
+	}
+
+	auto iter = roots.begin();
+	while (iter != roots.end() && iter->prefix.size() >= root.prefix.size()) {
+		++iter;
+	}
+	roots.insert(iter, root);
+}
+
+LocationTypeUWP LocationRegistryUWP::Classify(const std::string& path) const {
+	for (auto& root : roots) {
+		if (MatchPrefix(path, root.prefix)) {
+			return root.type;
+		}
+	}
+	return LocationTypeUWP::UNKNOWN;
+}
+
+const std::string& LocationRegistryUWP::GetRoot(LocationTypeUWP type) const {
+	for (auto& root : roots) {
+		if (root.type == type) {
+			return root.path;
+		}
+	}
+	return emptyRoot;
+}
+
+// Full component match only ('C:\Data' is not root of 'C:\Database')
+bool LocationRegistryUWP::MatchPrefix(const std::string& path, const std::string& prefix) {
+	return PathStartsWithUWP(path, prefix);
+}
@@ -0,0 +1,101 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+#include "StorageMounts.h"
+#include "StoragePathCompare.h"
+#include "StoragePath.h"
+
+static inline bool IsRooted(std::string_view path) {
+	return !path.empty() && (path[0] == '/' || path[0] == '\\');
+}
+
+// Drive root ('D:') is accepted as target too
+static inline bool IsAbsoluteTarget(const PathUWP& path) {
+	return path.IsAbsolute() || (path.size() == 2 && path.ToString()[1] == ':');
+}
+
+bool MountTableUWP::Mount(const std::string& root, const std::string& target) {
+	PathUWP rootPath(root);
+	PathUWP targetPath(target);
+	if (rootPath.empty() || rootPath.IsRoot() || targetPath.empty() || !IsAbsoluteTarget(targetPath)) {
+		return false;
+	}
+
+	MountPointUWP mount{ rootPath.ToString(), targetPath.ToString() };
+	Unmount(mount.root);
+
+	// Deeper root is always longer, so first match is the deepest one
+	auto iter = mounts.begin();
+	while (iter != mounts.end() && iter->root.size() >= mount.root.size()) {
+		++iter;
+	}
+	mounts.insert(iter, std::move(mount));
+	return true;
+}
+
+bool MountTableUWP::Unmount(const std::string& root) {
+	for (auto iter = mounts.begin(); iter != mounts.end(); ++iter) {
+		if (PathEqualsUWP(iter->root, root)) {
+			mounts.erase(iter);
+			return true;
+		}
+	}
+	return false;
+}
+
+bool MountTableUWP::Resolve(std::string_view path, std::string& out) const {
+	bool rooted = IsRooted(path);
+	std::string_view relative;
+	for (auto& mount : mounts) {
+		// '/roms' must not match relative 'roms'
+		if (IsRooted(mount.root) != rooted || !GetRelativePathUWP(mount.root, path, relative)) {
+			continue;
+		}
+		out.assign(mount.target);
+		if (!relative.empty()) {
+			out.push_back('/');
+			out.append(relative);
+		}
+		return true;
+	}
+	return false;
+}
+
+bool MountTableUWP::GetTarget(std::string_view root, std::string& target) const {
+	for (auto& mount : mounts) {
+		if (PathEqualsUWP(mount.root, root)) {
+			target = mount.target;
+			return true;
+		}
+	}
+	return false;
+}
+
+std::string MountTableUWP::Serialize() const {
+	std::string data;
+	for (auto& mount : mounts) {
+		data.append(mount.root).append("|").append(mount.target).append("\n");
+	}
+	return data;
+}
+
+size_t MountTableUWP::Deserialize(std::string_view data) {
+	size_t count = 0;
+	while (!data.empty()) {
+		size_t end = data.find('\n');
+		std::string_view line = data.substr(0, end);
+		data = (end != std::string_view::npos) ? data.substr(end + 1) : std::string_view();
+
+		size_t split = line.find('|');
+		if (split == std::string_view::npos) {
+			continue;
+		}
+		if (Mount(std::string(line.substr(0, split)), std::string(line.substr(split + 1)))) {
+			count++;
+		}
+	}
+	return count;
+}
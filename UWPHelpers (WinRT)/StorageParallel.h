@@ -0,0 +1,43 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Bounded parallel loop for blocking broker calls [Internal usage]
+// indexes are taken in order, each one by a single worker,
+// so results can be written to per-index slots without locks
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Run 'work(index)' for every index in [0, count) with at most 'workers' at once
+// the calling thread is one of the workers, return once all indexes are done
+// must not be called from UI thread (it will wait for the workers)
+template<typename F>
+void ParallelForUWP(size_t count, size_t workers, F work) {
+	if (workers < 1) {
+		workers = 1;
+	}
+	if (workers > count) {
+		workers = count;
+	}
+	std::atomic<size_t> next{ 0 };
+	auto run = [&]() {
+		for (size_t i = next++; i < count; i = next++) {
+			work(i);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t w = 1; w < workers; w++) {
+		threads.emplace_back(run);
+	}
+	run();
+	for (auto& thread : threads) {
+		thread.join();
+	}
+}
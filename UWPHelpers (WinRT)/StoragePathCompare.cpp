@@ -0,0 +1,364 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+#include "StoragePathCompare.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define PATH_COMPARE_SSE2 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#include <arm_neon.h>
+#define PATH_COMPARE_NEON 1
+#endif
+
+#pragma region Folding
+struct FoldRangeUWP {
+	uint16_t first;
+	uint16_t last;
+	int32_t delta;
+	uint8_t stride; // 1: every code point, 2: every other code point (upper/lower pairs)
+};
+
+// Generated from the Unicode simple case mappings,
+// each code point is folded to the lower case of its upper case
+static const FoldRangeUWP FoldRanges[] = {
+	{ 0x00B5, 0x00B5, 775, 1 }, { 0x00C0, 0x00D6, 32, 1 }, { 0x00D8, 0x00DE, 32, 1 }, { 0x0100, 0x012E, 1, 2 },
+	{ 0x0131, 0x0131, -200, 1 }, { 0x0132, 0x0136, 1, 2 }, { 0x0139, 0x0147, 1, 2 }, { 0x014A, 0x0176, 1, 2 },
+	{ 0x0178, 0x0178, -121, 1 }, { 0x0179, 0x017D, 1, 2 }, { 0x017F, 0x017F, -268, 1 }, { 0x0181, 0x0181, 210, 1 },
+	{ 0x0182, 0x0184, 1, 2 }, { 0x0186, 0x0186, 206, 1 }, { 0x0187, 0x0187, 1, 1 }, { 0x0189, 0x018A, 205, 1 },
+	{ 0x018B, 0x018B, 1, 1 }, { 0x018E, 0x018E, 79, 1 }, { 0x018F, 0x018F, 202, 1 }, { 0x0190, 0x0190, 203, 1 },
+	{ 0x0191, 0x0191, 1, 1 }, { 0x0193, 0x0193, 205, 1 }, { 0x0194, 0x0194, 207, 1 }, { 0x0196, 0x0196, 211, 1 },
+	{ 0x0197, 0x0197, 209, 1 }, { 0x0198, 0x0198, 1, 1 }, { 0x019C, 0x019C, 211, 1 }, { 0x019D, 0x019D, 213, 1 },
+	{ 0x019F, 0x019F, 214, 1 }, { 0x01A0, 0x01A4, 1, 2 }, { 0x01A6, 0x01A6, 218, 1 }, { 0x01A7, 0x01A7, 1, 1 },
+	{ 0x01A9, 0x01A9, 218, 1 }, { 0x01AC, 0x01AC, 1, 1 }, { 0x01AE, 0x01AE, 218, 1 }, { 0x01AF, 0x01AF, 1, 1 },
+	{ 0x01B1, 0x01B2, 217, 1 }, { 0x01B3, 0x01B5, 1, 2 }, { 0x01B7, 0x01B7, 219, 1 }, { 0x01B8, 0x01B8, 1, 1 },
+	{ 0x01BC, 0x01BC, 1, 1 }, { 0x01C4, 0x01C4, 2, 1 }, { 0x01C5, 0x01C5, 1, 1 }, { 0x01C7, 0x01C7, 2, 1 },
+	{ 0x01C8, 0x01C8, 1, 1 }, { 0x01CA, 0x01CA, 2, 1 }, { 0x01CB, 0x01DB, 1, 2 }, { 0x01DE, 0x01EE, 1, 2 },
+	{ 0x01F1, 0x01F1, 2, 1 }, { 0x01F2, 0x01F4, 1, 2 }, { 0x01F6, 0x01F6, -97, 1 }, { 0x01F7, 0x01F7, -56, 1 },
+	{ 0x01F8, 0x021E, 1, 2 }, { 0x0220, 0x0220, -130, 1 }, { 0x0222, 0x0232, 1, 2 }, { 0x023A, 0x023A, 10795, 1 },
+	{ 0x023B, 0x023B, 1, 1 }, { 0x023D, 0x023D, -163, 1 }, { 0x023E, 0x023E, 10792, 1 }, { 0x0241, 0x0241, 1, 1 },
+	{ 0x0243, 0x0243, -195, 1 }, { 0x0244, 0x0244, 69, 1 }, { 0x0245, 0x0245, 71, 1 }, { 0x0246, 0x024E, 1, 2 },
+	{ 0x0345, 0x0345, 116, 1 }, { 0x0370, 0x0372, 1, 2 }, { 0x0376, 0x0376, 1, 1 }, { 0x037F, 0x037F, 116, 1 },
+	{ 0x0386, 0x0386, 38, 1 }, { 0x0388, 0x038A, 37, 1 }, { 0x038C, 0x038C, 64, 1 }, { 0x038E, 0x038F, 63, 1 },
+	{ 0x0391, 0x03A1, 32, 1 }, { 0x03A3, 0x03AB, 32, 1 }, { 0x03C2, 0x03C2, 1, 1 }, { 0x03CF, 0x03CF, 8, 1 },
+	{ 0x03D0, 0x03D0, -30, 1 }, { 0x03D1, 0x03D1, -25, 1 }, { 0x03D5, 0x03D5, -15, 1 }, { 0x03D6, 0x03D6, -22, 1 },
+	{ 0x03D8, 0x03EE, 1, 2 }, { 0x03F0, 0x03F0, -54, 1 }, { 0x03F1, 0x03F1, -48, 1 }, { 0x03F4, 0x03F4, -60, 1 },
+	{ 0x03F5, 0x03F5, -64, 1 }, { 0x03F7, 0x03F7, 1, 1 }, { 0x03F9, 0x03F9, -7, 1 }, { 0x03FA, 0x03FA, 1, 1 },
+	{ 0x03FD, 0x03FF, -130, 1 }, { 0x0400, 0x040F, 80, 1 }, { 0x0410, 0x042F, 32, 1 }, { 0x0460, 0x0480, 1, 2 },
+	{ 0x048A, 0x04BE, 1, 2 }, { 0x04C0, 0x04C0, 15, 1 }, { 0x04C1, 0x04CD, 1, 2 }, { 0x04D0, 0x052E, 1, 2 },
+	{ 0x0531, 0x0556, 48, 1 }, { 0x10A0, 0x10C5, 7264, 1 }, { 0x10C7, 0x10C7, 7264, 1 }, { 0x10CD, 0x10CD, 7264, 1 },
+	{ 0x13A0, 0x13EF, 38864, 1 }, { 0x13F0, 0x13F5, 8, 1 }, { 0x1C80, 0x1C80, -6222, 1 }, { 0x1C81, 0x1C81, -6221, 1 },
+	{ 0x1C82, 0x1C82, -6212, 1 }, { 0x1C83, 0x1C84, -6210, 1 }, { 0x1C85, 0x1C85, -6211, 1 }, { 0x1C86, 0x1C86, -6204, 1 },
+	{ 0x1C87, 0x1C87, -6180, 1 }, { 0x1C88, 0x1C88, 35267, 1 }, { 0x1C90, 0x1CBA, -3008, 1 }, { 0x1CBD, 0x1CBF, -3008, 1 },
+	{ 0x1E00, 0x1E94, 1, 2 }, { 0x1E9B, 0x1E9B, -58, 1 }, { 0x1E9E, 0x1E9E, -7615, 1 }, { 0x1EA0, 0x1EFE, 1, 2 },
+	{ 0x1F08, 0x1F0F, -8, 1 }, { 0x1F18, 0x1F1D, -8, 1 }, { 0x1F28, 0x1F2F, -8, 1 }, { 0x1F38, 0x1F3F, -8, 1 },
+	{ 0x1F48, 0x1F4D, -8, 1 }, { 0x1F59, 0x1F5F, -8, 2 }, { 0x1F68, 0x1F6F, -8, 1 }, { 0x1F88, 0x1F8F, -8, 1 },
+	{ 0x1F98, 0x1F9F, -8, 1 }, { 0x1FA8, 0x1FAF, -8, 1 }, { 0x1FB8, 0x1FB9, -8, 1 }, { 0x1FBA, 0x1FBB, -74, 1 },
+	{ 0x1FBC, 0x1FBC, -9, 1 }, { 0x1FBE, 0x1FBE, -7173, 1 }, { 0x1FC8, 0x1FCB, -86, 1 }, { 0x1FCC, 0x1FCC, -9, 1 },
+	{ 0x1FD8, 0x1FD9, -8, 1 }, { 0x1FDA, 0x1FDB, -100, 1 }, { 0x1FE8, 0x1FE9, -8, 1 }, { 0x1FEA, 0x1FEB, -112, 1 },
+	{ 0x1FEC, 0x1FEC, -7, 1 }, { 0x1FF8, 0x1FF9, -128, 1 }, { 0x1FFA, 0x1FFB, -126, 1 }, { 0x1FFC, 0x1FFC, -9, 1 },
+	{ 0x2126, 0x2126, -7517, 1 }, { 0x212A, 0x212A, -8383, 1 }, { 0x212B, 0x212B, -8262, 1 }, { 0x2132, 0x2132, 28, 1 },
+	{ 0x2160, 0x216F, 16, 1 }, { 0x2183, 0x2183, 1, 1 }, { 0x24B6, 0x24CF, 26, 1 }, { 0x2C00, 0x2C2F, 48, 1 },
+	{ 0x2C60, 0x2C60, 1, 1 }, { 0x2C62, 0x2C62, -10743, 1 }, { 0x2C63, 0x2C63, -3814, 1 }, { 0x2C64, 0x2C64, -10727, 1 },
+	{ 0x2C67, 0x2C6B, 1, 2 }, { 0x2C6D, 0x2C6D, -10780, 1 }, { 0x2C6E, 0x2C6E, -10749, 1 }, { 0x2C6F, 0x2C6F, -10783, 1 },
+	{ 0x2C70, 0x2C70, -10782, 1 }, { 0x2C72, 0x2C72, 1, 1 }, { 0x2C75, 0x2C75, 1, 1 }, { 0x2C7E, 0x2C7F, -10815, 1 },
+	{ 0x2C80, 0x2CE2, 1, 2 }, { 0x2CEB, 0x2CED, 1, 2 }, { 0x2CF2, 0x2CF2, 1, 1 }, { 0xA640, 0xA66C, 1, 2 },
+	{ 0xA680, 0xA69A, 1, 2 }, { 0xA722, 0xA72E, 1, 2 }, { 0xA732, 0xA76E, 1, 2 }, { 0xA779, 0xA77B, 1, 2 },
+	{ 0xA77D, 0xA77D, -35332, 1 }, { 0xA77E, 0xA786, 1, 2 }, { 0xA78B, 0xA78B, 1, 1 }, { 0xA78D, 0xA78D, -42280, 1 },
+	{ 0xA790, 0xA792, 1, 2 }, { 0xA796, 0xA7A8, 1, 2 }, { 0xA7AA, 0xA7AA, -42308, 1 }, { 0xA7AB, 0xA7AB, -42319, 1 },
+	{ 0xA7AC, 0xA7AC, -42315, 1 }, { 0xA7AD, 0xA7AD, -42305, 1 }, { 0xA7AE, 0xA7AE, -42308, 1 }, { 0xA7B0, 0xA7B0, -42258, 1 },
+	{ 0xA7B1, 0xA7B1, -42282, 1 }, { 0xA7B2, 0xA7B2, -42261, 1 }, { 0xA7B3, 0xA7B3, 928, 1 }, { 0xA7B4, 0xA7C2, 1, 2 },
+	{ 0xA7C4, 0xA7C4, -48, 1 }, { 0xA7C5, 0xA7C5, -42307, 1 }, { 0xA7C6, 0xA7C6, -35384, 1 }, { 0xA7C7, 0xA7C9, 1, 2 },
+	{ 0xA7D0, 0xA7D0, 1, 1 }, { 0xA7D6, 0xA7D8, 1, 2 }, { 0xA7F5, 0xA7F5, 1, 1 }, { 0xFF21, 0xFF3A, 32, 1 },
+};
+
+uint32_t FoldCodePointUWP(uint32_t codePoint) {
+	if (codePoint < 0x80) {
+		return (codePoint >= 'A' && codePoint <= 'Z') ? codePoint + ('a' - 'A') : codePoint;
+	}
+
+	size_t low = 0;
+	size_t high = sizeof(FoldRanges) / sizeof(FoldRanges[0]);
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		const FoldRangeUWP& range = FoldRanges[mid];
+		if (codePoint < range.first) {
+			high = mid;
+		}
+		else if (codePoint > range.last) {
+			low = mid + 1;
+		}
+		else {
+			if ((codePoint - range.first) % range.stride == 0) {
+				return (uint32_t)((int32_t)codePoint + range.delta);
+			}
+			return codePoint;
+		}
+	}
+	return codePoint;
+}
+
+// Decode one UTF-8 code point at 'index'
+// invalid sequences are returned as single bytes (above the Unicode range) so they only match themselves
+static uint32_t DecodeUTF8(std::string_view input, size_t index, size_t& length) {
+	uint8_t c = (uint8_t)input[index];
+	uint32_t codePoint = 0;
+	length = 1;
+	if (c < 0x80) {
+		return c;
+	}
+	else if ((c & 0xE0) == 0xC0) {
+		length = 2;
+		codePoint = c & 0x1F;
+	}
+	else if ((c & 0xF0) == 0xE0) {
+		length = 3;
+		codePoint = c & 0x0F;
+	}
+	else if ((c & 0xF8) == 0xF0) {
+		length = 4;
+		codePoint = c & 0x07;
+	}
+	else {
+		return 0x110000 + c;
+	}
+
+	if (index + length > input.size()) {
+		length = 1;
+		return 0x110000 + c;
+	}
+	for (size_t i = 1; i < length; i++) {
+		uint8_t next = (uint8_t)input[index + i];
+		if ((next & 0xC0) != 0x80) {
+			length = 1;
+			return 0x110000 + c;
+		}
+		codePoint = (codePoint << 6) | (next & 0x3F);
+	}
+	return codePoint;
+}
+
+static void EncodeUTF8(uint32_t codePoint, std::string& output) {
+	if (codePoint < 0x80) {
+		output.push_back((char)codePoint);
+	}
+	else if (codePoint < 0x800) {
+		output.push_back((char)(0xC0 | (codePoint >> 6)));
+		output.push_back((char)(0x80 | (codePoint & 0x3F)));
+	}
+	else if (codePoint < 0x10000) {
+		output.push_back((char)(0xE0 | (codePoint >> 12)));
+		output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+		output.push_back((char)(0x80 | (codePoint & 0x3F)));
+	}
+	else {
+		output.push_back((char)(0xF0 | (codePoint >> 18)));
+		output.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+		output.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+		output.push_back((char)(0x80 | (codePoint & 0x3F)));
+	}
+}
+
+void FoldCaseUWP(std::string& input) {
+	size_t i = 0;
+	for (; i < input.size(); i++) {
+		char& c = input[i];
+		if ((uint8_t)c >= 0x80) {
+			break;
+		}
+		if (c >= 'A' && c <= 'Z') {
+			c = (char)(c + ('a' - 'A'));
+		}
+	}
+	if (i == input.size()) {
+		return;
+	}
+
+	// Non-ASCII, folded code point may have different length
+	std::string output = input.substr(0, i);
+	output.reserve(input.size());
+	std::string_view view(input);
+	while (i < view.size()) {
+		size_t length;
+		uint32_t codePoint = DecodeUTF8(view, i, length);
+		if (codePoint >= 0x110000) {
+			output.push_back(view[i]);
+		}
+		else {
+			EncodeUTF8(FoldCodePointUWP(codePoint), output);
+		}
+		i += length;
+	}
+	input.swap(output);
+}
+#pragma endregion
+
+#pragma region Compare
+static inline bool IsSeparator(char c) {
+	return c == '/' || c == '\\';
+}
+
+static inline char FoldASCII(char c) {
+	if (c >= 'A' && c <= 'Z') {
+		return (char)(c + ('a' - 'A'));
+	}
+	return c == '/' ? '\\' : c;
+}
+
+// Trailing separators are ignored, except for the root '/'
+static std::string_view TrimSeparators(std::string_view path) {
+	while (path.size() > 1 && IsSeparator(path.back())) {
+		path.remove_suffix(1);
+	}
+	return path;
+}
+
+// Compare 16 ASCII bytes of each side, false when not ASCII or not equal
+static inline bool EqualsBlock(const char* a, const char* b) {
+#if PATH_COMPARE_SSE2
+	__m128i va = _mm_loadu_si128((const __m128i*)a);
+	__m128i vb = _mm_loadu_si128((const __m128i*)b);
+	if (_mm_movemask_epi8(_mm_or_si128(va, vb)) != 0) {
+		return false;
+	}
+	const __m128i upperFirst = _mm_set1_epi8('A' - 1);
+	const __m128i upperLast = _mm_set1_epi8('Z' + 1);
+	const __m128i caseBit = _mm_set1_epi8(0x20);
+	const __m128i slash = _mm_set1_epi8('/');
+	const __m128i backslash = _mm_set1_epi8('\\');
+
+	__m128i upperA = _mm_and_si128(_mm_cmpgt_epi8(va, upperFirst), _mm_cmplt_epi8(va, upperLast));
+	__m128i upperB = _mm_and_si128(_mm_cmpgt_epi8(vb, upperFirst), _mm_cmplt_epi8(vb, upperLast));
+	va = _mm_or_si128(va, _mm_and_si128(upperA, caseBit));
+	vb = _mm_or_si128(vb, _mm_and_si128(upperB, caseBit));
+
+	__m128i slashA = _mm_cmpeq_epi8(va, slash);
+	__m128i slashB = _mm_cmpeq_epi8(vb, slash);
+	va = _mm_or_si128(_mm_andnot_si128(slashA, va), _mm_and_si128(slashA, backslash));
+	vb = _mm_or_si128(_mm_andnot_si128(slashB, vb), _mm_and_si128(slashB, backslash));
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xFFFF;
+#elif PATH_COMPARE_NEON
+	uint8x16_t va = vld1q_u8((const uint8_t*)a);
+	uint8x16_t vb = vld1q_u8((const uint8_t*)b);
+	if (vmaxvq_u8(vorrq_u8(va, vb)) >= 0x80) {
+		return false;
+	}
+	const uint8x16_t upperFirst = vdupq_n_u8('A');
+	const uint8x16_t upperLast = vdupq_n_u8('Z');
+	const uint8x16_t caseBit = vdupq_n_u8(0x20);
+	const uint8x16_t slash = vdupq_n_u8('/');
+	const uint8x16_t backslash = vdupq_n_u8('\\');
+
+	uint8x16_t upperA = vandq_u8(vcgeq_u8(va, upperFirst), vcleq_u8(va, upperLast));
+	uint8x16_t upperB = vandq_u8(vcgeq_u8(vb, upperFirst), vcleq_u8(vb, upperLast));
+	va = vorrq_u8(va, vandq_u8(upperA, caseBit));
+	vb = vorrq_u8(vb, vandq_u8(upperB, caseBit));
+
+	va = vbslq_u8(vceqq_u8(va, slash), backslash, va);
+	vb = vbslq_u8(vceqq_u8(vb, slash), backslash, vb);
+
+	return vminvq_u8(vceqq_u8(va, vb)) == 0xFF;
+#else
+	for (size_t i = 0; i < 16; i++) {
+		if ((uint8_t)a[i] >= 0x80 || (uint8_t)b[i] >= 0x80 || FoldASCII(a[i]) != FoldASCII(b[i])) {
+			return false;
+		}
+	}
+	return true;
+#endif
+}
+
+// Match 'prefix' against the start of 'path'
+// return the matched length in 'path' (may differ from prefix length for non-ASCII), npos if not matched
+static size_t MatchPrefix(std::string_view path, std::string_view prefix) {
+	size_t i = 0;
+	size_t j = 0;
+	size_t scalarUntil = 0; // Block that failed is finished byte by byte
+	while (j < prefix.size()) {
+		if (i >= path.size()) {
+			return std::string_view::npos;
+		}
+
+		if (j >= scalarUntil && path.size() - i >= 16 && prefix.size() - j >= 16) {
+			if (EqualsBlock(path.data() + i, prefix.data() + j)) {
+				i += 16;
+				j += 16;
+				continue;
+			}
+			scalarUntil = j + 16;
+		}
+
+		char a = path[i];
+		char b = prefix[j];
+		if ((uint8_t)a < 0x80 && (uint8_t)b < 0x80) {
+			if (FoldASCII(a) != FoldASCII(b)) {
+				return std::string_view::npos;
+			}
+			i++;
+			j++;
+			continue;
+		}
+
+		size_t lengthA, lengthB;
+		uint32_t codePointA = DecodeUTF8(path, i, lengthA);
+		uint32_t codePointB = DecodeUTF8(prefix, j, lengthB);
+		if (codePointA != codePointB && FoldCodePointUWP(codePointA) != FoldCodePointUWP(codePointB)) {
+			return std::string_view::npos;
+		}
+		i += lengthA;
+		j += lengthB;
+	}
+	return i;
+}
+
+bool PathEqualsUWP(std::string_view a, std::string_view b) {
+	a = TrimSeparators(a);
+	b = TrimSeparators(b);
+	return MatchPrefix(a, b) == a.size();
+}
+
+bool PathStartsWithUWP(std::string_view path, std::string_view parent) {
+	path = TrimSeparators(path);
+	parent = TrimSeparators(parent);
+	if (parent.empty()) {
+		return false;
+	}
+	size_t matched = MatchPrefix(path, parent);
+	if (matched == std::string_view::npos) {
+		return false;
+	}
+	return matched == path.size() || IsSeparator(path[matched]) || IsSeparator(parent.back());
+}
+
+bool PathIsDirectChildUWP(std::string_view parent, std::string_view child) {
+	child = TrimSeparators(child);
+	parent = TrimSeparators(parent);
+	if (parent.empty()) {
+		return false;
+	}
+	size_t matched = MatchPrefix(child, parent);
+	if (matched == std::string_view::npos || matched == child.size()) {
+		return false;
+	}
+	if (!IsSeparator(parent.back())) {
+		if (!IsSeparator(child[matched])) {
+			return false;
+		}
+		matched++;
+	}
+	// Rest must be a single non-empty component
+	if (matched >= child.size()) {
+		return false;
+	}
+	for (size_t i = matched; i < child.size(); i++) {
+		if (IsSeparator(child[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+#pragma endregion
@@ -0,0 +1,327 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Prefix trie for the lookup list
+// each node is one path component (case folded)
+// 'C:\Games\PSP' stored as: 'c:' -> 'games' -> 'psp'
+// both '/' and '\' are accepted as separators
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+
+#include "StoragePathCompare.h"
+
+template<typename T>
+class PathTrieUWP {
+public:
+	PathTrieUWP() : root(new Node()) {
+	}
+
+	PathTrieUWP(const PathTrieUWP& other) : root(CloneNode(*other.root)) {
+	}
+
+	PathTrieUWP& operator=(const PathTrieUWP& other) {
+		if (this != &other) {
+			root.reset(CloneNode(*other.root));
+		}
+		return *this;
+	}
+
+	// Insert (or replace) value at the given full path
+	// return false if path has no components
+	bool Insert(const std::string& path, const T& value) {
+		std::vector<std::string> parts;
+		SplitPath(path, parts);
+		if (parts.empty()) {
+			return false;
+		}
+
+		// Count must be updated along the chain only for new values
+		bool isNew = true;
+		{
+			Node* test = Walk(path);
+			if (test != nullptr && test->value) {
+				isNew = false;
+			}
+		}
+
+		Node* node = root.get();
+		if (isNew) {
+			node->count++;
+		}
+		for (auto& part : parts) {
+			std::string key = part;
+			FoldCase(key);
+			auto& child = node->children[key];
+			if (!child) {
+				child.reset(new Node());
+				child->name = part;
+			}
+			node = child.get();
+			if (isNew) {
+				node->count++;
+			}
+		}
+		node->value.reset(new T(value));
+		return true;
+	}
+
+	// Remove value at the given full path
+	bool Remove(const std::string& path) {
+		Node* test = Walk(path);
+		if (test == nullptr || !test->value) {
+			return false;
+		}
+
+		std::vector<std::string> parts;
+		SplitPath(path, parts);
+
+		Node* node = root.get();
+		node->count--;
+		for (auto& part : parts) {
+			std::string key = part;
+			FoldCase(key);
+			auto iter = node->children.find(key);
+			Node* next = iter->second.get();
+			next->count--;
+			if (next->count == 0) {
+				// Nothing left below, drop the whole branch
+				node->children.erase(iter);
+				return true;
+			}
+			node = next;
+		}
+		node->value.reset();
+		return true;
+	}
+
+	// Exact match
+	const T* Find(const std::string& path) const {
+		Node* node = Walk(path);
+		return (node != nullptr) ? node->value.get() : nullptr;
+	}
+
+	// Values stored on the path (deepest first)
+	// 'includeSelf' will include the exact match (if any)
+	void GetAncestors(const std::string& path, std::vector<const T*>& out, bool includeSelf = false) const {
+		std::vector<Node*> chain;
+		WalkChain(path, chain);
+		for (auto it = chain.rbegin(); it != chain.rend(); ++it) {
+			Node* node = *it;
+			if (node->value) {
+				if (!includeSelf && it == chain.rbegin() && chain.size() == Depth(path)) {
+					continue;
+				}
+				out.push_back(node->value.get());
+			}
+		}
+	}
+
+	// Length of the path part that leads to the deepest stored value (0 if none)
+	// 'C:\Games\PSP\Save' with 'C:\Games' stored will return 8
+	size_t GetDeepestPrefixLength(const std::string& path) const {
+		Node* node = root.get();
+		size_t deepest = 0;
+		std::string key;
+		size_t start = 0;
+		size_t len = path.size();
+		for (size_t i = 0; i <= len; i++) {
+			if (i == len || path[i] == '\\' || path[i] == '/') {
+				if (i > start) {
+					key.assign(path, start, i - start);
+					FoldCase(key);
+					auto iter = node->children.find(key);
+					if (iter == node->children.end()) {
+						break;
+					}
+					node = iter->second.get();
+					if (node->value) {
+						deepest = i;
+					}
+				}
+				start = i + 1;
+			}
+		}
+		return deepest;
+	}
+
+	// Values stored exactly one level below path
+	void GetChildren(const std::string& path, std::vector<const T*>& out) const {
+		Node* node = Walk(path);
+		if (node != nullptr) {
+			for (auto& child : node->children) {
+				if (child.second->value) {
+					out.push_back(child.second->value.get());
+				}
+			}
+		}
+	}
+
+	// Check if there are values exactly one level below path
+	bool HasChildren(const std::string& path) const {
+		Node* node = Walk(path);
+		if (node != nullptr) {
+			for (auto& child : node->children) {
+				if (child.second->value) {
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	// Check if path itself or anything below it is stored
+	bool ContainsPrefix(const std::string& path) const {
+		Node* node = Walk(path);
+		return node != nullptr && node->count > 0;
+	}
+
+	// Names (original case) of the first level sub folders that lead to stored values
+	void GetSubRoots(const std::string& path, std::vector<std::string>& names) const {
+		Node* node = Walk(path);
+		if (node != nullptr) {
+			for (auto& child : node->children) {
+				if (child.second->count > 0) {
+					names.push_back(child.second->name);
+				}
+			}
+		}
+	}
+
+	// Visit all stored values
+	template<typename F>
+	void ForEach(F func) const {
+		ForEachNode(*root, func);
+	}
+
+	size_t size() const {
+		return root->count;
+	}
+
+	bool empty() const {
+		return root->count == 0;
+	}
+
+	void clear() {
+		root.reset(new Node());
+	}
+
+	// Split full path into components
+	static void SplitPath(const std::string& path, std::vector<std::string>& parts) {
+		size_t start = 0;
+		size_t len = path.size();
+		for (size_t i = 0; i <= len; i++) {
+			if (i == len || path[i] == '\\' || path[i] == '/') {
+				if (i > start) {
+					parts.push_back(path.substr(start, i - start));
+				}
+				start = i + 1;
+			}
+		}
+	}
+
+	// Same folding used by the path comparators (see 'StoragePathCompare.h')
+	static void FoldCase(std::string& input) {
+		FoldCaseUWP(input);
+	}
+
+private:
+	struct Node {
+		std::unordered_map<std::string, std::unique_ptr<Node>> children;
+		std::unique_ptr<T> value;
+		std::string name; // Original case
+		size_t count = 0; // Values in this node and below
+	};
+
+	std::unique_ptr<Node> root;
+
+	static Node* CloneNode(const Node& node) {
+		Node* copy = new Node();
+		copy->name = node.name;
+		copy->count = node.count;
+		if (node.value) {
+			copy->value.reset(new T(*node.value));
+		}
+		for (auto& child : node.children) {
+			copy->children[child.first].reset(CloneNode(*child.second));
+		}
+		return copy;
+	}
+
+	template<typename F>
+	static void ForEachNode(const Node& node, F& func) {
+		if (node.value) {
+			func(*node.value);
+		}
+		for (auto& child : node.children) {
+			ForEachNode(*child.second, func);
+		}
+	}
+
+	static size_t Depth(const std::string& path) {
+		size_t depth = 0;
+		size_t len = path.size();
+		bool inPart = false;
+		for (size_t i = 0; i < len; i++) {
+			bool isSeparator = path[i] == '\\' || path[i] == '/';
+			if (!isSeparator && !inPart) {
+				depth++;
+			}
+			inPart = !isSeparator;
+		}
+		return depth;
+	}
+
+	// Walk to node of path, nullptr if not found
+	Node* Walk(const std::string& path) const {
+		Node* node = root.get();
+		std::string key;
+		size_t start = 0;
+		size_t len = path.size();
+		for (size_t i = 0; i <= len; i++) {
+			if (i == len || path[i] == '\\' || path[i] == '/') {
+				if (i > start) {
+					key.assign(path, start, i - start);
+					FoldCase(key);
+					auto iter = node->children.find(key);
+					if (iter == node->children.end()) {
+						return nullptr;
+					}
+					node = iter->second.get();
+				}
+				start = i + 1;
+			}
+		}
+		return (node == root.get()) ? nullptr : node;
+	}
+
+	// Walk as far as possible, collecting the nodes on the way
+	void WalkChain(const std::string& path, std::vector<Node*>& chain) const {
+		Node* node = root.get();
+		std::string key;
+		size_t start = 0;
+		size_t len = path.size();
+		for (size_t i = 0; i <= len; i++) {
+			if (i == len || path[i] == '\\' || path[i] == '/') {
+				if (i > start) {
+					key.assign(path, start, i - start);
+					FoldCase(key);
+					auto iter = node->children.find(key);
+					if (iter == node->children.end()) {
+						return;
+					}
+					node = iter->second.get();
+					chain.push_back(node);
+				}
+				start = i + 1;
+			}
+		}
+	}
+};
@@ -0,0 +1,135 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+#include "StorageSnapshot.h"
+
+static const char SnapshotMagic[4] = { 'U', 'W', 'P', 'L' };
+
+static uint32_t SnapshotChecksum(const char* data, size_t size) {
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= (uint8_t)data[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static void WriteInt(std::string& out, uint64_t value, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		out.push_back((char)((value >> (i * 8)) & 0xFF));
+	}
+}
+
+static void WriteString(std::string& out, const std::string& value) {
+	WriteInt(out, value.size(), 4);
+	out.append(value);
+}
+
+// Bounds checked reader, any failure will stick
+class SnapshotReader {
+public:
+	SnapshotReader(const char* data, size_t size) : data(data), size(size) {
+	}
+
+	uint64_t ReadInt(size_t bytes) {
+		uint64_t value = 0;
+		if (failed || size - offset < bytes) {
+			failed = true;
+			return 0;
+		}
+		for (size_t i = 0; i < bytes; i++) {
+			value |= (uint64_t)(uint8_t)data[offset + i] << (i * 8);
+		}
+		offset += bytes;
+		return value;
+	}
+
+	void ReadString(std::string& value) {
+		size_t length = (size_t)ReadInt(4);
+		if (failed || size - offset < length) {
+			failed = true;
+			return;
+		}
+		value.assign(data + offset, length);
+		offset += length;
+	}
+
+	bool Failed() const {
+		return failed;
+	}
+
+	bool Done() const {
+		return offset == size;
+	}
+
+private:
+	const char* data;
+	size_t size;
+	size_t offset = 0;
+	bool failed = false;
+};
+
+void SerializeLookupSnapshot(const std::vector<LookupSnapshotEntryUWP>& entries, int64_t created, std::string& out) {
+	out.clear();
+	out.append(SnapshotMagic, sizeof(SnapshotMagic));
+	WriteInt(out, LOOKUP_SNAPSHOT_VERSION, 4);
+	WriteInt(out, (uint64_t)created, 8);
+	WriteInt(out, entries.size(), 4);
+	for (auto& entry : entries) {
+		WriteInt(out, entry.isDirectory ? 1 : 0, 1);
+		WriteInt(out, (uint64_t)entry.validated, 8);
+		WriteString(out, entry.token);
+		WriteString(out, entry.path);
+	}
+	WriteInt(out, SnapshotChecksum(out.data(), out.size()), 4);
+}
+
+bool DeserializeLookupSnapshot(const std::string& data, std::vector<LookupSnapshotEntryUWP>& entries, int64_t& created) {
+	entries.clear();
+	created = 0;
+
+	// Header + footer at least
+	const size_t minSize = sizeof(SnapshotMagic) + 4 + 8 + 4 + 4;
+	if (data.size() < minSize || data.compare(0, sizeof(SnapshotMagic), SnapshotMagic, sizeof(SnapshotMagic)) != 0) {
+		return false;
+	}
+
+	size_t payloadSize = data.size() - 4;
+	SnapshotReader footer(data.data() + payloadSize, 4);
+	if ((uint32_t)footer.ReadInt(4) != SnapshotChecksum(data.data(), payloadSize)) {
+		return false;
+	}
+
+	SnapshotReader reader(data.data() + sizeof(SnapshotMagic), payloadSize - sizeof(SnapshotMagic));
+	if (reader.ReadInt(4) != LOOKUP_SNAPSHOT_VERSION) {
+		return false;
+	}
+	int64_t snapshotCreated = (int64_t)reader.ReadInt(8);
+	size_t count = (size_t)reader.ReadInt(4);
+
+	std::vector<LookupSnapshotEntryUWP> items;
+	for (size_t i = 0; i < count && !reader.Failed(); i++) {
+		LookupSnapshotEntryUWP entry;
+		uint64_t type = reader.ReadInt(1);
+		if (type > 1) {
+			return false;
+		}
+		entry.isDirectory = type == 1;
+		entry.validated = (int64_t)reader.ReadInt(8);
+		reader.ReadString(entry.token);
+		reader.ReadString(entry.path);
+		items.push_back(entry);
+	}
+
+	if (reader.Failed() || !reader.Done()) {
+		return false;
+	}
+
+	entries.swap(items);
+	created = snapshotCreated;
+	return true;
+}
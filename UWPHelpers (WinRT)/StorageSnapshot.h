@@ -0,0 +1,34 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Lookup list snapshot (warm start)
+// picked items are saved to LocalState after each restore
+// so the next launch can classify paths before the broker calls are done
+
+// Binary format (little endian):
+// header: magic 'UWPL', version (u32), created (i64), entries count (u32)
+// entry: type (u8), validated (i64), token (u32 size + bytes), path (u32 size + bytes)
+// footer: FNV-1a checksum (u32) of all the bytes above
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define LOOKUP_SNAPSHOT_VERSION 1
+
+struct LookupSnapshotEntryUWP {
+	std::string token; // FutureAccessList token
+	std::string path; // Full item path
+	bool isDirectory = false;
+	int64_t validated = 0; // Unix time of the last successful resolve
+};
+
+void SerializeLookupSnapshot(const std::vector<LookupSnapshotEntryUWP>& entries, int64_t created, std::string& out);
+
+// Return false for corrupted, truncated or unsupported snapshot (entries will be empty)
+bool DeserializeLookupSnapshot(const std::string& data, std::vector<LookupSnapshotEntryUWP>& entries, int64_t& created);
@@ -0,0 +1,48 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Immutable versions of a shared value [Internal usage]
+// readers take the current version and never see partial updates,
+// writers copy it, apply changes and publish a new one (writers are serialized)
+
+#pragma once
+
+#include <mutex>
+#include <memory>
+
+template<typename T>
+class VersionedUWP {
+public:
+	VersionedUWP() : current(std::make_shared<T>()) {
+	}
+
+	VersionedUWP(const VersionedUWP&) = delete;
+	VersionedUWP& operator=(const VersionedUWP&) = delete;
+
+	// Safe to call from any thread, the version stays valid as long as it's held
+	std::shared_ptr<const T> Get() const {
+		return std::atomic_load(&current);
+	}
+
+	// Copy the current version, apply 'update' then publish the result
+	template<typename F>
+	void Update(F update) {
+		std::lock_guard<std::mutex> lock(writeLock);
+		auto next = std::make_shared<T>(*std::atomic_load(&current));
+		update(*next);
+		std::atomic_store(&current, std::shared_ptr<const T>(std::move(next)));
+	}
+
+	// Replace the whole value
+	void Publish(std::shared_ptr<const T> value) {
+		std::lock_guard<std::mutex> lock(writeLock);
+		std::atomic_store(&current, std::move(value));
+	}
+
+private:
+	std::shared_ptr<const T> current;
+	std::mutex writeLock;
+};
@@ -14,7 +14,8 @@
 extern "C" {
 #endif
 	void* CreateFileUWP(const char* path, int accessMode, int shareMode, int openMode) {
-		std::string fn = convert(path);
+		// Caller passes a wide string, it reaches the API without conversion
+		PathStringUWP fn((const wchar_t*)path);
 
 		return (void*)CreateFileUWP(fn, accessMode, shareMode, openMode);
 	}
@@ -23,7 +24,7 @@ extern "C" {
 		size_t size = sizeof(WIN32_FILE_ATTRIBUTE_DATA);
 		WIN32_FILE_ATTRIBUTE_DATA* file_attributes = (WIN32_FILE_ATTRIBUTE_DATA*)(malloc(size));
 
-		std::string fn = convert((const char*)name);
+		PathStringUWP fn((const wchar_t*)name);
 		HANDLE handle = CreateFileUWP(fn);
 
 		FILETIME createTime{};
@@ -78,11 +79,29 @@ extern "C" {
 	}
 
 	int DeleteFileUWP(const void* name) {
-		std::string fn = convert((const char*)name);
+		PathStringUWP fn((const wchar_t*)name);
 		bool state = DeleteUWP(fn);
 
 		return state ? 1 : 0;
 	}
+
+	int MountUWP(const void* root, const void* target) {
+		if (root == nullptr || target == nullptr) {
+			return 0;
+		}
+		bool state = MountUWP(std::wstring((const wchar_t*)root), std::wstring((const wchar_t*)target));
+
+		return state ? 1 : 0;
+	}
+
+	int UnmountUWP(const void* root) {
+		if (root == nullptr) {
+			return 0;
+		}
+		bool state = UnmountUWP(std::wstring((const wchar_t*)root));
+
+		return state ? 1 : 0;
+	}
 #ifdef __cplusplus
 }
 #endif
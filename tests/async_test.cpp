@@ -0,0 +1,156 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// StorageExecutor.h: 'PostWithLimitsUWP' (async versions) against a simulated broker
+
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include "StorageExecutor.h"
+#include "StorageLimits.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// 'PostWithLimitsUWP' completes a PPL task in 'StorageManager.cpp', same interface over std::promise here
+template<typename T>
+struct PromiseCompletion {
+	std::shared_ptr<std::promise<T>> promise = std::make_shared<std::promise<T>>();
+
+	void set(T value) const {
+		promise->set_value(std::move(value));
+	}
+	void set_exception(std::exception_ptr error) const {
+		promise->set_exception(error);
+	}
+};
+
+template<>
+struct PromiseCompletion<void> {
+	std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+
+	void set() const {
+		promise->set_value();
+	}
+	void set_exception(std::exception_ptr error) const {
+		promise->set_exception(error);
+	}
+};
+
+template<typename T>
+static std::future<T> RunOnLane(StorageExecutorUWP& executor, StorageLaneUWP lane, std::function<T()> work) {
+	PromiseCompletion<T> completion;
+	auto future = completion.promise->get_future();
+	PostWithLimitsUWP<T>(executor, lane, std::move(work), completion);
+	return future;
+}
+
+// Simulated broker call (sync version of an entry point), stops at the caller deadline
+static bool BrokerOpen(int latencyMs) {
+	auto end = steady_clock::now() + milliseconds(latencyMs);
+	while (steady_clock::now() < end) {
+		if (CheckStorageLimitsUWP() != STORAGE_CALL_COMPLETED) {
+			return false;
+		}
+		std::this_thread::sleep_for(milliseconds(1));
+	}
+	return true;
+}
+
+static void TestResultsAndErrors() {
+	StorageExecutorUWP executor(3, 1, 100);
+	auto value = RunOnLane<int>(executor, STORAGE_LANE_INTERACTIVE, []() { return 42; });
+	auto error = RunOnLane<int>(executor, STORAGE_LANE_NORMAL, []() -> int { throw std::runtime_error("access denied"); });
+	CHECK(value.get() == 42);
+	bool thrown = false;
+	try {
+		error.get();
+	}
+	catch (const std::runtime_error&) {
+		thrown = true;
+	}
+	CHECK(thrown);
+	// Worker survived the exception
+	CHECK(RunOnLane<int>(executor, STORAGE_LANE_NORMAL, []() { return 7; }).get() == 7);
+}
+
+// Limits of the caller follow the job to the worker thread, and only that job
+static void TestLimitsFollowJob() {
+	StorageExecutorUWP executor(3, 1, 100);
+	std::future<bool> bounded;
+	std::future<StorageCallResultUWP> seen;
+	{
+		StorageLimitScopeUWP limits(30);
+		bounded = RunOnLane<bool>(executor, STORAGE_LANE_INTERACTIVE, []() { return BrokerOpen(2000); });
+		seen = RunOnLane<StorageCallResultUWP>(executor, STORAGE_LANE_INTERACTIVE, []() {
+			CHECK(CurrentStorageLimitsUWP() != nullptr && CurrentStorageLimitsUWP()->HasDeadline());
+			return STORAGE_CALL_COMPLETED;
+		});
+	}
+	auto start = steady_clock::now();
+	CHECK(!bounded.get());
+	CHECK(ElapsedMs(start) < 1000 * TEST_SLOWDOWN);
+	CHECK(seen.get() == STORAGE_CALL_COMPLETED);
+
+	auto unbounded = RunOnLane<bool>(executor, STORAGE_LANE_INTERACTIVE, []() {
+		return CurrentStorageLimitsUWP() == nullptr && BrokerOpen(5);
+	});
+	CHECK(unbounded.get());
+
+	// Token canceled from another thread (UI button)
+	auto token = std::make_shared<CancelTokenUWP>();
+	std::future<bool> canceled;
+	{
+		StorageLimitScopeUWP limits(0, token);
+		canceled = RunOnLane<bool>(executor, STORAGE_LANE_NORMAL, []() { return BrokerOpen(2000); });
+	}
+	std::thread([token]() {
+		std::this_thread::sleep_for(milliseconds(20));
+		token->Cancel();
+	}).join();
+	CHECK(!canceled.get());
+}
+
+// Loader thread opening 10 files: serial sync calls vs async versions awaited together
+static void BenchmarkLoader() {
+	const int files = 10;
+	const int latency = 20;
+	auto start = steady_clock::now();
+	for (int i = 0; i < files; i++) {
+		CHECK(BrokerOpen(latency));
+	}
+	double serialMs = ElapsedMs(start);
+
+	StorageExecutorUWP executor(3, 1, 100);
+	start = steady_clock::now();
+	std::vector<std::future<bool>> opens;
+	for (int i = 0; i < files; i++) {
+		opens.push_back(RunOnLane<bool>(executor, STORAGE_LANE_INTERACTIVE, [latency]() { return BrokerOpen(latency); }));
+	}
+	// Posting never blocks the caller (UI thread)
+	double postMs = ElapsedMs(start);
+	for (auto& open : opens) {
+		CHECK(open.get());
+	}
+	double asyncMs = ElapsedMs(start);
+
+	std::printf("10 opens (%dms broker): serial %.1fms, async %.1fms (posted in %.3fms)\n", latency, serialMs, asyncMs, postMs);
+	CHECK(postMs < latency * TEST_SLOWDOWN);
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(asyncMs * 2 < serialMs);
+	}
+}
+
+int main() {
+	TestResultsAndErrors();
+	TestLimitsFollowJob();
+	BenchmarkLoader();
+	std::printf("async_test: OK\n");
+	return 0;
+}
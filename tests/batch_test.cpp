@@ -0,0 +1,131 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// BatchRunnerUWP: bounded fan-out against a simulated broker, result order, errors and the 50/500 item cases
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "StorageBatch.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Simulated broker: each call completes after 'latency' on its own thread
+class Broker {
+public:
+	explicit Broker(int latency) : latency(latency) {
+	}
+
+	~Broker() {
+		std::lock_guard<std::mutex> lock(threadsLock);
+		for (auto& thread : threads) {
+			thread.join();
+		}
+	}
+
+	void Call(std::function<void()> done) {
+		int current = ++inFlight;
+		int seen = peak.load();
+		while (current > seen && !peak.compare_exchange_weak(seen, current)) {
+		}
+		std::lock_guard<std::mutex> lock(threadsLock);
+		threads.emplace_back([this, done]() {
+			std::this_thread::sleep_for(milliseconds(latency));
+			inFlight--;
+			done();
+		});
+	}
+
+	std::atomic<int> peak{ 0 };
+
+private:
+	int latency;
+	std::atomic<int> inFlight{ 0 };
+	std::mutex threadsLock;
+	std::vector<std::thread> threads;
+};
+
+// WinRT classes have no default value
+struct NoDefault {
+	explicit NoDefault(int value) : value(value) {
+	}
+	int value;
+};
+
+// Candidate folders / files of a copy: some fail, some are skipped without a call
+static void TestFanOut(int items) {
+	const int latency = 2;
+	double sequentialMs;
+	{
+		Broker broker(latency);
+		auto start = steady_clock::now();
+		for (int i = 0; i < items; i++) {
+			WaitSignalUWP signal;
+			broker.Call([&signal]() { signal.Set(); });
+			signal.Wait(nullptr);
+		}
+		sequentialMs = ElapsedMs(start);
+	}
+
+	Broker broker(latency);
+	auto start = steady_clock::now();
+	auto runner = std::make_shared<BatchRunnerUWP<NoDefault>>(items, NoDefault(-1));
+	runner->Start([&broker](size_t i, std::shared_ptr<BatchRunnerUWP<NoDefault>> run) {
+		if (i % 7 == 3) {
+			run->Complete(i, NoDefault(-1), false, 0);
+			return;
+		}
+		broker.Call([i, run]() {
+			bool denied = i % 11 == 5;
+			run->Complete(i, NoDefault((int)i), !denied, denied ? (int32_t)0x80070005 : 0);
+		});
+	}, 8);
+	CHECK(runner->Wait() == STORAGE_CALL_COMPLETED);
+	double batchMs = ElapsedMs(start);
+
+	auto results = runner->Results();
+	CHECK(results.size() == (size_t)items);
+	for (size_t i = 0; i < results.size(); i++) {
+		if (i % 7 == 3) {
+			CHECK(!results[i].succeeded && results[i].value.value == -1 && results[i].error == 0);
+		}
+		else {
+			CHECK(results[i].value.value == (int)i);
+			CHECK(results[i].succeeded == (i % 11 != 5));
+			CHECK(results[i].error == (i % 11 == 5 ? (int32_t)0x80070005 : 0));
+		}
+	}
+	std::printf("%d items (%dms broker): one wait per call %.1fms, batch of 8 %.1fms, peak in flight %d\n",
+		items, latency, sequentialMs, batchMs, broker.peak.load());
+	CHECK(broker.peak <= 8);
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(batchMs * 3 < sequentialMs);
+	}
+}
+
+// Operations completing on the launching thread must not nest launches
+static void TestSynchronousCompletions() {
+	auto runner = std::make_shared<BatchRunnerUWP<int>>(200000, 0);
+	runner->Start([](size_t i, std::shared_ptr<BatchRunnerUWP<int>> run) { run->Complete(i, (int)i, true, 0); }, 4);
+	CHECK(runner->Wait() == STORAGE_CALL_COMPLETED);
+	auto results = runner->Results();
+	CHECK(results[199999].value == 199999 && results[199999].succeeded);
+
+	auto empty = std::make_shared<BatchRunnerUWP<int>>(0, 0);
+	empty->Start([](size_t, std::shared_ptr<BatchRunnerUWP<int>>) { CHECK(false); }, 8);
+	CHECK(empty->Wait() == STORAGE_CALL_COMPLETED);
+	CHECK(empty->Results().empty());
+}
+
+int main() {
+	TestFanOut(50);
+	TestFanOut(500);
+	TestSynchronousCompletions();
+	std::printf("batch_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,370 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// StorageCache.h: negative cache invalidation, resolved items invalidation,
+// learned access tiers, name index and drive access states
+
+#include <set>
+#include <random>
+#include <thread>
+
+#include "StorageCache.h"
+#include "StoragePath.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Random marks and invalidations against a plain set, filters are rebuilt many times on the way
+static void TestNegativeCacheModel() {
+	const size_t capacity = 1 << 14; // No LRU eviction, the model doesn't have it
+	NegativeCacheUWP cache(capacity, 0);
+	std::set<std::string> model;
+	std::mt19937 random(11);
+	const char* names[] = { "a", "b", "saves", "x.ini", "y.bin" };
+	auto randomPath = [&]() {
+		std::string path = "d:/games";
+		size_t depth = random() % 4;
+		for (size_t i = 0; i < depth; i++) {
+			path += "/";
+			path += names[random() % 5];
+		}
+		if (random() % 8 == 0) {
+			path += "/";
+		}
+		return path;
+	};
+	for (int i = 0; i < 200000; i++) {
+		std::string path = randomPath();
+		switch (random() % 3) {
+		case 0:
+			if (path.back() != '/') {
+				cache.MarkMissing(path);
+				model.insert(path);
+			}
+			break;
+		case 1:
+			cache.Invalidate(path);
+			for (auto iter = model.begin(); iter != model.end();) {
+				iter = IsCacheKeyInTree(*iter, path) ? model.erase(iter) : std::next(iter);
+			}
+			break;
+		default:
+			CHECK(cache.IsMissing(path) == (model.count(path) > 0));
+			break;
+		}
+	}
+	cache.Invalidate("");
+	CHECK(cache.Stats().size == 0);
+}
+
+// Writes to folders without missing items below them must not scan the LRU
+static void BenchmarkInvalidate() {
+	const size_t entries = 4096;
+	NegativeCacheUWP cache(entries, 0);
+	for (size_t i = 0; i < entries; i++) {
+		cache.MarkMissing("c:/data/config/missing" + std::to_string(i) + ".ini");
+	}
+	const int writes = 20000;
+	std::vector<std::string> paths;
+	for (int i = 0; i < writes; i++) {
+		paths.push_back("c:/data/saves/slot" + std::to_string(i) + ".bin");
+	}
+	auto start = steady_clock::now();
+	for (auto& path : paths) {
+		cache.Invalidate(path);
+	}
+	double perWrite = ElapsedMs(start) * 1000.0 / writes;
+	std::printf("invalidate with %zu missing entries: %.3fus per write\n", entries, perWrite);
+	CHECK(cache.Stats().size == entries);
+	// A scan over 4096 entries takes tens of microseconds
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(perWrite < 5.0);
+	}
+
+	// Creating the folder itself still clears the whole subtree
+	cache.Invalidate("c:/data/config");
+	CHECK(cache.Stats().size == 0);
+	CHECK(!cache.IsMissing("c:/data/config/missing1.ini"));
+}
+
+// Resolved items and missing paths as 'StorageManager.cpp' keeps them
+// keys come from absolute paths, resolving them only normalizes ('PathResolver')
+struct ManagerCaches {
+	LRUCacheUWP<int> resolved{ 64 };
+	NegativeCacheUWP missing{ 64, 0 };
+
+	static std::string Key(const std::string& path) {
+		std::string key = PathUWP(path).ToString();
+		FoldCacheKey(key);
+		return key;
+	}
+	bool Get(const std::string& path, int& item) {
+		return resolved.Get(Key(path), item);
+	}
+	void Put(const std::string& path, int item) {
+		resolved.Put(Key(path), item);
+	}
+	void Forget(const std::string& path) {
+		resolved.EraseTree(Key(path));
+	}
+
+	// Same order of calls as 'DeleteUWP', 'MoveUWP', 'RenameUWP' and 'CreateFileUWP'
+	void Delete(const std::string& path) {
+		Forget(path);
+	}
+	void Move(const std::string& path, const std::string& dest) {
+		missing.Invalidate(Key(dest));
+		Forget(path);
+		Forget(dest);
+	}
+	void Create(const std::string& path, int item) {
+		missing.Invalidate(Key(path));
+		if (!missing.IsMissing(Key(path))) {
+			Put(path, item);
+		}
+	}
+};
+
+static void TestResolvedInvalidation() {
+	ManagerCaches caches;
+	int item = 0;
+
+	// Delete drops the item and anything resolved below it, whatever the spelling
+	caches.Put("C:/Games/Saves", 1);
+	caches.Put("C:/Games/Saves/slot1.bin", 2);
+	caches.Put("C:/Games/SavesOld", 3);
+	caches.Delete("c:\\games\\SAVES");
+	CHECK(!caches.Get("C:/Games/Saves", item));
+	CHECK(!caches.Get("C:/Games/Saves/slot1.bin", item));
+	CHECK(caches.Get("C:/Games/SavesOld", item) && item == 3);
+
+	// Rename in the same folder, old name is gone, new one resolves again
+	caches.Put("C:/Games/a.ini", 4);
+	caches.Put("C:/Games/b.ini", 5);
+	caches.Move("C:/Games/a.ini", "C:/Games/B.INI");
+	CHECK(!caches.Get("C:/Games/a.ini", item));
+	CHECK(!caches.Get("C:/Games/b.ini", item));
+	CHECK(caches.Get("C:/Games/SavesOld", item));
+
+	// Move of a folder to another folder, both trees are dropped
+	caches.Put("C:/Games/SavesOld/slot2.bin", 6);
+	caches.Put("D:/Backup/SavesOld/slot9.bin", 7);
+	caches.Put("D:/Backup/other.bin", 8);
+	caches.Move("C:/Games/SavesOld", "D:/Backup/SavesOld");
+	CHECK(!caches.Get("C:/Games/SavesOld", item));
+	CHECK(!caches.Get("C:/Games/SavesOld/slot2.bin", item));
+	CHECK(!caches.Get("D:/Backup/SavesOld/slot9.bin", item));
+	CHECK(caches.Get("D:/Backup/other.bin", item) && item == 8);
+
+	// Create after a cached miss, the miss must not hide the new item
+	caches.missing.MarkMissing(ManagerCaches::Key("C:/Games/new.cfg"));
+	CHECK(caches.missing.IsMissing(ManagerCaches::Key("c:/games/NEW.cfg")));
+	caches.Create("C:/Games/New.cfg", 9);
+	CHECK(!caches.missing.IsMissing(ManagerCaches::Key("C:/Games/new.cfg")));
+	CHECK(caches.Get("c:/games/new.cfg", item) && item == 9);
+
+	// Creating a folder clears the misses below it too
+	caches.missing.MarkMissing(ManagerCaches::Key("C:/Data/x/y.bin"));
+	caches.Move("C:/Temp/x", "C:/Data/x");
+	CHECK(!caches.missing.IsMissing(ManagerCaches::Key("C:/Data/x/y.bin")));
+}
+
+const uint32_t tierFailures = 3;
+
+// API failed and fallback worked enough times, root switches to fallback
+static void Learn(TierStrategyUWP& tiers, const std::string& root) {
+	for (uint32_t i = 0; i < tierFailures; i++) {
+		CHECK(tiers.ShouldTryAPI(root));
+		tiers.ReportAPI(root, false);
+		tiers.ReportFallback(root, true, TIER_RESULT_SUCCESS);
+	}
+}
+
+static void TestLearnAndReprobe() {
+	TierStrategyUWP tiers(8, 60000, tierFailures);
+	CHECK(tiers.ShouldTryAPI(""));
+	Learn(tiers, "D:/Games");
+	CHECK(!tiers.ShouldTryAPI("D:/Games"));
+	CHECK(tiers.Stats().switches == 1);
+
+	// API working again (reprobe) takes the root back
+	TierStrategyUWP quick(8, 0, tierFailures);
+	Learn(quick, "D:/Games");
+	CHECK(quick.ShouldTryAPI("D:/Games"));
+	quick.ReportAPI("D:/Games", true);
+	CHECK(quick.ShouldTryAPI("D:/Games"));
+	CHECK(quick.Stats().reprobes == 1);
+}
+
+// Single API failures (locked file, sharing violation) keep the root on API
+static void TestTransientFailures() {
+	TierStrategyUWP tiers(8, 60000, tierFailures);
+	auto fail = [&]() {
+		CHECK(tiers.ShouldTryAPI("D:/Games"));
+		tiers.ReportAPI("D:/Games", false);
+		tiers.ReportFallback("D:/Games", true, TIER_RESULT_SUCCESS);
+	};
+	fail();
+	CHECK(tiers.ShouldTryAPI("D:/Games"));
+	fail();
+	// API success in between starts the count again
+	tiers.ReportAPI("D:/Games", true);
+	fail();
+	fail();
+	CHECK(tiers.ShouldTryAPI("D:/Games"));
+	CHECK(tiers.Stats().switches == 0);
+
+	// Missing items neither count nor reset
+	tiers.ReportFallback("D:/Games", true, TIER_RESULT_NOT_FOUND);
+	fail();
+	CHECK(!tiers.ShouldTryAPI("D:/Games"));
+	CHECK(tiers.Stats().switches == 1);
+}
+
+// Probes for missing files must not undo the learned tier
+static void TestMissingKeepsTier() {
+	TierStrategyUWP tiers(8, 60000, tierFailures);
+	Learn(tiers, "D:/Games");
+	for (int i = 0; i < 100; i++) {
+		CHECK(!tiers.ShouldTryAPI("D:/Games"));
+		tiers.ReportFallback("D:/Games", false, TIER_RESULT_NOT_FOUND);
+	}
+	CHECK(!tiers.ShouldTryAPI("D:/Games"));
+	CHECK(tiers.Stats().switches == 1);
+
+	// Missing on both tiers doesn't switch either
+	tiers.ReportFallback("E:/Other", true, TIER_RESULT_NOT_FOUND);
+	CHECK(tiers.ShouldTryAPI("E:/Other"));
+
+	// Real fallback failure lets API decide again
+	tiers.ReportFallback("D:/Games", false, TIER_RESULT_FAILED);
+	CHECK(tiers.ShouldTryAPI("D:/Games"));
+}
+
+// Overflow evicts one root, the others stay learned
+static void TestEvictOne() {
+	const size_t capacity = 4;
+	TierStrategyUWP tiers(capacity, 60000, tierFailures);
+	for (size_t i = 0; i < capacity; i++) {
+		Learn(tiers, "D:/Root" + std::to_string(i));
+	}
+	// Root back on API is the first to go
+	tiers.ReportAPI("D:/Root2", true);
+	Learn(tiers, "D:/New");
+	CHECK(tiers.Stats().roots == capacity);
+	CHECK(tiers.ShouldTryAPI("D:/Root2"));
+	for (size_t i : { 0, 1, 3 }) {
+		CHECK(!tiers.ShouldTryAPI("D:/Root" + std::to_string(i)));
+	}
+	CHECK(!tiers.ShouldTryAPI("D:/New"));
+
+	// Then the one probed longest ago
+	Learn(tiers, "D:/Newer");
+	CHECK(tiers.Stats().roots == capacity);
+	size_t learned = 0;
+	for (auto root : { "D:/Root0", "D:/Root1", "D:/Root3", "D:/New", "D:/Newer" }) {
+		learned += tiers.ShouldTryAPI(root) ? 0 : 1;
+	}
+	CHECK(learned == capacity);
+	CHECK(tiers.ShouldTryAPI("D:/Root0"));
+}
+
+// Drive access states ('DriveAccessStates'), entries expire after the TTL
+// and are dropped all at once when the lookup list is reset
+static void TestShardedCache() {
+	ShardedCacheUWP<bool, 4> cache(50 * TEST_SLOWDOWN);
+	bool state = false;
+	CHECK(!cache.Get("c:", state));
+	for (char drive = 'a'; drive <= 'z'; drive++) {
+		cache.Put(std::string(1, drive) + ":", drive % 2 == 0);
+	}
+	for (char drive = 'a'; drive <= 'z'; drive++) {
+		CHECK(cache.Get(std::string(1, drive) + ":", state) && state == (drive % 2 == 0));
+	}
+	cache.Put("c:", true);
+	CHECK(cache.Get("c:", state) && state);
+
+	// Probed again after the TTL, fresh entries stay
+	std::this_thread::sleep_for(milliseconds(80 * TEST_SLOWDOWN));
+	cache.Put("d:", true);
+	CHECK(!cache.Get("c:", state));
+	CHECK(!cache.Get("z:", state));
+	CHECK(cache.Get("d:", state) && state);
+
+	cache.Clear();
+	CHECK(!cache.Get("d:", state));
+
+	// Sweep tasks and callers share the cache
+	ShardedCacheUWP<bool> shared(0);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++) {
+		threads.emplace_back([&shared, t]() {
+			for (int i = 0; i < 10000; i++) {
+				std::string key = std::to_string((i + t) % 26);
+				bool value = false;
+				if (!shared.Get(key, value)) {
+					shared.Put(key, ((i + t) % 26) % 3 == 0);
+				}
+				else {
+					CHECK(value == (((i + t) % 26) % 3 == 0));
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	for (int i = 0; i < 26; i++) {
+		CHECK(shared.Get(std::to_string(i), state) && state == (i % 3 == 0));
+	}
+}
+
+static void TestNameIndex() {
+	NameIndexUWP index(2, 3, 50);
+	std::string realName;
+	CHECK(!index.Lookup("c:/a", "X", realName));
+	index.Build("c:/a", { "Data", "ABC.png" });
+	CHECK(index.Lookup("c:/a", "data", realName) && realName == "Data");
+	CHECK(index.Lookup("c:/a", "abc.PNG", realName) && realName == "ABC.png");
+	CHECK(index.Lookup("c:/a", "nope", realName) && realName.empty());
+	index.AddName("c:/a", "New.txt");
+	CHECK(index.Lookup("c:/a", "new.TXT", realName) && realName == "New.txt");
+
+	// Too big folders give back the requested name as is
+	index.AddName("c:/a", "more");
+	CHECK(index.Lookup("c:/a", "Whatever", realName) && realName == "Whatever");
+	index.Build("c:/a", { "x", "y", "z", "w" });
+	CHECK(index.Lookup("c:/a", "Q", realName) && realName == "Q");
+
+	index.Build("c:/a", { "One" });
+	index.RemoveName("c:/a", "ONE");
+	CHECK(index.Lookup("c:/a", "one", realName) && realName.empty());
+
+	// LRU of 2 folders, 'c:/a' is evicted
+	index.Build("c:/a/b", { "k" });
+	index.Build("c:/ab", { "k" });
+	CHECK(!index.Lookup("c:/a", "one", realName));
+	index.Build("c:/a", { "k" });
+	CHECK(index.EraseTree("c:/a") == 1);
+	CHECK(index.Lookup("c:/ab", "K", realName) && realName == "k");
+
+	std::this_thread::sleep_for(milliseconds(80));
+	CHECK(!index.Lookup("c:/ab", "K", realName));
+}
+
+int main() {
+	TestNegativeCacheModel();
+	BenchmarkInvalidate();
+	TestResolvedInvalidation();
+	TestLearnAndReprobe();
+	TestTransientFailures();
+	TestMissingKeepsTier();
+	TestEvictOne();
+	TestNameIndex();
+	TestShardedCache();
+	std::printf("cache_test: OK\n");
+	return 0;
+}
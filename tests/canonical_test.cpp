@@ -0,0 +1,169 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// CanonicalizePathUWP: known cases and properties against a segment stack reference
+
+#include <random>
+#include <vector>
+#include <cctype>
+
+#include "StoragePath.h"
+#include "TestUtils.h"
+
+static bool IsSeparator(char c) {
+	return c == '/' || c == '\\';
+}
+
+// Reference: split root, push/pop segments, join with '/'
+static std::string RefCanonicalize(const std::string& input) {
+	if (input.empty()) {
+		return input;
+	}
+	std::string root;
+	size_t i = 0;
+	bool rooted = true;
+	bool separateFirst = true;
+	if (input.size() >= 2 && IsSeparator(input[0]) && IsSeparator(input[1])) {
+		root = "//";
+		i = 2;
+		for (int part = 0; part < 2; part++) {
+			while (i < input.size() && IsSeparator(input[i])) {
+				i++;
+			}
+			if (i >= input.size()) {
+				break;
+			}
+			if (part > 0) {
+				root += '/';
+			}
+			while (i < input.size() && !IsSeparator(input[i])) {
+				root += input[i++];
+			}
+		}
+		separateFirst = root.size() > 2;
+	}
+	else if (input.size() >= 2 && input[1] == ':' && std::isalpha((unsigned char)input[0])) {
+		root = input.substr(0, 2);
+		i = 2;
+		separateFirst = i < input.size() && IsSeparator(input[i]);
+	}
+	else if (IsSeparator(input[0])) {
+		root = "/";
+		i = 1;
+		separateFirst = false;
+	}
+	else {
+		rooted = false;
+		separateFirst = false;
+	}
+
+	std::vector<std::string> segments;
+	while (i < input.size()) {
+		while (i < input.size() && IsSeparator(input[i])) {
+			i++;
+		}
+		size_t start = i;
+		while (i < input.size() && !IsSeparator(input[i])) {
+			i++;
+		}
+		std::string segment = input.substr(start, i - start);
+		if (segment.empty() || segment == ".") {
+			continue;
+		}
+		if (segment == "..") {
+			if (!segments.empty() && segments.back() != "..") {
+				segments.pop_back();
+				continue;
+			}
+			if (rooted) {
+				continue;
+			}
+		}
+		segments.push_back(segment);
+	}
+
+	std::string output = root;
+	for (size_t k = 0; k < segments.size(); k++) {
+		if (k > 0 || separateFirst) {
+			output += '/';
+		}
+		output += segments[k];
+	}
+	if (output.empty()) {
+		return ".";
+	}
+	if (!rooted && output.size() >= 2 && output[1] == ':' && std::isalpha((unsigned char)output[0])) {
+		output = "./" + output;
+	}
+	return output;
+}
+
+static void TestKnownCases() {
+	struct {
+		const char* input;
+		const char* output;
+	} cases[] = {
+		{ "C:/Games/../Games/x.iso", "C:/Games/x.iso" }, { "C://Games//x.iso", "C:/Games/x.iso" }, { "C:\\Games\\x.iso", "C:/Games/x.iso" },
+		{ "C:/..", "C:" }, { "C:/../../a", "C:/a" }, { "/..", "/" }, { "/a/./b/..", "/a" }, { "a/..", "." }, { "../a", "../a" },
+		{ "a/../../b", "../b" }, { "//server/share/../x", "//server/share/x" }, { "//./COM1", "//./COM1" }, { "C:a/../b", "C:b" },
+		{ "C:/", "C:" }, { "//", "//" }, { "./", "." }, { "..", ".." }, { "../..", "../.." }, { "a/../c:x", "./c:x" },
+	};
+	for (auto& test : cases) {
+		std::string path = test.input;
+		CanonicalizePathUWP(path);
+		CHECK(path == test.output);
+	}
+
+	CHECK(HasDotSegmentsUWP("C:/a/../b"));
+	CHECK(HasDotSegmentsUWP("./a"));
+	CHECK(!HasDotSegmentsUWP("C:/a/.b/c..d"));
+
+	// PathUWP keys share the canonical form
+	CHECK(PathUWP(std::string("C:\\Games\\..\\Games\\x.iso")).ToString() == "C:/Games/x.iso");
+	CHECK(PathUWP(std::string("\\\\?\\C:\\a\\.\\b\\..")).ToString() == "C:/a");
+	CHECK(PathUWP(std::string("\\\\?\\UNC\\srv\\share\\..\\..\\x")).ToString() == "//srv/share/x");
+	CHECK(PathUWP(std::string("C:\\..")).ToString() == "C:");
+	CHECK(PathUWP(std::string("/a/..")).ToString() == "/");
+	CHECK(PathUWP(std::string("http://x/../y")).ToString() == "http://x/../y");
+	CHECK(PathUWP(std::string("C:/a/./b")) == PathUWP(std::string("C:\\a\\x\\..\\b\\")));
+}
+
+// Random atoms: matches the reference, idempotent, separator independent and never longer
+static void FuzzProperties() {
+	const char* atoms[] = { "/", "\\", ".", "..", "a", "B", "c:", "C:", "x.iso", "//", "\\\\" };
+	std::mt19937 random(7);
+	for (int i = 0; i < 500000; i++) {
+		std::string input;
+		int count = random() % 10;
+		for (int k = 0; k < count; k++) {
+			input += atoms[random() % 11];
+		}
+
+		std::string path = input;
+		CanonicalizePathUWP(path);
+		CHECK(path == RefCanonicalize(input));
+
+		std::string again = path;
+		CanonicalizePathUWP(again);
+		CHECK(again == path);
+
+		std::string windows = input;
+		CanonicalizePathUWP(windows, '\\');
+		for (auto& c : windows) {
+			c = (c == '\\') ? '/' : c;
+		}
+		CHECK(windows == path);
+
+		CHECK(path.size() <= input.size() || path == ".");
+	}
+}
+
+int main() {
+	TestKnownCases();
+	FuzzProperties();
+	std::printf("canonical_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,163 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// StoragePathCompare.h: differential fuzz against a plain copy-and-lower reference
+
+#include <random>
+#include <algorithm>
+
+#include "StoragePathCompare.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Reference: folded copies with '\' separators and no trailing separator
+static std::string Normalize(std::string path, bool asciiOnly) {
+	if (asciiOnly) {
+		for (auto& c : path) {
+			if (c >= 'A' && c <= 'Z') {
+				c = (char)(c + 32);
+			}
+		}
+	}
+	else {
+		FoldCaseUWP(path);
+	}
+	std::replace(path.begin(), path.end(), '/', '\\');
+	while (path.size() > 1 && path.back() == '\\') {
+		path.pop_back();
+	}
+	return path;
+}
+
+static bool RefStartsWith(const std::string& path, const std::string& parent) {
+	if (parent.empty()) {
+		return false;
+	}
+	if (path.compare(0, parent.size(), parent) != 0) {
+		return false;
+	}
+	return path.size() == parent.size() || path[parent.size()] == '\\' || parent.back() == '\\';
+}
+
+static std::string RandomPath(std::mt19937& random, const char* const* alphabet, size_t letters, size_t maxLength) {
+	std::string path;
+	size_t length = random() % maxLength;
+	for (size_t i = 0; i < length; i++) {
+		path += alphabet[random() % letters];
+	}
+	return path;
+}
+
+// Second side is often a prefix of the first one with changed case/separators (SIMD blocks + tails)
+static std::string Related(std::mt19937& random, const std::string& path) {
+	std::string other = path.substr(0, random() % (path.size() + 1));
+	for (auto& c : other) {
+		if (random() % 4 == 0) {
+			if (c >= 'a' && c <= 'z') {
+				c = (char)(c - 32);
+			}
+			else if (c == '/') {
+				c = '\\';
+			}
+		}
+	}
+	return other;
+}
+
+static void FuzzASCII() {
+	const char* alphabet[] = { "a", "A", "b", "B", "/", "\\", "c", "Z", "." };
+	std::mt19937 random(1);
+	for (int i = 0; i < 300000; i++) {
+		std::string x = RandomPath(random, alphabet, 9, 48);
+		std::string y = (random() % 2) ? Related(random, x) : RandomPath(random, alphabet, 9, 48);
+		std::string nx = Normalize(x, true);
+		std::string ny = Normalize(y, true);
+		CHECK(PathEqualsUWP(x, y) == (nx == ny));
+		CHECK(PathStartsWithUWP(x, y) == RefStartsWith(nx, ny));
+	}
+}
+
+// Multi-byte folds (Kelvin sign, long s, sigma forms) and invalid bytes
+static void FuzzUTF8() {
+	const char* alphabet[] = { "a", "A", "s", "S", "\xC5\xBF", "k", "K", "\xE2\x84\xAA", "\xC3\x84", "\xC3\xA4",
+		"\xCE\xA3", "\xCF\x83", "\xCF\x82", "/", "\\", "x", "\xFF", "\xC3" };
+	std::mt19937 random(2);
+	for (int i = 0; i < 300000; i++) {
+		std::string x = RandomPath(random, alphabet, 18, 30);
+		std::string y;
+		if (random() % 2) {
+			y = RandomPath(random, alphabet, 18, 30);
+		}
+		else {
+			y = x;
+			for (auto& c : y) {
+				if (c == 'a' && random() % 2) {
+					c = 'A';
+				}
+			}
+		}
+		std::string nx = Normalize(x, false);
+		std::string ny = Normalize(y, false);
+		CHECK(PathEqualsUWP(x, y) == (nx == ny));
+		CHECK(PathStartsWithUWP(x, y) == RefStartsWith(nx, ny));
+	}
+}
+
+static void TestKnownCases() {
+	CHECK(PathStartsWithUWP("C:\\Games\\PSP", "c:/games"));
+	CHECK(!PathStartsWithUWP("C:\\GamesX", "C:\\Games"));
+	CHECK(PathIsDirectChildUWP("C:\\Games", "c:/games/psp"));
+	CHECK(!PathIsDirectChildUWP("C:\\Games", "c:/games/psp/x"));
+	CHECK(!PathIsDirectChildUWP("C:\\Games", "c:/games"));
+	CHECK(PathIsDirectChildUWP("/", "/a"));
+	CHECK(PathIsDirectChildUWP("C:\\", "C:\\a"));
+	CHECK(PathEqualsUWP("D:\\\xC3\x84rger\\\xCE\xA3\xCE\x9F\xCE\xA6\xCE\x99\xCE\x91", "d:/\xC3\xA4rger/\xCF\x83\xCE\xBF\xCF\x86\xCE\xB9\xCE\xB1/"));
+	CHECK(PathStartsWithUWP("D:\\Stra\xC5\xBFse\\x", "d:/strasse"));
+	CHECK(PathEqualsUWP("C:\\\xE2\x84\xAA", "c:/k"));
+	CHECK(FoldCodePointUWP('A') == 'a');
+	CHECK(FoldCodePointUWP(0x212A) == 'k');
+	CHECK(FoldCodePointUWP(0x03A3) == 0x03C3);
+	CHECK(FoldCodePointUWP(0x03C2) == 0x03C3);
+}
+
+// Typical LocalState path, equal except for case and separators
+static void BenchmarkEquals() {
+	std::string lower = "C:/Users/SomeUser/AppData/Local/Packages/Very.Long.Package.Name_abcdefgh/LocalState/Games/PSP/GAME/File.iso";
+	std::string upper = lower;
+	for (auto& c : upper) {
+		c = (c >= 'a' && c <= 'z') ? (char)(c - 32) : (c == '/' ? '\\' : c);
+	}
+	const int rounds = 500000;
+	int matches = 0;
+
+	auto start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		matches += Normalize(lower, true) == Normalize(upper, true);
+	}
+	double copyMs = ElapsedMs(start);
+
+	start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		matches += PathEqualsUWP(lower, upper);
+	}
+	double compareMs = ElapsedMs(start);
+
+	std::printf("equals (%zu chars): lowered copies %.3fus, PathEqualsUWP %.3fus\n", lower.size(), copyMs * 1000 / rounds, compareMs * 1000 / rounds);
+	CHECK(matches == rounds * 2);
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(compareMs < copyMs);
+	}
+}
+
+int main() {
+	TestKnownCases();
+	FuzzASCII();
+	FuzzUTF8();
+	BenchmarkEquals();
+	std::printf("compare_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,197 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// StorageEncoding.h: transcoder fuzz against a byte by byte decoder, validation and WideStringUWP
+
+#include <random>
+#include <vector>
+
+#include "StorageEncoding.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Reference decoder, invalid sequences become U+FFFD (maximal subpart)
+static std::u16string RefUTF8ToUTF16(const std::string& input) {
+	std::u16string output;
+	const unsigned char* bytes = (const unsigned char*)input.data();
+	size_t size = input.size();
+	size_t i = 0;
+	while (i < size) {
+		unsigned lead = bytes[i];
+		if (lead < 0x80) {
+			output += (char16_t)lead;
+			i++;
+			continue;
+		}
+		int need;
+		unsigned codePoint;
+		unsigned low = 0x80, high = 0xBF;
+		if (lead >= 0xC2 && lead <= 0xDF) {
+			need = 1;
+			codePoint = lead & 0x1F;
+		}
+		else if (lead >= 0xE0 && lead <= 0xEF) {
+			need = 2;
+			codePoint = lead & 0x0F;
+			low = lead == 0xE0 ? 0xA0 : low;
+			high = lead == 0xED ? 0x9F : high;
+		}
+		else if (lead >= 0xF0 && lead <= 0xF4) {
+			need = 3;
+			codePoint = lead & 0x07;
+			low = lead == 0xF0 ? 0x90 : low;
+			high = lead == 0xF4 ? 0x8F : high;
+		}
+		else {
+			output += (char16_t)0xFFFD;
+			i++;
+			continue;
+		}
+		i++;
+		bool invalid = false;
+		for (int k = 0; k < need; k++) {
+			if (i >= size || bytes[i] < low || bytes[i] > high) {
+				invalid = true;
+				break;
+			}
+			codePoint = (codePoint << 6) | (bytes[i] & 0x3F);
+			low = 0x80;
+			high = 0xBF;
+			i++;
+		}
+		if (invalid) {
+			output += (char16_t)0xFFFD;
+		}
+		else if (codePoint >= 0x10000) {
+			codePoint -= 0x10000;
+			output += (char16_t)(0xD800 + (codePoint >> 10));
+			output += (char16_t)(0xDC00 + (codePoint & 0x3FF));
+		}
+		else {
+			output += (char16_t)codePoint;
+		}
+	}
+	return output;
+}
+
+static std::u16string ToUTF16(const std::string& input) {
+	std::u16string output(GetUTF16CapacityUWP(input.size()), 0);
+	output.resize(UTF8ToUTF16UWP(input, &output[0]));
+	return output;
+}
+
+static std::string ToUTF8(const std::u16string& input) {
+	std::string output(GetUTF8CapacityUWP(input.size()), 0);
+	output.resize(UTF16ToUTF8UWP(std::u16string_view(input), &output[0]));
+	return output;
+}
+
+// Mostly ASCII runs (vector path) broken by random bytes
+static void FuzzUTF8() {
+	std::mt19937 random(1);
+	for (int i = 0; i < 300000; i++) {
+		size_t length = random() % 80;
+		std::string input;
+		for (size_t k = 0; k < length; k++) {
+			input += (char)((random() % 4 < 2) ? random() % 0x80 : random() % 256);
+		}
+		std::u16string output = ToUTF16(input);
+		CHECK(output == RefUTF8ToUTF16(input));
+
+		// Output is valid now, it must survive a round trip
+		std::string back = ToUTF8(output);
+		CHECK(IsValidUTF8UWP(back));
+		CHECK(ToUTF16(back) == output);
+		CHECK(IsValidUTF8UWP(input) == (back == input));
+	}
+}
+
+// Lone surrogates must not produce invalid UTF-8
+static void FuzzUTF16() {
+	std::mt19937 random(2);
+	for (int i = 0; i < 100000; i++) {
+		size_t length = random() % 60;
+		std::u16string input;
+		for (size_t k = 0; k < length; k++) {
+			int kind = random() % 3;
+			input += (char16_t)(kind == 0 ? random() % 0x80 : kind == 1 ? 0xD800 + random() % 0x800 : random() % 0x10000);
+		}
+		CHECK(IsValidUTF8UWP(ToUTF8(input)));
+	}
+}
+
+static void TestValidation() {
+	CHECK(IsValidUTF8UWP(""));
+	CHECK(IsValidUTF8UWP("\xEF\xBF\xBD"));
+	CHECK(IsValidUTF8UWP("\xF0\x9F\x98\x80"));
+	CHECK(!IsValidUTF8UWP("\xC0\x80")); // Overlong
+	CHECK(!IsValidUTF8UWP("\xED\xA0\x80")); // Surrogate
+	CHECK(!IsValidUTF8UWP("\xF4\x90\x80\x80")); // Above U+10FFFF
+	CHECK(!IsValidUTF8UWP("\xE2\x82")); // Truncated
+	CHECK(ToUTF16("a\xE2\x82" "b") == u"a\xFFFD" "b");
+}
+
+static void TestWideString() {
+	std::string path = "C:\\Users\\\xC3\x9Cn\xC3\xAF\\\xF0\x9F\x98\x80" "file.txt";
+	WideStringUWP wide = UTF8ToWideStringUWP(path);
+	CHECK(wide.c_str()[wide.size()] == 0);
+	std::string back;
+	WideToUTF8UWP(std::wstring_view(wide.c_str(), wide.size()), back);
+	CHECK(back == path);
+	std::wstring wideString;
+	UTF8ToWideUWP(path, wideString);
+	CHECK(wideString == std::wstring(wide.c_str(), wide.size()));
+
+	// Longer than the inline buffer
+	std::string longPath(1000, 'x');
+	WideStringUWP heap = UTF8ToWideStringUWP(longPath);
+	CHECK(heap.size() == 1000 && heap.c_str()[1000] == 0);
+	WideStringUWP moved = std::move(heap);
+	CHECK(moved.size() == 1000 && heap.size() == 0 && heap.c_str()[0] == 0);
+	heap = moved;
+	CHECK(heap.size() == 1000 && heap.c_str() != moved.c_str());
+	moved = wide;
+	CHECK(moved.size() == wide.size() && std::wstring_view(moved.c_str()) == std::wstring_view(wide.c_str()));
+	WideStringUWP inlineMoved = std::move(wide);
+	CHECK(inlineMoved.size() == wideString.size());
+	CHECK(UTF8ToWideStringUWP("").empty());
+}
+
+// ASCII path (the common case) to UTF-16 and back
+static void BenchmarkASCII() {
+	std::string path = "C:\\Users\\Player\\AppData\\Local\\Packages\\App_8wekyb3d8bbwe\\LocalState\\Games\\PSP\\GAME\\File.iso";
+	std::u16string reference = RefUTF8ToUTF16(path);
+	const int rounds = 500000;
+	size_t units = 0;
+
+	auto start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		units += RefUTF8ToUTF16(path).size();
+	}
+	double refMs = ElapsedMs(start);
+
+	WideStringUWP wide;
+	start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		wide = UTF8ToWideStringUWP(path);
+		units += wide.size();
+	}
+	double newMs = ElapsedMs(start);
+
+	std::printf("utf8 -> utf16 (%zu chars): byte decoder %.3fus, transcoder %.3fus\n", path.size(), refMs * 1000 / rounds, newMs * 1000 / rounds);
+	CHECK(units == (size_t)rounds * 2 * reference.size());
+}
+
+int main() {
+	TestValidation();
+	TestWideString();
+	FuzzUTF8();
+	FuzzUTF16();
+	BenchmarkASCII();
+	std::printf("encoding_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,306 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// StorageExecutorUWP: lane limits, starvation, yield and interactive latency under a deep scan
+
+#include <atomic>
+#include <future>
+#include <random>
+#include <thread>
+
+#include "StorageExecutor.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Released jobs finish, blocked ones wait for it
+struct Gate {
+	std::mutex lock;
+	std::condition_variable condition;
+	bool open = false;
+
+	void Wait() {
+		std::unique_lock<std::mutex> guard(lock);
+		condition.wait(guard, [this]() { return open; });
+	}
+
+	void Open() {
+		std::lock_guard<std::mutex> guard(lock);
+		open = true;
+		condition.notify_all();
+	}
+};
+
+static void WaitRunning(StorageExecutorUWP& executor, StorageLaneUWP lane, size_t running) {
+	auto start = steady_clock::now();
+	while (executor.Stats(lane).running < running) {
+		CHECK(ElapsedMs(start) < 2000 * TEST_SLOWDOWN);
+		std::this_thread::sleep_for(milliseconds(1));
+	}
+}
+
+static bool RunsWithin(StorageExecutorUWP& executor, StorageLaneUWP lane, double ms) {
+	auto ran = std::make_shared<std::promise<void>>();
+	auto future = ran->get_future();
+	executor.Post(lane, [ran]() { ran->set_value(); });
+	return future.wait_for(milliseconds((int)ms)) == std::future_status::ready;
+}
+
+// Game load + deep scan must not take the last worker
+static void TestInteractiveReserved() {
+	Gate gate; // Outlives the executor, jobs wait on it until joined
+	StorageExecutorUWP executor(3, 1, 100);
+	executor.Post(STORAGE_LANE_NORMAL, [&]() { gate.Wait(); });
+	executor.Post(STORAGE_LANE_BACKGROUND, [&]() { gate.Wait(); });
+	WaitRunning(executor, STORAGE_LANE_NORMAL, 1);
+	WaitRunning(executor, STORAGE_LANE_BACKGROUND, 1);
+
+	// Normal lane alone could take 2, but the shared limit is reached
+	executor.Post(STORAGE_LANE_NORMAL, [&]() { gate.Wait(); });
+	std::this_thread::sleep_for(milliseconds(20));
+	CHECK(executor.Stats(STORAGE_LANE_NORMAL).running == 1);
+	CHECK(executor.Stats(STORAGE_LANE_NORMAL).queued == 1);
+
+	CHECK(RunsWithin(executor, STORAGE_LANE_INTERACTIVE, 500.0 * TEST_SLOWDOWN));
+	gate.Open();
+}
+
+// Saturated normal lane with queued background work
+static void TestSaturatedLanes() {
+	Gate gate; // Outlives the executor, jobs wait on it until joined
+	StorageExecutorUWP executor(4, 2, 100);
+	for (int i = 0; i < 8; i++) {
+		executor.Post(STORAGE_LANE_NORMAL, [&]() { gate.Wait(); });
+		executor.Post(STORAGE_LANE_BACKGROUND, [&]() { gate.Wait(); });
+	}
+	// Lanes may split the shared workers in any way, but never take the last one
+	auto start = steady_clock::now();
+	while (executor.Stats(STORAGE_LANE_NORMAL).running + executor.Stats(STORAGE_LANE_BACKGROUND).running < 3) {
+		CHECK(ElapsedMs(start) < 2000 * TEST_SLOWDOWN);
+		std::this_thread::sleep_for(milliseconds(1));
+	}
+	std::this_thread::sleep_for(milliseconds(20));
+	auto normal = executor.Stats(STORAGE_LANE_NORMAL);
+	auto background = executor.Stats(STORAGE_LANE_BACKGROUND);
+	CHECK(normal.running + background.running == 3);
+	CHECK(background.running <= 2);
+	CHECK(executor.QueueDepth() == 16 - 3);
+	CHECK(RunsWithin(executor, STORAGE_LANE_INTERACTIVE, 500.0 * TEST_SLOWDOWN));
+	gate.Open();
+}
+
+// Random mix, limits must hold at any time
+static void TestLimitsStress() {
+	const size_t workers = 4;
+	const size_t backgroundWorkers = 2;
+	const int jobs = 3000;
+	std::atomic<int> running[STORAGE_LANES] = {};
+	std::atomic<int> maxShared{ 0 };
+	std::atomic<int> maxBackground{ 0 };
+	std::atomic<int> maxTotal{ 0 };
+	std::atomic<int> done{ 0 };
+	{
+		StorageExecutorUWP executor(workers, backgroundWorkers, 1);
+		std::mt19937 random(7);
+		for (int i = 0; i < jobs; i++) {
+			auto lane = (StorageLaneUWP)(random() % STORAGE_LANES);
+			int spin = (int)(random() % 200);
+			executor.Post(lane, [&, lane, spin]() {
+				running[lane]++;
+				int shared = running[STORAGE_LANE_NORMAL] + running[STORAGE_LANE_BACKGROUND];
+				int total = shared + running[STORAGE_LANE_INTERACTIVE];
+				int background = running[STORAGE_LANE_BACKGROUND];
+				for (auto* value : { &maxShared, &maxBackground, &maxTotal }) {
+					int sample = (value == &maxShared) ? shared : (value == &maxBackground) ? background : total;
+					int current = value->load();
+					while (sample > current && !value->compare_exchange_weak(current, sample)) {
+					}
+				}
+				std::this_thread::sleep_for(microseconds(spin));
+				running[lane]--;
+				done++;
+			});
+		}
+		auto start = steady_clock::now();
+		while (done < jobs) {
+			CHECK(ElapsedMs(start) < 20000 * TEST_SLOWDOWN);
+			std::this_thread::sleep_for(milliseconds(1));
+		}
+		uint64_t completed = 0;
+		for (int lane = 0; lane < STORAGE_LANES; lane++) {
+			completed += executor.Stats((StorageLaneUWP)lane).completed;
+		}
+		CHECK(completed == (uint64_t)jobs);
+	}
+	CHECK(maxShared <= (int)workers - 1);
+	CHECK(maxBackground <= (int)backgroundWorkers);
+	CHECK(maxTotal <= (int)workers);
+}
+
+// Background job pauses at 'Yield' until interactive work is done
+static void TestYield() {
+	Gate interactive;
+	std::atomic<bool> yielded{ false };
+	std::atomic<bool> interactiveDone{ false };
+	std::atomic<bool> orderOk{ false };
+	std::promise<void> finished;
+	auto future = finished.get_future();
+	StorageExecutorUWP executor(3, 1, 1000);
+
+	executor.Post(STORAGE_LANE_INTERACTIVE, [&]() { interactive.Wait(); interactiveDone = true; });
+	WaitRunning(executor, STORAGE_LANE_INTERACTIVE, 1);
+	executor.Post(STORAGE_LANE_BACKGROUND, [&]() {
+		yielded = true;
+		executor.Yield();
+		orderOk = interactiveDone.load();
+		finished.set_value();
+	});
+	WaitRunning(executor, STORAGE_LANE_BACKGROUND, 1);
+	std::this_thread::sleep_for(milliseconds(20));
+	CHECK(yielded);
+	CHECK(future.wait_for(milliseconds(0)) != std::future_status::ready);
+	interactive.Open();
+	CHECK(future.wait_for(milliseconds(2000 * TEST_SLOWDOWN)) == std::future_status::ready);
+	CHECK(orderOk);
+
+	// Outside executor threads it does nothing
+	executor.Yield();
+}
+
+static void TestDestroyWithQueuedJobs() {
+	std::atomic<int> ran{ 0 };
+	{
+		StorageExecutorUWP executor(2, 1, 10);
+		for (int i = 0; i < 200; i++) {
+			executor.Post(STORAGE_LANE_BACKGROUND, [&]() { std::this_thread::sleep_for(milliseconds(1)); ran++; });
+		}
+	}
+	CHECK(ran < 200);
+}
+
+// Simulated device serving one request at a time (FIFO)
+struct Device {
+	std::mutex lock;
+	std::condition_variable condition;
+	uint64_t next = 0;
+	uint64_t serving = 0;
+
+	void Io(int micros) {
+		std::unique_lock<std::mutex> guard(lock);
+		uint64_t ticket = next++;
+		condition.wait(guard, [&]() { return serving == ticket; });
+		guard.unlock();
+		auto end = steady_clock::now() + microseconds(micros);
+		while (steady_clock::now() < end) {
+		}
+		guard.lock();
+		serving++;
+		condition.notify_all();
+	}
+};
+
+static LatencyStatsUWP MeasureInteractive(Device& device, std::function<void(std::function<void()>)> post, int count) {
+	LatencyHistogramUWP histogram;
+	for (int i = 0; i < count; i++) {
+		auto start = steady_clock::now();
+		auto done = std::make_shared<std::promise<void>>();
+		auto future = done->get_future();
+		post([&device, done]() {
+			device.Io(300);
+			done->set_value();
+		});
+		future.wait();
+		histogram.Record((uint64_t)duration_cast<microseconds>(steady_clock::now() - start).count());
+		std::this_thread::sleep_for(milliseconds(3));
+	}
+	return histogram.Stats();
+}
+
+static void Print(const char* name, const LatencyStatsUWP& stats, int steps) {
+	std::printf("%-32s p50 %6lluus p95 %6lluus p99 %6lluus max %6lluus (scan steps %d)\n", name,
+		(unsigned long long)stats.p50, (unsigned long long)stats.p95, (unsigned long long)stats.p99, (unsigned long long)stats.max, steps);
+}
+
+// Interactive p99 while a 4-way deep scan runs, thread per call vs executor lanes
+static void BenchmarkDeepScan() {
+	const int requests = 200;
+	const int walkers = 4;
+	Device device;
+
+	LatencyStatsUWP baseline;
+	int baselineSteps;
+	{
+		std::atomic<bool> stop{ false };
+		std::atomic<int> steps{ 0 };
+		std::vector<std::thread> scan;
+		for (int i = 0; i < walkers; i++) {
+			scan.emplace_back([&]() {
+				while (!stop) {
+					device.Io(2000);
+					steps++;
+				}
+			});
+		}
+		std::vector<std::thread> calls;
+		baseline = MeasureInteractive(device, [&](std::function<void()> work) { calls.emplace_back(work); }, requests);
+		stop = true;
+		for (auto& thread : scan) {
+			thread.join();
+		}
+		for (auto& thread : calls) {
+			thread.join();
+		}
+		baselineSteps = steps;
+	}
+	Print("thread per call + deep scan", baseline, baselineSteps);
+
+	LatencyStatsUWP lanes;
+	int laneSteps;
+	{
+		StorageExecutorUWP executor(3, 1, 100);
+		std::atomic<bool> stop{ false };
+		std::atomic<int> steps{ 0 };
+		std::atomic<int> stopped{ 0 };
+		for (int i = 0; i < walkers; i++) {
+			executor.Post(STORAGE_LANE_BACKGROUND, [&]() {
+				while (!stop) {
+					device.Io(2000);
+					steps++;
+					executor.Yield();
+				}
+				stopped++;
+			});
+		}
+		lanes = MeasureInteractive(device, [&](std::function<void()> work) { executor.Post(STORAGE_LANE_INTERACTIVE, work); }, requests);
+		auto interactive = executor.Stats(STORAGE_LANE_INTERACTIVE);
+		CHECK(interactive.completed == (uint64_t)requests);
+		CHECK(interactive.total.count == (uint64_t)requests);
+		CHECK(executor.Stats(STORAGE_LANE_BACKGROUND).queued == (size_t)walkers - 1);
+		stop = true;
+		while (stopped < walkers) {
+			std::this_thread::sleep_for(milliseconds(1));
+		}
+		laneSteps = steps;
+		std::printf("executor interactive lane: wait p99 %lluus, total p99 %lluus\n",
+			(unsigned long long)interactive.wait.p99, (unsigned long long)interactive.total.p99);
+	}
+	Print("executor lanes + deep scan", lanes, laneSteps);
+
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(lanes.p99 <= baseline.p99);
+	}
+}
+
+int main() {
+	TestInteractiveReserved();
+	TestSaturatedLanes();
+	TestLimitsStress();
+	TestYield();
+	TestDestroyWithQueuedJobs();
+	BenchmarkDeepScan();
+	std::printf("executor_test: OK\n");
+	return 0;
+}
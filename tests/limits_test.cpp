@@ -0,0 +1,223 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// StorageLimits.h: deadlines and cancellation of blocking calls against a slow backend (sleeping USB drive)
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "StorageBatch.h"
+#include "StorageLatency.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Operations complete after 'delay' on their own thread, unless canceled ('Cancel' of the async operation)
+class SlowBackend {
+public:
+	struct Operation {
+		std::atomic<bool> canceled{ false };
+	};
+
+	~SlowBackend() {
+		Join();
+	}
+
+	// 'operation' can be created before, to be tracked before it starts
+	std::shared_ptr<Operation> Launch(int delayMs, std::function<void(bool)> done, std::shared_ptr<Operation> operation = nullptr) {
+		if (operation == nullptr) {
+			operation = std::make_shared<Operation>();
+		}
+		std::lock_guard<std::mutex> lock(threadsLock);
+		threads.emplace_back([operation, delayMs, done]() {
+			auto end = steady_clock::now() + milliseconds(delayMs);
+			while (steady_clock::now() < end && !operation->canceled) {
+				std::this_thread::sleep_for(milliseconds(1));
+			}
+			done(!operation->canceled);
+		});
+		return operation;
+	}
+
+	void Join() {
+		std::lock_guard<std::mutex> lock(threadsLock);
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		threads.clear();
+	}
+
+private:
+	std::mutex threadsLock;
+	std::vector<std::thread> threads;
+};
+
+static SlowBackend backend;
+static LatencyHistogramUWP brokerLatency;
+
+// Same steps as 'WaitTask': check the limits, wait on the signal, cancel the operation if stopped
+static StorageCallResultUWP Call(int delayMs) {
+	LatencyScopeUWP latency(brokerLatency);
+	auto signal = std::make_shared<WaitSignalUWP>();
+	auto operation = backend.Launch(delayMs, [signal](bool) { signal->Set(); });
+	StorageLimitsUWP* limits = CurrentStorageLimitsUWP();
+	auto state = CheckStorageLimitsUWP();
+	if (state == STORAGE_CALL_COMPLETED) {
+		state = signal->Wait(nullptr, limits);
+	}
+	if (state != STORAGE_CALL_COMPLETED) {
+		operation->canceled = true;
+		limits->Stop(state);
+		latency.SetResult(state);
+	}
+	return state;
+}
+
+static void TestDeadline() {
+	CHECK(Call(20) == STORAGE_CALL_COMPLETED);
+	{
+		StorageLimitScopeUWP scope(50);
+		auto start = steady_clock::now();
+		CHECK(Call(2000) == STORAGE_CALL_TIMEOUT);
+		double waited = ElapsedMs(start);
+		CHECK(waited >= 49 && waited < 50 + 150 * TEST_SLOWDOWN);
+		CHECK(scope.TimedOut());
+
+		// Expired scope, later calls fail right away
+		start = steady_clock::now();
+		CHECK(Call(2000) == STORAGE_CALL_TIMEOUT);
+		CHECK(ElapsedMs(start) < 20 * TEST_SLOWDOWN);
+	}
+	{
+		StorageLimitScopeUWP scope(1000);
+		CHECK(Call(10) == STORAGE_CALL_COMPLETED);
+		CHECK(scope.Result() == STORAGE_CALL_COMPLETED);
+	}
+	CHECK(CurrentStorageLimitsUWP() == nullptr);
+}
+
+static void TestCancel() {
+	auto token = std::make_shared<CancelTokenUWP>();
+	StorageLimitScopeUWP scope(0, token);
+	std::thread button([token]() {
+		std::this_thread::sleep_for(milliseconds(30));
+		token->Cancel();
+	});
+	auto start = steady_clock::now();
+	CHECK(Call(2000) == STORAGE_CALL_CANCELED);
+	button.join();
+	CHECK(ElapsedMs(start) < 30 + 150 * TEST_SLOWDOWN);
+	CHECK(scope.Canceled());
+}
+
+// Inner scope keeps the earliest deadline and the outer token, stops reach the outer scope
+static void TestNested() {
+	auto token = std::make_shared<CancelTokenUWP>();
+	{
+		StorageLimitScopeUWP outer(40, token);
+		{
+			StorageLimitScopeUWP inner(5000);
+			CHECK(CurrentStorageLimitsUWP()->token == token);
+			CHECK(Call(2000) == STORAGE_CALL_TIMEOUT);
+			CHECK(inner.TimedOut());
+		}
+		CHECK(outer.TimedOut());
+	}
+	CHECK(CurrentStorageLimitsUWP() == nullptr);
+}
+
+// Work continued on another thread keeps the deadline, empty captures apply nothing
+static void TestCaptured() {
+	StorageLimitScopeUWP scope(40);
+	auto captured = CaptureStorageLimitsUWP();
+	StorageCallResultUWP state = STORAGE_CALL_COMPLETED;
+	bool timedOut = false;
+	std::thread worker([&]() {
+		StorageLimitScopeUWP workerScope(captured);
+		state = Call(2000);
+		timedOut = workerScope.TimedOut();
+	});
+	worker.join();
+	CHECK(state == STORAGE_CALL_TIMEOUT && timedOut);
+
+	bool empty = false;
+	std::thread plain([&empty]() {
+		StorageLimitScopeUWP workerScope(CaptureStorageLimitsUWP());
+		empty = CurrentStorageLimitsUWP() == nullptr;
+	});
+	plain.join();
+	CHECK(empty);
+}
+
+// Stopped batch cancels operations in flight and skips the rest
+static void TestBatchStop() {
+	std::atomic<int> launched{ 0 };
+	auto runner = std::make_shared<BatchRunnerUWP<int>>(50, -1);
+	runner->Start([&launched](size_t i, std::shared_ptr<BatchRunnerUWP<int>> run) {
+		launched++;
+		int delay = i < 4 ? 5 : 2000;
+		auto operation = std::make_shared<SlowBackend::Operation>();
+		run->Track(i, [operation]() { operation->canceled = true; });
+		backend.Launch(delay, [i, run](bool completed) {
+			run->Complete(i, (int)i, completed, completed ? 0 : 1);
+		}, operation);
+	}, 8);
+	// Quick ones finish first, the batch is then stuck behind the slow ones
+	std::this_thread::sleep_for(milliseconds(40));
+
+	StorageLimitScopeUWP scope(60);
+	auto start = steady_clock::now();
+	CHECK(runner->Wait(nullptr, CurrentStorageLimitsUWP()) == STORAGE_CALL_TIMEOUT);
+	CHECK(ElapsedMs(start) < 60 + 150 * TEST_SLOWDOWN);
+	auto results = runner->Results();
+	int succeeded = 0;
+	for (auto& item : results) {
+		succeeded += item.succeeded;
+	}
+	std::printf("stopped batch: launched %d of 50, succeeded %d\n", launched.load(), succeeded);
+	CHECK(succeeded == 4);
+	CHECK(launched < 50);
+}
+
+static void TestHistogram() {
+	LatencyHistogramUWP histogram;
+	for (int i = 0; i < 980; i++) {
+		histogram.Record(100);
+	}
+	for (int i = 0; i < 20; i++) {
+		histogram.Record(50000, i < 5 ? STORAGE_CALL_TIMEOUT : STORAGE_CALL_COMPLETED);
+	}
+	auto stats = histogram.Stats();
+	CHECK(stats.count == 1000);
+	CHECK(stats.p50 >= 100 && stats.p50 <= 200);
+	CHECK(stats.p95 <= 200);
+	CHECK(stats.p99 >= 50000 && stats.p99 <= 65536);
+	CHECK(stats.max == 50000);
+	CHECK(stats.timeouts == 5);
+	histogram.Clear();
+	CHECK(histogram.Stats().count == 0 && histogram.Stats().p99 == 0);
+
+	// Calls made above
+	auto broker = brokerLatency.Stats();
+	std::printf("broker waits: %llu calls, %llu timeouts, %llu canceled, p50 %lluus, p99 %lluus, max %lluus\n",
+		(unsigned long long)broker.count, (unsigned long long)broker.timeouts, (unsigned long long)broker.canceled,
+		(unsigned long long)broker.p50, (unsigned long long)broker.p99, (unsigned long long)broker.max);
+	CHECK(broker.timeouts == 4 && broker.canceled == 1);
+	CHECK(broker.max < 2000000);
+}
+
+int main() {
+	TestDeadline();
+	TestCancel();
+	TestNested();
+	TestCaptured();
+	TestBatchStop();
+	backend.Join();
+	TestHistogram();
+	std::printf("limits_test: OK\n");
+	return 0;
+}
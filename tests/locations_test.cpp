@@ -0,0 +1,171 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// LocationRegistryUWP: classification against the old lowercase copies check
+
+#include <random>
+#include <algorithm>
+
+#include "StorageLocations.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+static const char* LocalState = "C:\\Users\\Player\\AppData\\Local\\Packages\\App_8wekyb3d8bbwe\\LocalState";
+static const char* TempState = "C:\\Users\\Player\\AppData\\Local\\Packages\\App_8wekyb3d8bbwe\\TempState";
+static const char* LocalCache = "C:\\Users\\Player\\AppData\\Local\\Packages\\App_8wekyb3d8bbwe\\LocalCache";
+static const char* Install = "C:\\Program Files\\WindowsApps\\App_1.0.0.0_x64__8wekyb3d8bbwe";
+
+static LocationRegistryUWP MakeRegistry() {
+	LocationRegistryUWP registry;
+	registry.AddRoot(LocationTypeUWP::LOCAL_STATE, LocalState);
+	registry.AddRoot(LocationTypeUWP::TEMP_STATE, TempState);
+	registry.AddRoot(LocationTypeUWP::LOCAL_CACHE, LocalCache);
+	registry.AddRoot(LocationTypeUWP::INSTALL, Install);
+	registry.AddRoot(LocationTypeUWP::PICKED, "D:\\Games");
+	registry.AddRoot(LocationTypeUWP::DRIVE_ACCESSIBLE, "D:\\");
+	return registry;
+}
+
+// Old check: lowercase copies of both sides, '/' replaced, then a boundary check
+static bool OldIsChild(std::string parent, std::string child) {
+	for (auto* value : { &parent, &child }) {
+		std::transform(value->begin(), value->end(), value->begin(), [](char c) {
+			return c == '/' ? '\\' : (char)((c >= 'A' && c <= 'Z') ? c + 32 : c);
+		});
+		while (!value->empty() && value->back() == '\\') {
+			value->pop_back();
+		}
+	}
+	if (parent.empty() || child.compare(0, parent.size(), parent) != 0) {
+		return false;
+	}
+	return child.size() == parent.size() || child[parent.size()] == '\\';
+}
+
+static void TestClassify() {
+	auto registry = MakeRegistry();
+	CHECK(registry.Classify(std::string(LocalState) + "\\saves\\a.sav") == LocationTypeUWP::LOCAL_STATE);
+	CHECK(registry.Classify("c:/users/player/appdata/local/packages/APP_8WEKYB3D8BBWE/localstate/") == LocationTypeUWP::LOCAL_STATE);
+	CHECK(registry.Classify(std::string(TempState) + "\\x") == LocationTypeUWP::TEMP_STATE);
+	CHECK(registry.Classify(std::string(LocalCache)) == LocationTypeUWP::LOCAL_CACHE);
+	CHECK(registry.Classify(std::string(Install) + "\\Assets\\logo.png") == LocationTypeUWP::INSTALL);
+
+	// Deepest root wins, component boundary only
+	CHECK(registry.Classify("D:\\Games\\psp\\game.iso") == LocationTypeUWP::PICKED);
+	CHECK(registry.Classify("d:/games") == LocationTypeUWP::PICKED);
+	CHECK(registry.Classify("D:\\GamesX\\a") == LocationTypeUWP::DRIVE_ACCESSIBLE);
+	CHECK(registry.Classify("D:\\") == LocationTypeUWP::DRIVE_ACCESSIBLE);
+	CHECK(registry.Classify(std::string(LocalState) + "Old\\a") == LocationTypeUWP::UNKNOWN);
+	CHECK(registry.Classify("E:\\Games") == LocationTypeUWP::UNKNOWN);
+	CHECK(registry.Classify("") == LocationTypeUWP::UNKNOWN);
+
+	CHECK(registry.GetRoot(LocationTypeUWP::INSTALL) == Install);
+	CHECK(registry.GetRoot(LocationTypeUWP::UNKNOWN).empty());
+
+	// Empty roots are ignored
+	LocationRegistryUWP empty;
+	empty.AddRoot(LocationTypeUWP::PICKED, "");
+	CHECK(empty.Classify("C:\\a") == LocationTypeUWP::UNKNOWN);
+	CHECK(empty.GetRoot(LocationTypeUWP::PICKED).empty());
+}
+
+// Random paths around the roots, deepest matching root of the old check must be returned
+static void TestAgainstOldCheck() {
+	auto registry = MakeRegistry();
+	struct Known {
+		LocationTypeUWP type;
+		std::string root;
+	};
+	std::vector<Known> known = {
+		{ LocationTypeUWP::LOCAL_STATE, LocalState }, { LocationTypeUWP::TEMP_STATE, TempState },
+		{ LocationTypeUWP::LOCAL_CACHE, LocalCache }, { LocationTypeUWP::INSTALL, Install },
+		{ LocationTypeUWP::PICKED, "D:\\Games" }, { LocationTypeUWP::DRIVE_ACCESSIBLE, "D:\\" },
+	};
+	const char* tails[] = { "", "\\", "\\a", "\\a\\b.bin", "X", "x\\a", "/sub/", "\\..\\" };
+	std::mt19937 random(5);
+	for (int i = 0; i < 50000; i++) {
+		std::string path = known[random() % known.size()].root;
+		if (random() % 4 == 0) {
+			path = path.substr(0, random() % (path.size() + 1));
+		}
+		for (auto& c : path) {
+			if (random() % 3 == 0) {
+				c = (char)std::toupper((unsigned char)c);
+			}
+			else if (random() % 3 == 0) {
+				c = (char)std::tolower((unsigned char)c);
+			}
+			if (c == '\\' && random() % 4 == 0) {
+				c = '/';
+			}
+		}
+		path += tails[random() % 8];
+		if (path.find("..") != std::string::npos) {
+			continue; // Old check doesn't resolve dots
+		}
+
+		auto expected = LocationTypeUWP::UNKNOWN;
+		size_t depth = 0;
+		for (auto& root : known) {
+			if (OldIsChild(root.root, path) && root.root.size() > depth) {
+				expected = root.type;
+				depth = root.root.size();
+			}
+		}
+		CHECK(registry.Classify(path) == expected);
+	}
+}
+
+// Hot path: one classification per file operation
+static void BenchmarkClassify() {
+	auto registry = MakeRegistry();
+	std::vector<std::string> paths = {
+		std::string(LocalState) + "\\config\\ppsspp.ini",
+		std::string(Install) + "\\assets\\ui_atlas.zim",
+		"D:\\Games\\PSP\\ISO\\game.iso",
+		"F:\\Other\\file.bin",
+	};
+	std::vector<std::string> roots = { LocalState, TempState, LocalCache, Install };
+	const int rounds = 200000;
+
+	size_t hits = 0;
+	auto start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		auto& path = paths[i % paths.size()];
+		for (auto& root : roots) {
+			if (OldIsChild(root, path)) {
+				hits++;
+				break;
+			}
+		}
+	}
+	double oldMs = ElapsedMs(start);
+
+	size_t known = 0;
+	start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		if (registry.Classify(paths[i % paths.size()]) != LocationTypeUWP::UNKNOWN) {
+			known++;
+		}
+	}
+	double registryMs = ElapsedMs(start);
+
+	std::printf("classify: lowercase copies %.3fus, registry %.3fus per path\n", oldMs * 1000 / rounds, registryMs * 1000 / rounds);
+	CHECK(hits == (size_t)rounds / 2);
+	CHECK(known == (size_t)rounds / 4 * 3);
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(registryMs < oldMs);
+	}
+}
+
+int main() {
+	TestClassify();
+	TestAgainstOldCheck();
+	BenchmarkClassify();
+	std::printf("locations_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,151 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Lookup list versions: readers never see partial updates, and read scaling against a locked list
+
+#include <atomic>
+#include <thread>
+
+#include "StorageVersioned.h"
+#include "StoragePathTrie.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+typedef PathTrieUWP<int> IndexUWP;
+
+static std::string ItemPath(int i) {
+	return "D:\\Picked\\Folder" + std::to_string(i);
+}
+
+// Writer adds items in pairs, every version must hold both or none
+static void TestNoPartialUpdates() {
+	VersionedUWP<IndexUWP> lookup;
+	const int pairs = 500 / TEST_SLOWDOWN;
+	std::atomic<bool> stop{ false };
+	std::atomic<int> reads{ 0 };
+
+	std::vector<std::thread> readers;
+	for (int r = 0; r < 4; r++) {
+		readers.emplace_back([&]() {
+			while (!stop) {
+				auto version = lookup.Get();
+				size_t size = version->size();
+				CHECK(size % 2 == 0);
+				for (int i = 0; i < (int)size; i++) {
+					const int* value = version->Find(ItemPath(i));
+					CHECK(value != nullptr && *value == i);
+				}
+				// Version held above doesn't change after newer ones are published
+				CHECK(version->size() == size);
+				reads++;
+			}
+		});
+	}
+	for (int i = 0; i < pairs; i++) {
+		lookup.Update([i](IndexUWP& index) {
+			index.Insert(ItemPath(i * 2), i * 2);
+			index.Insert(ItemPath(i * 2 + 1), i * 2 + 1);
+		});
+	}
+	while (reads < 100) {
+		std::this_thread::yield();
+	}
+	stop = true;
+	for (auto& thread : readers) {
+		thread.join();
+	}
+	CHECK(lookup.Get()->size() == (size_t)pairs * 2);
+
+	auto empty = std::make_shared<IndexUWP>();
+	lookup.Publish(empty);
+	CHECK(lookup.Get()->empty());
+}
+
+// Slow writer (picker restoring many items) must not hold readers
+static void TestReadersNotBlocked() {
+	VersionedUWP<IndexUWP> lookup;
+	lookup.Update([](IndexUWP& index) { index.Insert(ItemPath(0), 0); });
+	std::atomic<bool> updating{ false };
+	std::thread writer([&]() {
+		lookup.Update([&](IndexUWP& index) {
+			updating = true;
+			std::this_thread::sleep_for(milliseconds(300));
+			index.Insert(ItemPath(1), 1);
+		});
+	});
+	while (!updating) {
+		std::this_thread::yield();
+	}
+	auto start = steady_clock::now();
+	auto version = lookup.Get();
+	CHECK(ElapsedMs(start) < 100);
+	CHECK(version->size() == 1);
+	writer.join();
+	CHECK(lookup.Get()->size() == 2);
+}
+
+// Ancestors lookups per second from 'threads' readers
+template<typename F>
+static double ReadRate(int threads, F lookup) {
+	std::atomic<bool> stop{ false };
+	std::atomic<uint64_t> total{ 0 };
+	std::vector<std::thread> readers;
+	for (int t = 0; t < threads; t++) {
+		readers.emplace_back([&, t]() {
+			uint64_t count = 0;
+			int i = t;
+			while (!stop) {
+				lookup(ItemPath(i++ % 400) + "\\Saves\\slot.bin");
+				count++;
+			}
+			total += count;
+		});
+	}
+	std::this_thread::sleep_for(milliseconds(200));
+	stop = true;
+	for (auto& thread : readers) {
+		thread.join();
+	}
+	return total / 0.2;
+}
+
+static void BenchmarkReadScaling() {
+	VersionedUWP<IndexUWP> lookup;
+	IndexUWP locked;
+	std::mutex lockedMutex;
+	lookup.Update([&](IndexUWP& index) {
+		for (int i = 0; i < 400; i++) {
+			index.Insert(ItemPath(i), i);
+			locked.Insert(ItemPath(i), i);
+		}
+	});
+
+	// Informational, depends on the cores of the machine
+	for (int threads : { 1, 2, 4, 8 }) {
+		double versioned = ReadRate(threads, [&](const std::string& path) {
+			std::vector<const int*> ancestors;
+			auto version = lookup.Get();
+			version->GetAncestors(path, ancestors);
+			CHECK(ancestors.size() == 1);
+		});
+		double mutex = ReadRate(threads, [&](const std::string& path) {
+			std::vector<const int*> ancestors;
+			std::lock_guard<std::mutex> guard(lockedMutex);
+			locked.GetAncestors(path, ancestors);
+			CHECK(ancestors.size() == 1);
+		});
+		std::printf("%d readers: versions %.0f/s, locked list %.0f/s\n", threads, versioned, mutex);
+	}
+}
+
+int main() {
+	TestNoPartialUpdates();
+	TestReadersNotBlocked();
+	BenchmarkReadScaling();
+	std::printf("lookup_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,72 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// MountTableUWP: mount rules, deepest root routing and the Win32 form passed to API helpers
+
+#include "StorageMounts.h"
+#include "StoragePath.h"
+#include "TestUtils.h"
+
+static void TestMountRules() {
+	MountTableUWP table;
+	CHECK(!table.Mount("/", "C:/Data"));
+	CHECK(!table.Mount("/roms", "relative"));
+	CHECK(!table.Mount("", "C:/Data"));
+	CHECK(!table.Mount("/roms", ""));
+	CHECK(table.Mount("/roms", "D:\\Games\\ROMs\\"));
+	CHECK(table.Mount("/bios", "D:"));
+	CHECK(table.size() == 2);
+
+	// Same root (any case) replaces the old target
+	CHECK(table.Mount("/ROMS", "F:/R"));
+	CHECK(table.size() == 2);
+	std::string target;
+	CHECK(table.GetTarget("/roms", target) && target == "F:/R");
+	CHECK(!table.GetTarget("/roms/psp", target));
+}
+
+static void TestResolve() {
+	MountTableUWP table;
+	CHECK(table.Mount("/roms", "D:\\Games\\ROMs\\"));
+	CHECK(table.Mount("/roms/psp", "E:/PSP"));
+	CHECK(table.Mount("/bios", "D:"));
+
+	std::string out = "untouched";
+	CHECK(!table.Resolve("/romsx/a.iso", out) && out == "untouched");
+	CHECK(!table.Resolve("roms/a.iso", out) && out == "untouched");
+	CHECK(table.Resolve("/roms/a.iso", out) && out == "D:/Games/ROMs/a.iso");
+	CHECK(table.Resolve("/ROMS/PSP/x/y.iso", out) && out == "E:/PSP/x/y.iso");
+	CHECK(table.Resolve("/roms", out) && out == "D:/Games/ROMs");
+	CHECK(table.Resolve("\\bios\\k.bin", out) && out == "D:/k.bin");
+
+	// API helpers get the routed path in Windows form, never the virtual one
+	CHECK(table.Resolve("/roms/psp/saves/a.bin", out));
+	CHECK(PathUWP(out).ToWString() == L"E:\\PSP\\saves\\a.bin");
+}
+
+static void TestSerialize() {
+	MountTableUWP table;
+	CHECK(table.Mount("/roms", "D:/Games/ROMs"));
+	CHECK(table.Mount("/roms/psp", "E:/PSP"));
+	CHECK(table.Mount("/bios", "D:"));
+	auto data = table.Serialize();
+
+	MountTableUWP loaded;
+	CHECK(loaded.Deserialize(data + "bad line\n|no root\n") == 3);
+	std::string out;
+	CHECK(loaded.Resolve("/roms/psp/q", out) && out == "E:/PSP/q");
+	CHECK(loaded.Unmount("/roms/PSP"));
+	CHECK(loaded.Resolve("/roms/psp/q", out) && out == "D:/Games/ROMs/psp/q");
+	CHECK(!loaded.Unmount("/nope"));
+}
+
+int main() {
+	TestMountRules();
+	TestResolve();
+	TestSerialize();
+	std::printf("mounts_test: OK\n");
+	return 0;
+}
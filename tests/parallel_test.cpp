@@ -0,0 +1,120 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// ParallelForUWP: picked items restore with a simulated FutureAccessList broker
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "StorageParallel.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Simulated broker, each 'GetItemAsync' takes the same time and can run in parallel
+struct Broker {
+	std::atomic<int> active{ 0 };
+	std::atomic<int> maxActive{ 0 };
+	int latencyMs;
+
+	explicit Broker(int latencyMs) : latencyMs(latencyMs) {
+	}
+
+	bool Resolve(size_t token) {
+		int current = ++active;
+		int seen = maxActive.load();
+		while (current > seen && !maxActive.compare_exchange_weak(seen, current)) {
+		}
+		std::this_thread::sleep_for(milliseconds(latencyMs));
+		active--;
+		// Every 5th token was moved/deleted
+		return token % 5 != 0;
+	}
+};
+
+static void TestEachIndexOnce() {
+	const size_t count = 1000;
+	std::vector<std::atomic<int>> hits(count);
+	ParallelForUWP(count, 8, [&](size_t i) { hits[i]++; });
+	for (auto& hit : hits) {
+		CHECK(hit == 1);
+	}
+}
+
+static void TestEdgeCounts() {
+	std::atomic<int> calls{ 0 };
+	ParallelForUWP(0, 8, [&](size_t) { calls++; });
+	CHECK(calls == 0);
+
+	// Zero workers still runs on the calling thread
+	auto caller = std::this_thread::get_id();
+	std::atomic<bool> sameThread{ true };
+	ParallelForUWP(10, 0, [&](size_t) {
+		calls++;
+		if (std::this_thread::get_id() != caller) {
+			sameThread = false;
+		}
+	});
+	CHECK(calls == 10);
+	CHECK(sameThread);
+
+	// More workers than indexes
+	calls = 0;
+	ParallelForUWP(3, 64, [&](size_t) { calls++; });
+	CHECK(calls == 3);
+}
+
+// Results are written to per-index slots, no lock needed
+static void TestRestoreResults() {
+	const size_t tokens = 64;
+	Broker broker(2);
+	std::vector<bool> items(tokens, false);
+	std::vector<char> resolved(tokens, 0);
+	ParallelForUWP(tokens, 8, [&](size_t i) { resolved[i] = broker.Resolve(i) ? 1 : 0; });
+	for (size_t i = 0; i < tokens; i++) {
+		CHECK((resolved[i] != 0) == (i % 5 != 0));
+	}
+	CHECK(broker.maxActive <= 8);
+	CHECK(broker.active == 0);
+}
+
+// Startup restore of many tokens, serial vs workers
+static void BenchmarkRestore() {
+	const size_t tokens = 80;
+	const int latency = 5;
+	double serialMs;
+	{
+		Broker broker(latency);
+		auto start = steady_clock::now();
+		for (size_t i = 0; i < tokens; i++) {
+			broker.Resolve(i);
+		}
+		serialMs = ElapsedMs(start);
+	}
+
+	Broker broker(latency);
+	auto start = steady_clock::now();
+	ParallelForUWP(tokens, 8, [&](size_t i) { broker.Resolve(i); });
+	double parallelMs = ElapsedMs(start);
+
+	std::printf("restore %zu tokens (%dms each): serial %.1fms, 8 workers %.1fms (max in flight %d)\n",
+		tokens, latency, serialMs, parallelMs, broker.maxActive.load());
+	CHECK(broker.maxActive <= 8);
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(parallelMs * 3 < serialMs);
+	}
+}
+
+int main() {
+	TestEachIndexOnce();
+	TestEdgeCounts();
+	TestRestoreResults();
+	BenchmarkRestore();
+	std::printf("parallel_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,173 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// PathUWP: single pass normalization, string_view accessors, components and construction cost
+
+#include <string>
+#include <vector>
+
+#include "StoragePath.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+static void TestNormalize() {
+	CHECK(PathUWP(std::string("C:\\Games\\\\PSP\\")).ToString() == "C:/Games/PSP");
+	CHECK(PathUWP(std::string("C:/Games///PSP//x.iso")).ToString() == "C:/Games/PSP/x.iso");
+	CHECK(PathUWP(std::string("\\\\?\\C:\\x")).ToString() == "C:/x");
+	CHECK(PathUWP(std::string("\\??\\C:\\x")).ToString() == "C:/x");
+	CHECK(PathUWP(std::string("\\\\?\\UNC\\srv\\share\\a")).ToString() == "//srv/share/a");
+	CHECK(PathUWP(std::string("\\\\srv\\share")).ToString() == "//srv/share");
+	CHECK(PathUWP(std::string("/")).ToString() == "/");
+	CHECK(PathUWP(std::string("C:\\")).ToString() == "C:");
+	CHECK(PathUWP(std::string("https://a.b/c/")).ToString() == "https://a.b/c/");
+	CHECK(PathUWP(std::string("https://a.b/c/")).Type() == PathTypeUWP::HTTP);
+	CHECK(PathUWP(std::string("")).empty());
+	CHECK(PathUWP(std::wstring(L"C:\\Games\\x")).ToString() == "C:/Games/x");
+	CHECK(PathUWP(std::string("C:/Games/x")).ToWString() == L"C:\\Games\\x");
+}
+
+static void TestAccessors() {
+	PathUWP path(std::string("C:\\Games\\Game.ISO"));
+	CHECK(path.GetFilename() == "Game.ISO");
+	CHECK(path.GetFilenameView() == "Game.ISO");
+	CHECK(path.GetFileExtension() == ".iso");
+	CHECK(path.GetFileExtensionView() == ".ISO");
+	CHECK(path.GetDirectory() == "C:/Games");
+	CHECK(path.GetDirectoryView() == "C:/Games");
+	CHECK(PathUWP(std::string("C:")).GetDirectory() == "/");
+	CHECK(PathUWP(std::string("/a")).GetDirectory() == "/");
+	CHECK(PathUWP(std::string("C:/a.b/c")).GetFileExtension().empty());
+	CHECK(PathUWP(std::string("C:/a.b/c")).GetFileExtensionView().empty());
+
+	// Views point into the path itself
+	auto view = path.GetFilenameView();
+	CHECK(view.data() >= path.c_str() && view.data() + view.size() <= path.c_str() + path.size());
+
+	CHECK(path.WithReplacedExtension(".cso").ToString() == "C:/Games/Game.cso");
+	CHECK(path.StartsWith(PathUWP(std::string("C:/Games"))));
+	CHECK(!PathUWP(std::string("C:")).StartsWith(path));
+	CHECK(path.FilePathContainsNoCase("game.iso"));
+	CHECK(path.GetRootVolume().ToString() == "C:");
+	CHECK((PathUWP(std::string("C:/Games")) / "PSP/").ToString() == "C:/Games/PSP");
+}
+
+static std::vector<std::string> Collect(const PathComponentsUWP& components, bool reverse) {
+	std::vector<std::string> parts;
+	if (reverse) {
+		for (auto iter = components.rbegin(); iter != components.rend(); ++iter) {
+			parts.emplace_back(*iter);
+		}
+	}
+	else {
+		for (auto part : components) {
+			parts.emplace_back(part);
+		}
+	}
+	return parts;
+}
+
+static void TestComponents() {
+	PathUWP path(std::string("C:\\Games\\\\PSP\\Save"));
+	std::vector<std::string> forward = { "C:", "Games", "PSP", "Save" };
+	std::vector<std::string> backward = { "Save", "PSP", "Games", "C:" };
+	CHECK(Collect(path.Components(), false) == forward);
+	CHECK(Collect(path.Components(), true) == backward);
+
+	// Raw strings, both separators and repeated ones
+	CHECK(Collect(PathComponentsUWP("/a\\\\b//c/"), false) == (std::vector<std::string>{ "a", "b", "c" }));
+	CHECK(Collect(PathComponentsUWP("//srv/share"), true) == (std::vector<std::string>{ "share", "srv" }));
+	PathComponentsUWP empty("");
+	CHECK(empty.begin() == empty.end());
+	PathComponentsUWP separators("///");
+	CHECK(separators.begin() == separators.end());
+
+	// Begin/End are offsets in the source string
+	std::string_view source = "C:/Games/PSP";
+	auto iter = PathComponentsUWP(source).begin();
+	++iter;
+	CHECK(iter.Begin() == 3 && iter.End() == 8);
+	CHECK(*iter-- == "Games");
+	CHECK(*iter == "C:");
+
+	std::string relative;
+	CHECK(PathUWP(std::string("c:/games")).ComputePathTo(path, relative) && relative == "PSP/Save");
+	CHECK(!PathUWP(std::string("C:/Gam")).ComputePathTo(path, relative));
+	CHECK(PathUWP(std::string("C:/Games/PSP/Save")).ComputePathTo(path, relative) && relative.empty());
+	CHECK(PathUWP(std::string("/")).ComputePathTo(PathUWP(std::string("/a/b")), relative) && relative == "a/b");
+
+	CHECK(path.CommonAncestor(PathUWP(std::string("c:/games/ppsspp"))).ToString() == "C:/Games");
+	CHECK(path.CommonAncestor(PathUWP(std::string("D:/games"))).empty());
+	CHECK(PathUWP(std::string("/a/b")).CommonAncestor(PathUWP(std::string("/c"))).ToString() == "/");
+
+	std::string_view view;
+	CHECK(GetRelativePathUWP("C:\\Root", "C:\\Root\\Folder\\file.txt", view) && view == "Folder\\file.txt");
+	CHECK(GetRelativePathUWP("c:/root/", "C:\\Root", view) && view.empty());
+	CHECK(!GetRelativePathUWP("C:\\Root", "C:\\RootX\\file.txt", view));
+}
+
+// Old 'Init': four prefix searches, slash flip and trailing slash trim on a copy
+static void ReplaceAll(std::string& input, const std::string& target, const std::string& replacement) {
+	size_t pos = 0;
+	while ((pos = input.find(target, pos)) != std::string::npos) {
+		input.replace(pos, target.size(), replacement);
+		pos += replacement.size();
+	}
+}
+
+static std::string OldInit(const std::string& str) {
+	std::string path = str;
+	ReplaceAll(path, "??\\", "");
+	ReplaceAll(path, "\\??\\", "");
+	ReplaceAll(path, "\\\\?\\", "");
+	ReplaceAll(path, "?\\", "");
+	for (auto& c : path) {
+		if (c == '\\') {
+			c = '/';
+		}
+	}
+	if (path.size() > 1 && path.back() == '/') {
+		path.pop_back();
+	}
+	return path;
+}
+
+// StorageManager entry points build a path, then read its directory and name
+static void BenchmarkConstruct() {
+	std::vector<std::string> inputs = {
+		"\\\\?\\C:\\Users\\Player\\AppData\\Local\\Packages\\App_8wekyb3d8bbwe\\LocalState\\config\\ppsspp.ini",
+		"D:\\Games\\PSP\\ISO\\Some Long Game Name (USA) (En,Fr,Es).iso",
+		"E:\\Emulation\\Saves\\SLUS-12345\\memcard.mcd",
+	};
+	const int rounds = 200000;
+	size_t sink = 0;
+
+	auto start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		std::string path = OldInit(inputs[i % inputs.size()]);
+		size_t slash = path.find_last_of('/');
+		sink += path.substr(0, slash).size() + path.substr(slash + 1).size();
+	}
+	double oldMs = ElapsedMs(start);
+
+	start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		PathUWP path(inputs[i % inputs.size()]);
+		sink += path.GetDirectoryView().size() + path.GetFilenameView().size();
+	}
+	double newMs = ElapsedMs(start);
+
+	std::printf("construct + directory + name: old %.3fus, single pass %.3fus (%zu)\n", oldMs * 1000 / rounds, newMs * 1000 / rounds, sink % 10);
+}
+
+int main() {
+	TestNormalize();
+	TestAccessors();
+	TestComponents();
+	BenchmarkConstruct();
+	std::printf("path_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,163 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// PathStringUWP: overloads, lazy conversion, plain wide paths and the file API chain
+
+#include "StoragePathString.h"
+#include "StoragePath.h"
+#include "StoragePathCompare.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// Existing string overloads must keep winning for their own types
+static int Overload(std::string) {
+	return 1;
+}
+static int Overload(std::wstring) {
+	return 2;
+}
+static int Overload(const PathStringUWP&) {
+	return 3;
+}
+
+static void TestOverloads() {
+	CHECK(Overload("abc") == 1);
+	CHECK(Overload(L"abc") == 2);
+	std::string utf8 = "x";
+	const std::string& utf8Ref = utf8;
+	CHECK(Overload(utf8Ref) == 1);
+	CHECK(Overload(PathStringUWP(L"x")) == 3);
+}
+
+static void TestLazyConversion() {
+	PathStringUWP wide(std::wstring(L"C:\\\u00DCn\u00EF\\a"));
+	CHECK(wide.HasWide() && !wide.HasUTF8());
+	CHECK(wide.UTF8() == "C:\\\xC3\x9Cn\xC3\xAF\\a");
+	CHECK(wide.HasUTF8());
+	// Cached, same object every time
+	CHECK(&wide.UTF8() == &wide.UTF8());
+
+	PathStringUWP utf8(std::string("C:/\xC3\xA9"));
+	CHECK(utf8.HasUTF8() && !utf8.HasWide());
+	CHECK(utf8.Wide() == L"C:/\u00E9");
+	CHECK(utf8.HasWide());
+
+	CHECK(PathStringUWP((const wchar_t*)nullptr).empty());
+	CHECK(PathStringUWP(std::string()).empty());
+	CHECK(!PathStringUWP(L"a").empty());
+}
+
+// Plain paths must come back from 'PathUWP' with the same spelling,
+// that's what lets the storage manager skip 'PathResolver' for them
+static void TestPlainWidePath() {
+	const wchar_t* plain[] = { L"C:\\a", L"d:\\Games\\PSP\\x.iso", L"C:\\\u00DCn\u00EF\\.hidden", L"C:\\a..b\\c" };
+	for (auto path : plain) {
+		CHECK(IsPlainWidePathUWP(path));
+		CHECK(PathUWP(std::wstring(path)).ToWString() == path);
+	}
+	const wchar_t* other[] = { L"", L"C:", L"C:\\", L"C:a\\b", L"1:\\a", L"C:/a", L"C:\\a/b", L"C:\\a\\",
+		L"C:\\a\\\\b", L"C:\\a\\.\\b", L"C:\\a\\..", L"\\\\?\\C:\\a", L"\\a\\b", L"\\\\server\\share" };
+	for (auto path : other) {
+		CHECK(!IsPlainWidePathUWP(path));
+	}
+}
+
+// Storage manager API -> helper -> Win32 W API, counted conversions
+static int conversions = 0;
+
+static size_t FakeCreateFileW(const std::wstring& path) {
+	return path.size();
+}
+
+// Resolve and cache key like 'OpenNew' below, the W API gets the resolved path converted back
+static size_t OpenOld(const std::string& path) {
+	PathUWP resolved(path);
+	std::string key = resolved.ToString();
+	FoldCaseUWP(key);
+	std::wstring wide = resolved.ToWString();
+	conversions++;
+	return FakeCreateFileW(wide);
+}
+
+static size_t OpenOld(const std::wstring& path) {
+	std::string utf8;
+	WideToUTF8UWP(path, utf8);
+	conversions++;
+	return OpenOld(utf8);
+}
+
+// Same steps as 'CreateFileUWP' when the direct API works (no mount points):
+// 'ResolveDualPath' for the cache keys, then 'ResolveWidePath' for the W API
+static size_t OpenNew(const PathStringUWP& path) {
+	bool plain = !path.HasUTF8() && IsPlainWidePathUWP(path.Wide());
+	bool hadUTF8 = path.HasUTF8();
+	PathUWP resolved = plain ? PathUWP(path.Wide()) : PathUWP(path.UTF8());
+	if (plain) {
+		conversions++;
+	}
+	std::string key = resolved.ToString();
+	FoldCaseUWP(key);
+
+	size_t result;
+	if (plain) {
+		result = FakeCreateFileW(path.Wide());
+	}
+	else {
+		std::wstring wide = resolved.ToWString();
+		conversions++;
+		result = FakeCreateFileW(wide);
+	}
+	if (!hadUTF8 && path.HasUTF8()) {
+		conversions++;
+	}
+	return result;
+}
+
+static void BenchmarkWideChain() {
+	std::wstring path = L"C:\\Users\\Player\\AppData\\Local\\Packages\\App_8wekyb3d8bbwe\\LocalState\\Games\\PSP\\GAME\\File.iso";
+	const int rounds = 300000;
+	size_t sink = 0;
+
+	conversions = 0;
+	auto start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		sink += OpenOld(path);
+	}
+	double oldMs = ElapsedMs(start);
+	int oldConversions = conversions;
+
+	conversions = 0;
+	start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		sink += OpenNew(PathStringUWP(path));
+	}
+	double newMs = ElapsedMs(start);
+
+	int newConversions = conversions;
+
+	// Unclean path still goes through the UTF-8 form
+	conversions = 0;
+	OpenNew(PathStringUWP(std::wstring(L"C:/Games/../Games/PSP")));
+	int uncleanConversions = conversions;
+
+	std::printf("wide path to W API: UTF-8 round trip %.3fus (%d conversions), PathStringUWP %.3fus (%d conversions)\n",
+		oldMs * 1000 / rounds, oldConversions, newMs * 1000 / rounds, newConversions);
+	// One conversion left for the cache keys, the W API gets the caller's string
+	CHECK(oldConversions == rounds * 2);
+	CHECK(newConversions == rounds);
+	CHECK(uncleanConversions == 2);
+	CHECK(sink == (size_t)rounds * 2 * path.size());
+}
+
+int main() {
+	TestOverloads();
+	TestLazyConversion();
+	TestPlainWidePath();
+	BenchmarkWideChain();
+	std::printf("pathstring_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,71 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// Lookup snapshot format: round trip, truncated and corrupted data
+
+#include "StorageSnapshot.h"
+#include "TestUtils.h"
+
+static std::vector<LookupSnapshotEntryUWP> MakeEntries(size_t count) {
+	std::vector<LookupSnapshotEntryUWP> entries;
+	for (size_t i = 0; i < count; i++) {
+		LookupSnapshotEntryUWP entry;
+		entry.token = "{TOKEN-" + std::to_string(i) + "}";
+		entry.path = "D:\\Games\\\xD8\xA7\xD9\x84\xD8\xB9\xD8\xA7\xD8\xA8\\" + std::to_string(i);
+		entry.isDirectory = (i % 3) == 0;
+		entry.validated = 1700000000 + (int64_t)i;
+		entries.push_back(entry);
+	}
+	return entries;
+}
+
+static void TestRoundTrip() {
+	for (size_t count : { 0, 1, 250 }) {
+		auto entries = MakeEntries(count);
+		std::string data;
+		SerializeLookupSnapshot(entries, 1234567890123ll, data);
+
+		std::vector<LookupSnapshotEntryUWP> loaded;
+		int64_t created = 0;
+		CHECK(DeserializeLookupSnapshot(data, loaded, created));
+		CHECK(created == 1234567890123ll);
+		CHECK(loaded.size() == entries.size());
+		for (size_t i = 0; i < entries.size(); i++) {
+			CHECK(loaded[i].token == entries[i].token);
+			CHECK(loaded[i].path == entries[i].path);
+			CHECK(loaded[i].isDirectory == entries[i].isDirectory);
+			CHECK(loaded[i].validated == entries[i].validated);
+		}
+	}
+}
+
+// Broken snapshot is never half loaded
+static void TestBrokenData() {
+	std::string data;
+	SerializeLookupSnapshot(MakeEntries(5), 42, data);
+	std::vector<LookupSnapshotEntryUWP> loaded;
+	int64_t created = 0;
+
+	for (size_t size = 0; size < data.size(); size++) {
+		CHECK(!DeserializeLookupSnapshot(data.substr(0, size), loaded, created));
+		CHECK(loaded.empty());
+	}
+	for (size_t i = 0; i < data.size(); i++) {
+		std::string corrupted = data;
+		corrupted[i] ^= 0x20;
+		CHECK(!DeserializeLookupSnapshot(corrupted, loaded, created));
+		CHECK(loaded.empty());
+	}
+	CHECK(!DeserializeLookupSnapshot(data + "x", loaded, created));
+	CHECK(loaded.empty());
+}
+
+int main() {
+	TestRoundTrip();
+	TestBrokenData();
+	std::printf("snapshot_test: OK\n");
+	return 0;
+}
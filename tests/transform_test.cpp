@@ -0,0 +1,126 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// StorageTransform.h: selected kernel against scalar reference (sizes, offsets, non-ASCII units)
+
+#include <string>
+#include <random>
+#include <cctype>
+#include <algorithm>
+
+#include "StorageTransform.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+template<typename T>
+static T RefLower(T unit) {
+	return (unit >= 'A' && unit <= 'Z') ? (T)(unit + 32) : unit;
+}
+
+template<typename T>
+static T RefUpper(T unit) {
+	return (unit >= 'a' && unit <= 'z') ? (T)(unit - 32) : unit;
+}
+
+// Random offset into a larger buffer, so unaligned starts and all tail sizes are covered
+static void FuzzUTF8() {
+	std::mt19937 random(3);
+	std::string buffer(160, 0);
+	for (int i = 0; i < 200000; i++) {
+		for (auto& c : buffer) {
+			c = (char)(random() % 256);
+		}
+		size_t offset = random() % 32;
+		size_t size = random() % (buffer.size() - offset);
+		const std::string source = buffer;
+
+		std::string lower = source, upper = source, replaced = source;
+		ToLowerASCIIUWP(&lower[offset], size);
+		ToUpperASCIIUWP(&upper[offset], size);
+		ReplaceCharUWP(&replaced[offset], size, '/', '\\');
+		for (size_t k = 0; k < source.size(); k++) {
+			bool inside = k >= offset && k < offset + size;
+			char c = source[k];
+			CHECK(lower[k] == (inside ? RefLower(c) : c));
+			CHECK(upper[k] == (inside ? RefUpper(c) : c));
+			CHECK(replaced[k] == (inside && c == '/' ? '\\' : c));
+		}
+	}
+}
+
+static void FuzzUTF16() {
+	std::mt19937 random(4);
+	std::u16string buffer(96, 0);
+	for (int i = 0; i < 200000; i++) {
+		for (auto& c : buffer) {
+			// Mostly ASCII, some units with ASCII letters in the low byte
+			c = (char16_t)((random() % 3) ? random() % 128 : random() % 65536);
+		}
+		size_t offset = random() % 16;
+		size_t size = random() % (buffer.size() - offset);
+		const std::u16string source = buffer;
+
+		std::u16string lower = source, upper = source, replaced = source;
+		ToLowerASCIIUWP(&lower[offset], size);
+		ToUpperASCIIUWP(&upper[offset], size);
+		ReplaceCharUWP(&replaced[offset], size, u'/', u'\\');
+		for (size_t k = 0; k < source.size(); k++) {
+			bool inside = k >= offset && k < offset + size;
+			char16_t c = source[k];
+			CHECK(lower[k] == (inside ? RefLower(c) : c));
+			CHECK(upper[k] == (inside ? RefUpper(c) : c));
+			CHECK(replaced[k] == (inside && c == u'/' ? u'\\' : c));
+		}
+
+		// wchar_t overloads share the UTF-16 kernels (Windows only, wchar_t is 32 bits here)
+		if (sizeof(wchar_t) == sizeof(char16_t)) {
+			std::wstring wide(source.begin(), source.end());
+			ToLowerASCIIUWP(&wide[offset], size);
+			CHECK(std::equal(wide.begin(), wide.end(), lower.begin(), [](wchar_t a, char16_t b) { return (char16_t)a == b; }));
+		}
+	}
+}
+
+// Lowercase + flip slashes of a long path (common before every compare/lookup)
+static void BenchmarkTransform() {
+	std::string path(200, 'x');
+	std::mt19937 random(5);
+	for (auto& c : path) {
+		c = "AbC/dE\\fG"[random() % 9];
+	}
+	const int rounds = 500000;
+
+	auto start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		std::transform(path.begin(), path.end(), path.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+		std::replace(path.begin(), path.end(), '/', '\\');
+		path[i % 200] = 'A';
+	}
+	double stdMs = ElapsedMs(start);
+
+	start = steady_clock::now();
+	for (int i = 0; i < rounds; i++) {
+		ToLowerASCIIUWP(&path[0], path.size());
+		ReplaceCharUWP(&path[0], path.size(), '/', '\\');
+		path[i % 200] = 'A';
+	}
+	double kernelMs = ElapsedMs(start);
+
+	std::printf("lower + slashes (200 chars): std %.3fus, %s %.3fus\n", stdMs * 1000 / rounds, GetTransformKernelUWP(), kernelMs * 1000 / rounds);
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(kernelMs < stdMs);
+	}
+}
+
+int main() {
+	std::printf("kernel: %s\n", GetTransformKernelUWP());
+	FuzzUTF8();
+	FuzzUTF16();
+	BenchmarkTransform();
+	std::printf("transform_test: OK\n");
+	return 0;
+}
@@ -0,0 +1,191 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// PathTrieUWP: queries against a linear scan of the same items, and lookup cost of both
+
+#include <map>
+#include <random>
+#include <algorithm>
+
+#include "StoragePathTrie.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+static std::vector<std::string> FoldedParts(const std::string& path) {
+	std::vector<std::string> parts;
+	PathTrieUWP<int>::SplitPath(path, parts);
+	for (auto& part : parts) {
+		FoldCaseUWP(part);
+	}
+	return parts;
+}
+
+// Lookup list before the trie, every query walks all items
+struct LinearIndex {
+	std::map<std::vector<std::string>, int> items;
+
+	static bool IsPrefix(const std::vector<std::string>& base, const std::vector<std::string>& parts) {
+		return base.size() <= parts.size() && std::equal(base.begin(), base.end(), parts.begin());
+	}
+
+	// Deepest first, like the trie
+	std::vector<int> Ancestors(const std::string& path, bool includeSelf) const {
+		auto parts = FoldedParts(path);
+		std::vector<std::pair<size_t, int>> found;
+		for (auto& item : items) {
+			if (IsPrefix(item.first, parts) && (includeSelf || item.first.size() < parts.size())) {
+				found.push_back({ item.first.size(), item.second });
+			}
+		}
+		std::sort(found.begin(), found.end(), [](auto& a, auto& b) { return a.first > b.first; });
+		std::vector<int> values;
+		for (auto& value : found) {
+			values.push_back(value.second);
+		}
+		return values;
+	}
+
+	bool ContainsPrefix(const std::string& path) const {
+		auto parts = FoldedParts(path);
+		if (parts.empty()) {
+			return false;
+		}
+		for (auto& item : items) {
+			if (IsPrefix(parts, item.first)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool HasChildren(const std::string& path) const {
+		auto parts = FoldedParts(path);
+		for (auto& item : items) {
+			if (item.first.size() == parts.size() + 1 && IsPrefix(parts, item.first)) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+static std::string RandomPath(std::mt19937& random) {
+	static const char* names[] = { "C:", "d:", "Games", "PSP", "saves", "ROMS", "a", "B" };
+	std::string path = names[random() % 2];
+	size_t depth = 1 + random() % 4;
+	for (size_t i = 0; i < depth; i++) {
+		path += (random() % 2) ? "\\" : "/";
+		std::string name = names[2 + random() % 6];
+		if (random() % 3 == 0) {
+			std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+		}
+		path += name;
+	}
+	return path;
+}
+
+static void TestAgainstLinearScan() {
+	std::mt19937 random(5);
+	PathTrieUWP<int> trie;
+	LinearIndex linear;
+	for (int i = 0; i < 20000; i++) {
+		std::string path = RandomPath(random);
+		switch (random() % 4) {
+		case 0:
+			CHECK(trie.Insert(path, i));
+			linear.items[FoldedParts(path)] = i;
+			break;
+		case 1:
+			CHECK(trie.Remove(path) == (linear.items.erase(FoldedParts(path)) > 0));
+			break;
+		default: {
+			auto item = linear.items.find(FoldedParts(path));
+			const int* value = trie.Find(path);
+			CHECK((value != nullptr) == (item != linear.items.end()));
+			CHECK(value == nullptr || *value == item->second);
+
+			bool includeSelf = random() % 2;
+			std::vector<const int*> ancestors;
+			trie.GetAncestors(path, ancestors, includeSelf);
+			auto expected = linear.Ancestors(path, includeSelf);
+			CHECK(ancestors.size() == expected.size());
+			for (size_t j = 0; j < expected.size(); j++) {
+				CHECK(*ancestors[j] == expected[j]);
+			}
+			CHECK(trie.ContainsPrefix(path) == linear.ContainsPrefix(path));
+			CHECK(trie.HasChildren(path) == linear.HasChildren(path));
+			break;
+		}
+		}
+		CHECK(trie.size() == linear.items.size());
+	}
+
+	// Copies are deep
+	PathTrieUWP<int> copy(trie);
+	trie.clear();
+	CHECK(trie.empty());
+	CHECK(copy.size() == linear.items.size());
+}
+
+static void TestDeepestPrefix() {
+	PathTrieUWP<int> trie;
+	trie.Insert("C:\\Games", 1);
+	trie.Insert("C:/Games/PSP/Saves", 2);
+	CHECK(trie.GetDeepestPrefixLength("C:\\Games\\PSP\\Save") == 8);
+	CHECK(trie.GetDeepestPrefixLength("c:/games/psp/saves/a.bin") == 18);
+	CHECK(trie.GetDeepestPrefixLength("D:\\Games") == 0);
+
+	std::vector<std::string> roots;
+	trie.GetSubRoots("C:", roots);
+	CHECK(roots.size() == 1 && roots[0] == "Games");
+}
+
+// Ancestors lookup, picked items are usually a few hundred
+static void BenchmarkLookup() {
+	std::mt19937 random(9);
+	PathTrieUWP<int> trie;
+	LinearIndex linear;
+	for (int i = 0; i < 2000; i++) {
+		std::string path = "D:\\Library\\Folder" + std::to_string(i) + "\\Sub" + std::to_string(i % 7);
+		trie.Insert(path, i);
+		linear.items[FoldedParts(path)] = i;
+	}
+	std::vector<std::string> queries;
+	for (int i = 0; i < 2000; i++) {
+		queries.push_back("d:\\library\\folder" + std::to_string(random() % 4000) + "\\SUB" + std::to_string(i % 7) + "\\game.iso");
+	}
+
+	size_t trieFound = 0;
+	auto start = steady_clock::now();
+	for (auto& query : queries) {
+		std::vector<const int*> ancestors;
+		trie.GetAncestors(query, ancestors);
+		trieFound += ancestors.size();
+	}
+	double trieUs = ElapsedMs(start) * 1000.0 / queries.size();
+
+	size_t linearFound = 0;
+	start = steady_clock::now();
+	for (auto& query : queries) {
+		linearFound += linear.Ancestors(query, false).size();
+	}
+	double linearUs = ElapsedMs(start) * 1000.0 / queries.size();
+
+	std::printf("ancestors of 2000 items: trie %.2fus, linear scan %.2fus per lookup\n", trieUs, linearUs);
+	CHECK(trieFound == linearFound);
+	if (TEST_SLOWDOWN == 1) {
+		CHECK(trieUs < linearUs);
+	}
+}
+
+int main() {
+	TestAgainstLinearScan();
+	TestDeepestPrefix();
+	BenchmarkLookup();
+	std::printf("trie_test: OK\n");
+	return 0;
+}
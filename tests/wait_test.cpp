@@ -0,0 +1,247 @@
+// UWP STORAGE MANAGER
+// Copyright (c) 2023-2024 Bashar Astifan.
+// Email: bashar@astifan.online
+// Telegram: @basharastifan
+// GitHub: https://github.com/basharast/UWP2Win32
+
+// WaitSignalUWP: CPU use and wake latency with a mock UI dispatcher, deadlines, cancellation and races
+// ReadyStateUWP: one time start and ready signalling (lookup list)
+
+#include <atomic>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "StorageWait.h"
+#include "TestUtils.h"
+
+using namespace std::chrono;
+
+// UI thread queue, 'ProcessEvents' sleeps until there is an event, a wake or the wake time
+class MockDispatcher : public WaitDispatcherUWP {
+public:
+	bool pumping = true;
+	int calls = 0;
+	int processed = 0; // UI events handled while waiting
+
+	bool NeedsPumping() override {
+		return pumping;
+	}
+
+	bool ProcessEvents() override {
+		std::unique_lock<std::mutex> lock(dispatcherLock);
+		calls++;
+		auto ready = [this]() { return events > 0 || woken || steady_clock::now() >= wakeTime; };
+		if (wakeTime != steady_clock::time_point::max()) {
+			condition.wait_until(lock, wakeTime, ready);
+		}
+		else {
+			condition.wait(lock, ready);
+		}
+		processed += events;
+		events = 0;
+		woken = false;
+		return true;
+	}
+
+	void Wake() override {
+		std::lock_guard<std::mutex> lock(dispatcherLock);
+		woken = true;
+		condition.notify_all();
+	}
+
+	void WakeAt(steady_clock::time_point time) override {
+		std::lock_guard<std::mutex> lock(dispatcherLock);
+		wakeTime = time;
+		condition.notify_all();
+	}
+
+	// Input, rendering..etc posted to the UI thread
+	void PostEvent() {
+		std::lock_guard<std::mutex> lock(dispatcherLock);
+		events++;
+		condition.notify_all();
+	}
+
+private:
+	std::mutex dispatcherLock;
+	std::condition_variable condition;
+	int events = 0;
+	bool woken = false;
+	steady_clock::time_point wakeTime = steady_clock::time_point::max();
+};
+
+static double CpuMs(clock_t since) {
+	return (clock() - since) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+// Broker call of 200ms, UI thread pumping (STA) or plain wait (worker thread)
+static void TestSleepsWhileWaiting() {
+	for (int mode = 0; mode < 3; mode++) {
+		auto signal = std::make_shared<WaitSignalUWP>();
+		MockDispatcher dispatcher;
+		dispatcher.pumping = mode == 0;
+		clock_t cpuStart = clock();
+		auto start = steady_clock::now();
+		std::thread broker([signal, &dispatcher, mode]() {
+			for (int i = 0; i < 10; i++) {
+				std::this_thread::sleep_for(milliseconds(20));
+				if (mode == 0) {
+					dispatcher.PostEvent();
+				}
+			}
+			signal->Set();
+		});
+		auto state = signal->Wait(mode == 2 ? nullptr : &dispatcher);
+		double wall = ElapsedMs(start);
+		double cpu = CpuMs(cpuStart);
+		broker.join();
+
+		const char* names[] = { "UI thread (pumping)", "worker (dispatcher)", "worker (no dispatcher)" };
+		std::printf("%-24s wall %.1fms cpu %.2fms, events %d, pumps %d\n", names[mode], wall, cpu, dispatcher.processed, dispatcher.calls);
+		CHECK(state == STORAGE_CALL_COMPLETED);
+		CHECK(cpu < 40 * TEST_SLOWDOWN);
+		CHECK(wall < 200 + 60 * TEST_SLOWDOWN);
+		if (mode == 0) {
+			// Events kept running, pumping slept between them
+			CHECK(dispatcher.processed >= 9 && dispatcher.processed <= 10);
+			CHECK(dispatcher.calls <= 12);
+		}
+		else {
+			CHECK(dispatcher.calls == 0);
+		}
+	}
+}
+
+// Old CX wait: 'ProcessEvents(ProcessAllIfPresent)' in a loop, one core busy for the whole call
+static void BenchmarkSpin() {
+	std::atomic<bool> done{ false };
+	clock_t cpuStart = clock();
+	auto start = steady_clock::now();
+	std::thread broker([&done]() {
+		std::this_thread::sleep_for(milliseconds(200));
+		done = true;
+	});
+	int spins = 0;
+	while (!done) {
+		spins++;
+	}
+	broker.join();
+	std::printf("%-24s wall %.1fms cpu %.2fms (spin loop baseline)\n", "old spin", ElapsedMs(start), CpuMs(cpuStart));
+}
+
+static void TestDeadlineAndCancel() {
+	for (int pumping = 0; pumping < 2; pumping++) {
+		MockDispatcher dispatcher;
+		dispatcher.pumping = pumping != 0;
+
+		WaitSignalUWP slow;
+		StorageLimitsUWP limits;
+		limits.deadline = steady_clock::now() + milliseconds(30);
+		auto start = steady_clock::now();
+		CHECK(slow.Wait(&dispatcher, &limits) == STORAGE_CALL_TIMEOUT);
+		double waited = ElapsedMs(start);
+		CHECK(waited >= 29 && waited < 30 + 100 * TEST_SLOWDOWN);
+
+		WaitSignalUWP canceled;
+		StorageLimitsUWP tokenLimits;
+		tokenLimits.token = std::make_shared<CancelTokenUWP>();
+		std::thread button([&tokenLimits]() {
+			std::this_thread::sleep_for(milliseconds(20));
+			tokenLimits.token->Cancel();
+		});
+		CHECK(canceled.Wait(&dispatcher, &tokenLimits) == STORAGE_CALL_CANCELED);
+		button.join();
+
+		// Already set, limits don't matter
+		WaitSignalUWP ready;
+		ready.Set();
+		CHECK(ready.Wait(&dispatcher, &limits) == STORAGE_CALL_COMPLETED);
+	}
+}
+
+// Set racing with the start of the wait, signal destroyed right after
+static void TestRaces() {
+	for (int i = 0; i < 20000; i++) {
+		auto signal = std::make_shared<WaitSignalUWP>();
+		MockDispatcher dispatcher;
+		std::thread completion([signal]() { signal->Set(); });
+		CHECK(signal->Wait(i % 2 ? &dispatcher : nullptr) == STORAGE_CALL_COMPLETED);
+		completion.join();
+	}
+}
+
+// Lookup list: fast phase once on the first caller, slow phase in background, many waiters
+static void TestReadyState() {
+	for (int round = 0; round < 200; round++) {
+		ReadyStateUWP state;
+		std::atomic<int> starts{ 0 };
+		std::atomic<bool> fastDone{ false };
+		std::vector<std::thread> background;
+		std::mutex backgroundLock;
+		auto start = [&]() {
+			state.Start([&]() {
+				starts++;
+				std::this_thread::sleep_for(microseconds(200));
+				fastDone = true;
+				std::lock_guard<std::mutex> lock(backgroundLock);
+				background.emplace_back([&state]() {
+					std::this_thread::sleep_for(microseconds(500));
+					state.SetReady();
+				});
+			});
+		};
+
+		std::atomic<int> completed{ 0 };
+		std::vector<std::thread> callers;
+		for (int i = 0; i < 4; i++) {
+			callers.emplace_back([&, i]() {
+				start();
+				// Start returns after the fast phase, on every thread
+				CHECK(fastDone);
+				MockDispatcher dispatcher;
+				dispatcher.pumping = i == 0;
+				if (state.Wait(i % 2 ? nullptr : &dispatcher) == STORAGE_CALL_COMPLETED && state.IsReady()) {
+					completed++;
+				}
+			});
+		}
+		for (auto& caller : callers) {
+			caller.join();
+		}
+		for (auto& thread : background) {
+			thread.join();
+		}
+		CHECK(starts == 1);
+		CHECK(completed == 4);
+
+		// Ready already, no wait
+		start();
+		CHECK(state.Wait(nullptr) == STORAGE_CALL_COMPLETED);
+		CHECK(starts == 1);
+	}
+
+	// Stopped waiter leaves, later ones still get the signal
+	ReadyStateUWP state;
+	CHECK(!state.IsReady());
+	StorageLimitsUWP limits;
+	limits.deadline = steady_clock::now() + milliseconds(10);
+	CHECK(state.Wait(nullptr, &limits) == STORAGE_CALL_TIMEOUT);
+	std::thread ready([&state]() {
+		std::this_thread::sleep_for(milliseconds(10));
+		state.SetReady();
+	});
+	CHECK(state.Wait(nullptr) == STORAGE_CALL_COMPLETED);
+	ready.join();
+}
+
+int main() {
+	TestSleepsWhileWaiting();
+	BenchmarkSpin();
+	TestDeadlineAndCancel();
+	TestRaces();
+	TestReadyState();
+	std::printf("wait_test: OK\n");
+	return 0;
+}